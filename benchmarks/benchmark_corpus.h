@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "document.h"
+
+// Синтетический корпус бенчмарков: обычные слова "w<ранг>" с частотами по закону
+// Ципфа, как в естественных текстах, и стоп-слова "s<номер>". Корпус и запросы
+// порождаются генератором с заданным зерном, поэтому при тех же параметрах
+// результаты разных сборок сравнимы.
+
+// Веса слов по закону Ципфа: вес слова ранга r пропорционален 1 / r^zipf.
+inline std::vector< double >
+ZipfWeights(
+        const int vocabulary,
+        const double zipf )
+    {
+        std::vector< double > weights( vocabulary );
+
+        for( int rank = 0; rank < vocabulary; ++rank )
+            {
+                weights[ rank ] = 1.0 / std::pow( rank + 1, zipf );
+            }
+
+        return weights;
+    }
+
+struct CorpusConfig
+    {
+        std::uint32_t seed = 42;
+
+        int documents = 100'000;
+        int vocabulary = 50'000;
+
+        // Показатель закона Ципфа, см. ZipfWeights.
+        double zipf = 1.0;
+
+        // Число слов документа.
+        int min_length = 10;
+        int max_length = 60;
+
+        // Число стоп-слов и их доля среди слов документов и запросов.
+        int stop_words = 0;
+        double stop_ratio = 0.0;
+
+        // У документа rating_count рейтингов из [ min_rating, max_rating ]
+        // и статус из первых status_count значений DocumentStatus.
+        int rating_count = 1;
+        int min_rating = 1;
+        int max_rating = 1;
+        int status_count = 1;
+    };
+
+struct QueryConfig
+    {
+        int queries = 1'000;
+
+        // Число слов запроса.
+        int min_length = 1;
+        int max_length = 4;
+
+        // Ранги слов запроса выбираются равномерно из [ min_rank, max_rank ],
+        // а при max_rank = 0 - по закону Ципфа, как в документах.
+        int min_rank = 0;
+        int max_rank = 0;
+
+        // Доля слов запроса, которые становятся минус-словами.
+        double minus_ratio = 0.0;
+
+        // Минус-слова, которые дописываются к запросу сверх его слов.
+        int min_minus_words = 0;
+        int max_minus_words = 0;
+    };
+
+class CorpusGenerator
+    {
+
+        public:
+
+            explicit CorpusGenerator( const CorpusConfig & config )
+                :
+                      config_( config )
+                    , generator_( config.seed )
+                {
+                    const std::vector< double > weights = ZipfWeights( config.vocabulary, config.zipf );
+
+                    word_ = std::discrete_distribution< int >( weights.cbegin(), weights.cend() );
+                }
+
+            std::vector< DocumentRecord >
+            GenerateRecords()
+                {
+                    std::uniform_int_distribution< int > length( config_.min_length, config_.max_length );
+                    std::uniform_int_distribution< int > rating( config_.min_rating, config_.max_rating );
+                    std::uniform_int_distribution< int > status( 0, config_.status_count - 1 );
+
+                    std::vector< DocumentRecord > records( config_.documents );
+
+                    for( int document_id = 0; document_id < config_.documents; ++document_id )
+                        {
+                            DocumentRecord & record = records[ document_id ];
+
+                            record.id = document_id;
+                            record.status = static_cast< DocumentStatus >( status( generator_ ) );
+
+                            for( int i = 0; i < config_.rating_count; ++i )
+                                {
+                                    record.ratings.push_back( rating( generator_ ) );
+                                }
+
+                            for( int i = length( generator_ ); i > 0; --i )
+                                {
+                                    AppendWord( record.text, word_( generator_ ) );
+                                }
+                        }
+
+                    return records;
+                }
+
+            std::vector< std::string >
+            GenerateQueries( const QueryConfig & config )
+                {
+                    std::uniform_int_distribution< int > length( config.min_length, config.max_length );
+                    std::uniform_int_distribution< int > minus_word_count( config.min_minus_words, config.max_minus_words );
+                    std::uniform_int_distribution< int > uniform_rank( config.min_rank, config.max_rank );
+                    std::uniform_real_distribution< double > chance( 0.0, 1.0 );
+
+                    const auto rank = [&]()
+                        {
+                            return config.max_rank == 0 ? word_( generator_ ) : uniform_rank( generator_ );
+                        };
+
+                    std::vector< std::string > queries( config.queries );
+
+                    for( std::string & query : queries )
+                        {
+                            for( int i = length( generator_ ); i > 0; --i )
+                                {
+                                    AppendWord( query, rank() );
+
+                                    // Минус-слово: знак перед только что добавленным словом.
+                                    if(
+                                            config.minus_ratio > 0.0
+                                            &&
+                                            chance( generator_ ) < config.minus_ratio )
+                                        {
+                                            query.insert( query.rfind( ' ' ) + 1, 1, '-' );
+                                        }
+                                }
+
+                            for( int i = minus_word_count( generator_ ); i > 0; --i )
+                                {
+                                    query += " -w" + std::to_string( rank() );
+                                }
+                        }
+
+                    return queries;
+                }
+
+            // Стоп-слова корпуса через пробел.
+            std::string
+            GetStopWords() const
+                {
+                    std::string stop_words;
+
+                    for( int i = 0; i < config_.stop_words; ++i )
+                        {
+                            stop_words += " s" + std::to_string( i );
+                        }
+
+                    return stop_words;
+                }
+
+        private:
+
+            const CorpusConfig config_;
+
+            std::mt19937 generator_;
+
+            std::discrete_distribution< int > word_;
+
+            std::uniform_real_distribution< double > chance_{ 0.0, 1.0 };
+
+            // Дописывает слово ранга rank или, с долей stop_ratio, случайное стоп-слово.
+            void
+            AppendWord(
+                    std::string & text,
+                    const int rank )
+                {
+                    if( !text.empty() )
+                        {
+                            text += ' ';
+                        }
+
+                    if(
+                            config_.stop_words > 0
+                            &&
+                            chance_( generator_ ) < config_.stop_ratio )
+                        {
+                            text += 's' + std::to_string( generator_() % config_.stop_words );
+                        }
+                    else
+                        {
+                            text += 'w' + std::to_string( rank );
+                        }
+                }
+    };
@@ -0,0 +1,138 @@
+// IDF на коротких запросах: стоимость одного значения IDF - std::log против
+// InverseDocumentFreqCache - и число запросов в секунду для запросов из одного-двух
+// редких слов, когда кэш результатов отключён и каждый запрос считается заново.
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks idf_benchmark && benchmarks/_build/idf_benchmark
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_corpus.h"
+#include "document.h"
+#include "inverse_document_freq_cache.h"
+#include "search_server.h"
+
+namespace
+    {
+        constexpr int document_count = 100'000;
+        constexpr int vocabulary_size = 50'000;
+        constexpr int query_count = 200'000;
+        constexpr int lookup_count = 10'000'000;
+
+        template < typename Function >
+        double
+        MeasureSeconds( Function function )
+            {
+                using namespace std::chrono;
+
+                const auto start = steady_clock::now();
+
+                function();
+
+                return duration< double >( steady_clock::now() - start ).count();
+            }
+    }
+
+int
+main()
+    {
+        CorpusConfig corpus_config;
+        corpus_config.documents = document_count;
+        corpus_config.vocabulary = vocabulary_size;
+
+        CorpusGenerator corpus( corpus_config );
+
+        const std::vector< DocumentRecord > records = corpus.GenerateRecords();
+
+        // Запросы из одного-двух слов с рангами от 1000: у таких слов короткие
+        // списки вхождений, и доля IDF в стоимости запроса наибольшая.
+        QueryConfig query_config;
+        query_config.queries = query_count;
+        query_config.min_length = 1;
+        query_config.max_length = 2;
+        query_config.min_rank = 1000;
+        query_config.max_rank = vocabulary_size - 1;
+
+        const std::vector< std::string > queries = corpus.GenerateQueries( query_config );
+
+        // Слова и их документные частоты, как их видит цикл оценки.
+        std::mt19937 generator( corpus_config.seed );
+
+        const std::vector< double > weights = ZipfWeights( vocabulary_size, corpus_config.zipf );
+        std::discrete_distribution< int > term( weights.cbegin(), weights.cend() );
+
+        std::vector< TermId > lookup_terms( 1 << 16 );
+        std::vector< std::size_t > document_freqs( vocabulary_size );
+
+        for( TermId & lookup_term : lookup_terms )
+            {
+                lookup_term = static_cast< TermId >( term( generator ) );
+            }
+
+        for( int rank = 0; rank < vocabulary_size; ++rank )
+            {
+                document_freqs[ rank ] = 1 + static_cast< std::size_t >( document_count * 30.0 * weights[ rank ] / 11.0 );
+            }
+
+        double checksum = 0.0;
+
+        const double log_seconds = MeasureSeconds(
+                [&]()
+                    {
+                        for( int i = 0; i < lookup_count; ++i )
+                            {
+                                const TermId lookup_term = lookup_terms[ i & 0xFFFF ];
+
+                                checksum += std::log( 1.0 * document_count / document_freqs[ lookup_term ] );
+                            }
+                    } );
+
+        InverseDocumentFreqCache cache;
+        cache.Resize( vocabulary_size );
+
+        const double cache_seconds = MeasureSeconds(
+                [&]()
+                    {
+                        for( int i = 0; i < lookup_count; ++i )
+                            {
+                                const TermId lookup_term = lookup_terms[ i & 0xFFFF ];
+
+                                checksum += cache.Get(
+                                        lookup_term,
+                                        1,
+                                        [&]()
+                                            {
+                                                return std::log( 1.0 * document_count / document_freqs[ lookup_term ] );
+                                            } );
+                            }
+                    } );
+
+        SearchServer search_server( std::string( "w0 w1 w2" ) );
+        search_server.AddDocuments( records.cbegin(), records.cend() );
+
+        std::size_t result_count = 0;
+
+        const double query_seconds = MeasureSeconds(
+                [&]()
+                    {
+                        for( const std::string & query : queries )
+                            {
+                                result_count += search_server.FindTopDocuments( query ).size();
+                            }
+                    } );
+
+        std::cout
+                << std::fixed << std::setprecision( 2 )
+                << "IDF std::log          " << std::setw( 10 ) << log_seconds * 1e9 / lookup_count << " ns\n"
+                << "IDF cached            " << std::setw( 10 ) << cache_seconds * 1e9 / lookup_count << " ns\n"
+                << std::setprecision( 0 )
+                << "short queries         " << std::setw( 10 ) << queries.size() / query_seconds << " queries/s\n"
+                << "checksum " << checksum << ' ' << result_count << '\n';
+    }
@@ -0,0 +1,70 @@
+// Скорость индексации в документах в секунду: AddDocument по одному документу
+// и пакетная загрузка AddDocuments с параллельным разбором.
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks ingest_benchmark && benchmarks/_build/ingest_benchmark
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_corpus.h"
+#include "document.h"
+#include "search_server.h"
+
+namespace
+    {
+        constexpr int document_count = 200'000;
+        constexpr int vocabulary_size = 50'000;
+
+        template < typename AddAll >
+        double
+        MeasureDocumentsPerSecond( AddAll add_all )
+            {
+                using namespace std::chrono;
+
+                SearchServer search_server( std::string( "w0 w1 w2" ) );
+
+                const auto start = steady_clock::now();
+
+                add_all( search_server );
+
+                const double seconds = duration< double >( steady_clock::now() - start ).count();
+
+                return search_server.GetDocumentCount() / seconds;
+            }
+    }
+
+int
+main()
+    {
+        CorpusConfig corpus_config;
+        corpus_config.documents = document_count;
+        corpus_config.vocabulary = vocabulary_size;
+
+        const std::vector< DocumentRecord > records = CorpusGenerator( corpus_config ).GenerateRecords();
+
+        const double sequential = MeasureDocumentsPerSecond(
+                [&records]( SearchServer & search_server )
+                    {
+                        for( const DocumentRecord & record : records )
+                            {
+                                search_server.AddDocument( record.id, record.text, record.status, record.ratings );
+                            }
+                    } );
+
+        const double bulk = MeasureDocumentsPerSecond(
+                [&records]( SearchServer & search_server )
+                    {
+                        search_server.AddDocuments( records.cbegin(), records.cend() );
+                    } );
+
+        std::cout
+                << std::fixed << std::setprecision( 0 )
+                << "threads     " << std::thread::hardware_concurrency() << '\n'
+                << "AddDocument " << std::setw( 10 ) << sequential << " documents/s\n"
+                << "AddDocuments" << std::setw( 10 ) << bulk << " documents/s\n";
+    }
@@ -0,0 +1,93 @@
+// Запросы с частыми минус-словами: документы с минус-словами исключаются
+// до оценки и не попадают в накопитель релевантности.
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks minus_words_benchmark && benchmarks/_build/minus_words_benchmark
+
+#include <chrono>
+#include <cstddef>
+#include <execution>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark_corpus.h"
+#include "document.h"
+#include "search_server.h"
+
+namespace
+    {
+        constexpr int document_count = 100'000;
+        constexpr int vocabulary_size = 50'000;
+        constexpr int query_count = 1'000;
+
+        template < typename Function >
+        double
+        MeasureSeconds( Function function )
+            {
+                using namespace std::chrono;
+
+                const auto start = steady_clock::now();
+
+                function();
+
+                return duration< double >( steady_clock::now() - start ).count();
+            }
+    }
+
+int
+main()
+    {
+        CorpusConfig corpus_config;
+        corpus_config.documents = document_count;
+        corpus_config.vocabulary = vocabulary_size;
+        corpus_config.min_rating = -10;
+        corpus_config.max_rating = 10;
+
+        CorpusGenerator corpus( corpus_config );
+
+        const std::vector< DocumentRecord > records = corpus.GenerateRecords();
+
+        // Запрос из двух частых слов и трёх-пяти частых минус-слов: минус-слова
+        // исключают большую часть документов, найденных по плюс-словам.
+        QueryConfig query_config;
+        query_config.queries = query_count;
+        query_config.min_length = 2;
+        query_config.max_length = 2;
+        query_config.min_rank = 3;
+        query_config.max_rank = 100;
+        query_config.min_minus_words = 3;
+        query_config.max_minus_words = 5;
+
+        const std::vector< std::string > queries = corpus.GenerateQueries( query_config );
+
+        SearchServer search_server( std::string( "w0 w1 w2" ) );
+        search_server.AddDocuments( records.cbegin(), records.cend() );
+
+        std::size_t result_count = 0;
+
+        const double sequential_seconds = MeasureSeconds(
+                [&]()
+                    {
+                        for( const std::string & query : queries )
+                            {
+                                result_count += search_server.FindTopDocuments( query ).size();
+                            }
+                    } );
+
+        const double parallel_seconds = MeasureSeconds(
+                [&]()
+                    {
+                        for( const std::string & query : queries )
+                            {
+                                result_count += search_server.FindTopDocuments( std::execution::par, query ).size();
+                            }
+                    } );
+
+        std::cout
+                << std::fixed << std::setprecision( 0 )
+                << "sequential            " << std::setw( 10 ) << queries.size() / sequential_seconds << " queries/s\n"
+                << "parallel              " << std::setw( 10 ) << queries.size() / parallel_seconds << " queries/s\n"
+                << "results " << result_count << '\n';
+    }
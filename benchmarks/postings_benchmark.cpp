@@ -0,0 +1,122 @@
+// Сравнение несжатого и сжатого форматов постингов:
+// занимаемая память в байтах на постинг и число запросов в секунду.
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks postings_benchmark && benchmarks/_build/postings_benchmark
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark_corpus.h"
+#include "document.h"
+#include "inverted_index.h"
+#include "search_server.h"
+#include "string_processing.h"
+#include "term_dictionary.h"
+
+namespace
+    {
+        constexpr int document_count = 100'000;
+        constexpr int vocabulary_size = 50'000;
+        constexpr int query_count = 1'000;
+
+        // Размер индекса в байтах на постинг для заданного формата.
+        double
+        MeasureBytesPerPosting(
+                const std::vector< DocumentRecord > & records,
+                const PostingsFormat format )
+            {
+                TermDictionary terms;
+                InvertedIndex index( format );
+
+                std::size_t posting_count = 0;
+
+                for( const DocumentRecord & record : records )
+                    {
+                        std::vector< TermId > document_terms;
+
+                        for( const std::string_view word : SplitIntoWords( record.text ) )
+                            {
+                                document_terms.push_back( terms.Intern( word ) );
+                            }
+
+                        const InvertedIndex::TermFreqs term_freqs = InvertedIndex::ComputeTermFreqs( std::move( document_terms ) );
+
+                        index.AddDocument( record.id, term_freqs );
+
+                        posting_count += term_freqs.size();
+                    }
+
+                return 1.0 * index.GetMemoryUsage() / posting_count;
+            }
+
+        double
+        MeasureQueriesPerSecond(
+                const std::vector< DocumentRecord > & records,
+                const std::vector< std::string > & queries,
+                const PostingsFormat format,
+                std::size_t & checksum )
+            {
+                using namespace std::chrono;
+
+                SearchServer search_server( std::string( "w0 w1 w2" ), format );
+
+                search_server.AddDocuments( records.cbegin(), records.cend() );
+
+                const auto start = steady_clock::now();
+
+                for( const std::string & query : queries )
+                    {
+                        checksum += search_server.FindTopDocuments( query ).size();
+                    }
+
+                const double seconds = duration< double >( steady_clock::now() - start ).count();
+
+                return queries.size() / seconds;
+            }
+    }
+
+int
+main()
+    {
+        CorpusConfig corpus_config;
+        corpus_config.documents = document_count;
+        corpus_config.vocabulary = vocabulary_size;
+
+        CorpusGenerator corpus( corpus_config );
+
+        const std::vector< DocumentRecord > records = corpus.GenerateRecords();
+
+        QueryConfig query_config;
+        query_config.queries = query_count;
+        query_config.min_length = 1;
+        query_config.max_length = 4;
+
+        const std::vector< std::string > queries = corpus.GenerateQueries( query_config );
+
+        std::cout << std::fixed << std::setprecision( 2 );
+
+        std::size_t checksum = 0;
+
+        for( const auto & [ name, format ] :
+                {
+                    std::pair{ "plain", PostingsFormat::PLAIN },
+                    std::pair{ "compressed", PostingsFormat::COMPRESSED },
+                } )
+            {
+                const double bytes_per_posting = MeasureBytesPerPosting( records, format );
+                const double queries_per_second = MeasureQueriesPerSecond( records, queries, format, checksum );
+
+                std::cout
+                        << std::left << std::setw( 12 ) << name
+                        << std::right
+                        << std::setw( 8 ) << bytes_per_posting << " bytes/posting"
+                        << std::setw( 12 ) << queries_per_second << " queries/s\n";
+            }
+
+        std::cout << "checksum " << checksum << '\n';
+    }
@@ -0,0 +1,513 @@
+// Сквозной бенчмарк сервера на синтетическом корпусе: загрузка документов,
+// поиск, MatchDocument, разбиение на слова и учёт запросов в RequestQueue.
+//
+// Корпус и запросы порождаются генератором с заданным зерном, поэтому при тех же
+// параметрах результаты разных сборок сравнимы. Слова выбираются по закону Ципфа
+// с показателем --zipf; доли стоп-слов в текстах и минус-слов в запросах задаются
+// отдельно. Итог печатается одной строкой JSON: параметры, пропускная способность,
+// 50-я и 99-я перцентили задержек в микросекундах и пиковый RSS в килобайтах,
+// а с --metrics=on - ещё и время этапов поиска и счётчики из SearchServer::GetMetrics.
+//
+// Параметры - в виде --имя=значение, см. Config; например:
+//     search_benchmark --documents=200000 --min-length=20 --max-length=80 --minus-ratio=0.2
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks search_benchmark && benchmarks/_build/search_benchmark
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "benchmark_corpus.h"
+#include "document.h"
+#include "request_queue.h"
+#include "search_metrics.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        struct Config
+            {
+                std::uint32_t seed = 42;
+
+                int documents = 100'000;
+                int queries = 10'000;
+                int vocabulary = 50'000;
+
+                // Показатель закона Ципфа: вес слова ранга r пропорционален 1 / r^zipf.
+                double zipf = 1.0;
+
+                int min_length = 10;
+                int max_length = 60;
+
+                int min_query_length = 1;
+                int max_query_length = 4;
+
+                int stop_words = 20;
+
+                // Доля стоп-слов среди слов документов и запросов.
+                double stop_ratio = 0.1;
+
+                // Доля минус-слов среди слов запросов.
+                double minus_ratio = 0.1;
+
+                bool compressed = false;
+
+                // Включает метрики этапов поиска, см. SearchServer::GetMetrics.
+                bool metrics = false;
+            };
+
+        Config
+        ParseConfig(
+                const int argc,
+                char ** argv )
+            {
+                Config config;
+
+                const std::map< std::string_view, double * > real_options = {
+                        { "zipf", &config.zipf },
+                        { "stop-ratio", &config.stop_ratio },
+                        { "minus-ratio", &config.minus_ratio } };
+
+                const std::map< std::string_view, int * > integer_options = {
+                        { "documents", &config.documents },
+                        { "queries", &config.queries },
+                        { "vocabulary", &config.vocabulary },
+                        { "min-length", &config.min_length },
+                        { "max-length", &config.max_length },
+                        { "min-query-length", &config.min_query_length },
+                        { "max-query-length", &config.max_query_length },
+                        { "stop-words", &config.stop_words } };
+
+                for( int i = 1; i < argc; ++i )
+                    {
+                        using namespace std::string_literals;
+
+                        const std::string_view argument = argv[ i ];
+                        const std::size_t equals = argument.find( '=' );
+
+                        if(
+                                argument.substr( 0, 2 ) != "--"
+                                ||
+                                equals == std::string_view::npos )
+                            {
+                                throw std::invalid_argument( "Параметр должен иметь вид --имя=значение: "s + std::string( argument ) );
+                            }
+
+                        const std::string_view name = argument.substr( 2, equals - 2 );
+                        const std::string value( argument.substr( equals + 1 ) );
+
+                        if( name == "seed" )
+                            {
+                                config.seed = static_cast< std::uint32_t >( std::stoul( value ) );
+                            }
+                        else if( name == "format" )
+                            {
+                                if(
+                                        value != "plain"
+                                        &&
+                                        value != "compressed" )
+                                    {
+                                        throw std::invalid_argument( "Формат постингов - plain или compressed: "s + value );
+                                    }
+
+                                config.compressed = value == "compressed";
+                            }
+                        else if( name == "metrics" )
+                            {
+                                if(
+                                        value != "on"
+                                        &&
+                                        value != "off" )
+                                    {
+                                        throw std::invalid_argument( "Метрики - on или off: "s + value );
+                                    }
+
+                                config.metrics = value == "on";
+                            }
+                        else if( real_options.count( name ) > 0 )
+                            {
+                                *real_options.at( name ) = std::stod( value );
+                            }
+                        else if( integer_options.count( name ) > 0 )
+                            {
+                                *integer_options.at( name ) = std::stoi( value );
+                            }
+                        else
+                            {
+                                throw std::invalid_argument( "Неизвестный параметр: "s + std::string( argument ) );
+                            }
+                    }
+
+                if(
+                        config.documents <= 0
+                        ||
+                        config.queries <= 0
+                        ||
+                        config.vocabulary <= 0
+                        ||
+                        config.stop_words <= 0
+                        ||
+                        config.min_length <= 0
+                        ||
+                        config.min_length > config.max_length
+                        ||
+                        config.min_query_length <= 0
+                        ||
+                        config.min_query_length > config.max_query_length )
+                    {
+                        throw std::invalid_argument( "Размеры корпуса и длины текстов должны быть положительными." );
+                    }
+
+                return config;
+            }
+
+        template < typename Function >
+        double
+        MeasureSeconds( Function function )
+            {
+                const Clock::time_point start = Clock::now();
+
+                function();
+
+                return std::chrono::duration< double >( Clock::now() - start ).count();
+            }
+
+        // Задержки отдельных вызовов в микросекундах.
+        struct Latencies
+            {
+                std::vector< double > samples;
+                double total_seconds = 0.0;
+
+                template < typename Function >
+                void
+                Measure( Function function )
+                    {
+                        const Clock::time_point start = Clock::now();
+
+                        function();
+
+                        const double seconds = std::chrono::duration< double >( Clock::now() - start ).count();
+
+                        samples.push_back( seconds * 1e6 );
+                        total_seconds += seconds;
+                    }
+
+                double
+                GetPercentile( const double fraction )
+                    {
+                        if( samples.empty() )
+                            {
+                                return 0.0;
+                            }
+
+                        const std::size_t position = std::min(
+                                samples.size() - 1,
+                                static_cast< std::size_t >( fraction * samples.size() ) );
+
+                        std::nth_element( samples.begin(), samples.begin() + position, samples.end() );
+
+                        return samples[ position ];
+                    }
+            };
+
+        // Пишет объект JSON из пар "ключ": значение.
+        class JsonObject
+            {
+
+                public:
+
+                    template < typename Value >
+                    JsonObject &
+                    Add(
+                            const std::string_view key,
+                            const Value & value )
+                        {
+                            out_ << ( is_empty_ ? "{ " : ", " ) << '"' << key << "\": ";
+                            is_empty_ = false;
+
+                            if constexpr( std::is_same_v< Value, std::string > || std::is_same_v< Value, JsonObject > )
+                                {
+                                    out_ << Quote( value );
+                                }
+                            else if constexpr( std::is_same_v< Value, bool > )
+                                {
+                                    out_ << ( value ? "true" : "false" );
+                                }
+                            else
+                                {
+                                    out_ << value;
+                                }
+
+                            return *this;
+                        }
+
+                    JsonObject &
+                    AddLatencies(
+                            const std::string_view name,
+                            Latencies & latencies )
+                        {
+                            const std::string prefix( name );
+
+                            return
+                                    Add( prefix + "_qps", latencies.samples.size() / latencies.total_seconds )
+                                    .Add( prefix + "_p50_us", latencies.GetPercentile( 0.5 ) )
+                                    .Add( prefix + "_p99_us", latencies.GetPercentile( 0.99 ) );
+                        }
+
+                    std::string
+                    str() const
+                        {
+                            return is_empty_ ? "{}" : out_.str() + " }";
+                        }
+
+                private:
+
+                    std::ostringstream out_ = CreateStream();
+
+                    bool is_empty_ = true;
+
+                    static std::ostringstream
+                    CreateStream()
+                        {
+                            std::ostringstream out;
+                            out << std::fixed << std::setprecision( 3 );
+
+                            return out;
+                        }
+
+                    static std::string
+                    Quote( const std::string & value )
+                        {
+                            return '"' + value + '"';
+                        }
+
+                    static std::string
+                    Quote( const JsonObject & value )
+                        {
+                            return value.str();
+                        }
+            };
+
+        std::size_t
+        GetPeakResidentKilobytes()
+            {
+                rusage usage{};
+                getrusage( RUSAGE_SELF, &usage );
+
+                // В Linux ru_maxrss - в килобайтах.
+                return static_cast< std::size_t >( usage.ru_maxrss );
+            }
+    }
+
+int
+main(
+        int argc,
+        char ** argv )
+    {
+        Config config;
+
+        try
+            {
+                config = ParseConfig( argc, argv );
+            }
+        catch( const std::exception & error )
+            {
+                std::cerr << error.what() << '\n';
+
+                return 1;
+            }
+
+        CorpusConfig corpus_config;
+        corpus_config.seed = config.seed;
+        corpus_config.documents = config.documents;
+        corpus_config.vocabulary = config.vocabulary;
+        corpus_config.zipf = config.zipf;
+        corpus_config.min_length = config.min_length;
+        corpus_config.max_length = config.max_length;
+        corpus_config.stop_words = config.stop_words;
+        corpus_config.stop_ratio = config.stop_ratio;
+        corpus_config.rating_count = 2;
+        corpus_config.min_rating = -10;
+        corpus_config.max_rating = 10;
+        corpus_config.status_count = 4;
+
+        QueryConfig query_config;
+        query_config.queries = config.queries;
+        query_config.min_length = config.min_query_length;
+        query_config.max_length = config.max_query_length;
+        query_config.minus_ratio = config.minus_ratio;
+
+        CorpusGenerator corpus( corpus_config );
+
+        const std::vector< DocumentRecord > records = corpus.GenerateRecords();
+        const std::vector< std::string > queries = corpus.GenerateQueries( query_config );
+        const std::string stop_words = corpus.GetStopWords();
+        const PostingsFormat format = config.compressed ? PostingsFormat::COMPRESSED : PostingsFormat::PLAIN;
+
+        std::size_t checksum = 0;
+
+        const double split_seconds = MeasureSeconds(
+                [&]()
+                    {
+                        for( const DocumentRecord & record : records )
+                            {
+                                checksum += SplitIntoWords( record.text ).size();
+                            }
+                    } );
+
+        const std::size_t word_count = checksum;
+
+        SearchServer search_server( stop_words, format );
+
+        const double add_document_seconds = MeasureSeconds(
+                [&]()
+                    {
+                        for( const DocumentRecord & record : records )
+                            {
+                                search_server.AddDocument( record.id, record.text, record.status, record.ratings );
+                            }
+                    } );
+
+        double add_documents_seconds = 0.0;
+
+        {
+            SearchServer batch_server( stop_words, format );
+
+            add_documents_seconds = MeasureSeconds(
+                    [&]()
+                        {
+                            batch_server.AddDocuments( records.cbegin(), records.cend() );
+                        } );
+        }
+
+        search_server.SetMetricsEnabled( config.metrics );
+
+        Latencies find_top_documents;
+        Latencies find_top_documents_wand;
+        Latencies match_document;
+
+        std::mt19937 generator( config.seed );
+        std::uniform_int_distribution< int > document_id( 0, config.documents - 1 );
+
+        for( const std::string & query : queries )
+            {
+                find_top_documents.Measure(
+                        [&]()
+                            {
+                                checksum += search_server.FindTopDocuments( query ).size();
+                            } );
+
+                find_top_documents_wand.Measure(
+                        [&]()
+                            {
+                                checksum += search_server.FindTopDocuments( QueryMode::WAND, query ).size();
+                            } );
+
+                const int match_document_id = document_id( generator );
+
+                match_document.Measure(
+                        [&]()
+                            {
+                                checksum += std::get< 0 >( search_server.MatchDocument( query, match_document_id ) ).size();
+                            } );
+            }
+
+        RequestQueue request_queue( search_server );
+        Latencies add_find_request;
+
+        for( const std::string & query : queries )
+            {
+                add_find_request.Measure(
+                        [&]()
+                            {
+                                checksum += request_queue.AddFindRequest( query ).size();
+                            } );
+            }
+
+        JsonObject config_json;
+        config_json
+                .Add( "seed", config.seed )
+                .Add( "documents", config.documents )
+                .Add( "queries", config.queries )
+                .Add( "vocabulary", config.vocabulary )
+                .Add( "zipf", config.zipf )
+                .Add( "min_length", config.min_length )
+                .Add( "max_length", config.max_length )
+                .Add( "min_query_length", config.min_query_length )
+                .Add( "max_query_length", config.max_query_length )
+                .Add( "stop_words", config.stop_words )
+                .Add( "stop_ratio", config.stop_ratio )
+                .Add( "minus_ratio", config.minus_ratio )
+                .Add( "format", std::string( config.compressed ? "compressed" : "plain" ) )
+                .Add( "metrics", config.metrics );
+
+        JsonObject results;
+        results
+                .Add( "split_words_per_s", word_count / split_seconds )
+                .Add( "add_document_docs_per_s", config.documents / add_document_seconds )
+                .Add( "add_documents_docs_per_s", config.documents / add_documents_seconds )
+                .AddLatencies( "find_top_documents", find_top_documents )
+                .AddLatencies( "find_top_documents_wand", find_top_documents_wand )
+                .AddLatencies( "match_document", match_document )
+                .AddLatencies( "add_find_request", add_find_request )
+                .Add( "no_result_requests", request_queue.GetNoResultRequests() )
+                .Add( "peak_rss_kb", GetPeakResidentKilobytes() )
+                .Add( "checksum", checksum );
+
+        JsonObject output;
+        output
+                .Add( "config", config_json )
+                .Add( "results", results );
+
+        if( config.metrics )
+            {
+                const SearchMetrics::Snapshot metrics = search_server.GetMetrics();
+
+                const std::pair< std::string, SearchMetrics::Stage > stages[] = {
+                        { "parse_query", SearchMetrics::Stage::PARSE_QUERY },
+                        { "score_documents", SearchMetrics::Stage::SCORE_DOCUMENTS },
+                        { "collect_documents", SearchMetrics::Stage::COLLECT_DOCUMENTS },
+                        { "select_top_documents", SearchMetrics::Stage::SELECT_TOP_DOCUMENTS } };
+
+                JsonObject metrics_json;
+
+                for( const auto & [ name, stage ] : stages )
+                    {
+                        const LatencyHistogram::Snapshot & histogram = metrics.GetStage( stage );
+
+                        metrics_json
+                                .Add( name + "_count", histogram.count )
+                                .Add( name + "_p50_ns", histogram.GetPercentile( 0.5 ) )
+                                .Add( name + "_p99_ns", histogram.GetPercentile( 0.99 ) )
+                                .Add( name + "_max_ns", histogram.max_nanoseconds );
+                    }
+
+                metrics_json
+                        .Add( "postings_scanned", metrics.GetCounter( SearchMetrics::Counter::POSTINGS_SCANNED ) )
+                        .Add( "documents_scored", metrics.GetCounter( SearchMetrics::Counter::DOCUMENTS_SCORED ) )
+                        .Add( "documents_excluded", metrics.GetCounter( SearchMetrics::Counter::DOCUMENTS_EXCLUDED ) );
+
+                output.Add( "metrics", metrics_json );
+            }
+
+        std::cout << output.str() << '\n';
+    }
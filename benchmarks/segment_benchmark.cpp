@@ -0,0 +1,101 @@
+// Задержка AddDocument по мере роста индекса: единый SearchServer
+// и сегментированный ConcurrentSearchServer с фоновым слиянием.
+// Для каждого окна из window_size документов печатаются средняя
+// и 99-я перцентиль задержки в микросекундах.
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks segment_benchmark && benchmarks/_build/segment_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark_corpus.h"
+#include "concurrent_search_server.h"
+#include "document.h"
+#include "search_server.h"
+
+namespace
+    {
+        constexpr int document_count = 200'000;
+        constexpr int vocabulary_size = 50'000;
+        constexpr int window_size = 20'000;
+
+        // Задержки добавления каждого документа в микросекундах.
+        template < typename Server >
+        std::vector< double >
+        MeasureLatencies( const std::vector< DocumentRecord > & records )
+            {
+                using namespace std::chrono;
+
+                Server search_server( std::string( "w0 w1 w2" ) );
+
+                std::vector< double > latencies;
+                latencies.reserve( records.size() );
+
+                for( const DocumentRecord & record : records )
+                    {
+                        const auto start = steady_clock::now();
+
+                        search_server.AddDocument( record.id, record.text, record.status, record.ratings );
+
+                        latencies.push_back( duration< double, std::micro >( steady_clock::now() - start ).count() );
+                    }
+
+                return latencies;
+            }
+
+        void
+        PrintWindow(
+                std::vector< double > latencies,
+                const std::size_t first )
+            {
+                const auto window_begin = std::next( latencies.begin(), first );
+                const auto window_end = std::next( window_begin, window_size );
+
+                double sum = 0.0;
+
+                for( auto it = window_begin; it != window_end; ++it )
+                    {
+                        sum += *it;
+                    }
+
+                const auto percentile = std::next( window_begin, window_size * 99 / 100 );
+
+                std::nth_element( window_begin, percentile, window_end );
+
+                std::cout << std::setw( 10 ) << sum / window_size << std::setw( 10 ) << *percentile;
+            }
+    }
+
+int
+main()
+    {
+        CorpusConfig corpus_config;
+        corpus_config.documents = document_count;
+        corpus_config.vocabulary = vocabulary_size;
+
+        const std::vector< DocumentRecord > records = CorpusGenerator( corpus_config ).GenerateRecords();
+
+        const std::vector< double > single = MeasureLatencies< SearchServer >( records );
+        const std::vector< double > segmented = MeasureLatencies< ConcurrentSearchServer >( records );
+
+        std::cout
+                << std::fixed << std::setprecision( 1 )
+                << "documents " << std::setw( 20 ) << "SearchServer" << std::setw( 20 ) << "segmented" << '\n'
+                << "          " << std::setw( 10 ) << "mean" << std::setw( 10 ) << "p99"
+                << std::setw( 10 ) << "mean" << std::setw( 10 ) << "p99" << '\n';
+
+        for( std::size_t first = 0; first < records.size(); first += window_size )
+            {
+                std::cout << std::setw( 9 ) << first + window_size << ' ';
+
+                PrintWindow( single, first );
+                PrintWindow( segmented, first );
+
+                std::cout << '\n';
+            }
+    }
@@ -0,0 +1,185 @@
+// Пропускная способность токенизатора и проверки слов в ГБ/с.
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks tokenizer_benchmark && benchmarks/_build/tokenizer_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "byte_scan.h"
+#include "string_processing.h"
+
+namespace
+    {
+        // Прежняя реализация: слово собирается по одному символу в std::string.
+        std::vector< std::string >
+        LegacySplitIntoWords( const std::string & raw_text )
+            {
+                std::vector< std::string > words;
+
+                std::string raw_word;
+
+                for( const char c : raw_text )
+                    {
+                        if( c == ' ' )
+                            {
+                                ValidateRawWord( raw_word );
+                                words.push_back( raw_word );
+                                raw_word.clear();
+                            }
+                        else
+                            {
+                                raw_word += c;
+                            }
+                    }
+
+                ValidateRawWord( raw_word );
+                words.push_back( raw_word );
+
+                return words;
+            }
+
+        bool
+        LegacyIsValidWord( const std::string & raw_word )
+            {
+                return
+                        std::none_of(
+                                raw_word.cbegin(),
+                                raw_word.cend(),
+                                []( const char c )
+                                    {
+                                        return
+                                                ( c >= '\0' )
+                                                &&
+                                                ( c < ' ' );
+                                    } );
+            }
+
+        std::string
+        GenerateText(
+                const std::size_t size,
+                const std::uint32_t seed )
+            {
+                std::mt19937 generator( seed );
+                std::uniform_int_distribution< int > word_length( 1, 12 );
+                std::uniform_int_distribution< int > letter( 'a', 'z' );
+
+                std::string text;
+                text.reserve( size + 16 );
+
+                while( text.size() < size )
+                    {
+                        if( !text.empty() )
+                            {
+                                text += ' ';
+                            }
+
+                        for( int i = word_length( generator ); i > 0; --i )
+                            {
+                                text += static_cast< char >( letter( generator ) );
+                            }
+                    }
+
+                return text;
+            }
+
+        template < typename Function >
+        void
+        Measure(
+                const std::string & name,
+                const std::size_t bytes,
+                const int repetitions,
+                Function function )
+            {
+                using namespace std::chrono;
+
+                std::size_t checksum = 0;
+
+                const auto start = steady_clock::now();
+
+                for( int i = 0; i < repetitions; ++i )
+                    {
+                        checksum += function();
+                    }
+
+                const double seconds = duration< double >( steady_clock::now() - start ).count();
+
+                const double gigabytes_per_second = 1e-9 * bytes * repetitions / seconds;
+
+                std::cout
+                        << std::left << std::setw( 28 ) << name
+                        << std::right << std::fixed << std::setprecision( 3 )
+                        << std::setw( 10 ) << gigabytes_per_second << " GB/s"
+                        << "  (checksum " << checksum << ")\n";
+            }
+    }
+
+int
+main()
+    {
+        constexpr std::size_t text_size = 64 << 20;
+        constexpr int repetitions = 5;
+
+        const std::string text = GenerateText( text_size, 42 );
+
+        const char * const begin = text.data();
+        const char * const end = text.data() + text.size();
+
+        std::cout << "text size: " << text.size() << " bytes\n";
+
+        Measure( "split: legacy", text.size(), repetitions,
+                [&text]()
+                    {
+                        return LegacySplitIntoWords( text ).size();
+                    } );
+
+        Measure( "split: string_view", text.size(), repetitions,
+                [&text]()
+                    {
+                        return SplitIntoWords( text ).size();
+                    } );
+
+        Measure( "validate: legacy", text.size(), repetitions,
+                [&text]()
+                    {
+                        return static_cast< std::size_t >( LegacyIsValidWord( text ) );
+                    } );
+
+        Measure( "validate: dispatched", text.size(), repetitions,
+                [&text]()
+                    {
+                        return static_cast< std::size_t >( IsValidWord( text ) );
+                    } );
+
+        Measure( "scan: scalar", text.size(), repetitions,
+                [begin, end]()
+                    {
+                        return static_cast< std::size_t >( FindByteAtMostScalar( begin, end, ' ' - 1 ) - begin );
+                    } );
+
+#if defined( BYTE_SCAN_HAS_SSE2 )
+        Measure( "scan: sse2", text.size(), repetitions,
+                [begin, end]()
+                    {
+                        return static_cast< std::size_t >( FindByteAtMostSse2( begin, end, ' ' - 1 ) - begin );
+                    } );
+#endif
+
+#if defined( BYTE_SCAN_HAS_AVX2 )
+        if( IsAvx2Supported() )
+            {
+                Measure( "scan: avx2", text.size(), repetitions,
+                        [begin, end]()
+                            {
+                                return static_cast< std::size_t >( FindByteAtMostAvx2( begin, end, ' ' - 1 ) - begin );
+                            } );
+            }
+#endif
+    }
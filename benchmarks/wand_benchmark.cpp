@@ -0,0 +1,95 @@
+// Отбор лучших документов: полный перебор против WAND на запросах из нескольких
+// частых слов, где полный перебор оценивает большую часть корпуса.
+//
+// Сборка и запуск из корня репозитория:
+//     make -C benchmarks wand_benchmark && benchmarks/_build/wand_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark_corpus.h"
+#include "document.h"
+#include "search_server.h"
+
+namespace
+    {
+        constexpr int document_count = 100'000;
+        constexpr int vocabulary_size = 50'000;
+        constexpr int query_count = 2'000;
+
+        template < typename Function >
+        double
+        MeasureSeconds( Function function )
+            {
+                using namespace std::chrono;
+
+                const auto start = steady_clock::now();
+
+                function();
+
+                return duration< double >( steady_clock::now() - start ).count();
+            }
+    }
+
+int
+main()
+    {
+        CorpusConfig corpus_config;
+        corpus_config.documents = document_count;
+        corpus_config.vocabulary = vocabulary_size;
+        corpus_config.min_rating = -10;
+        corpus_config.max_rating = 10;
+
+        CorpusGenerator corpus( corpus_config );
+
+        const std::vector< DocumentRecord > records = corpus.GenerateRecords();
+
+        // Запросы из трёх-шести слов с рангами до 200: у таких слов длинные списки
+        // вхождений, и документов с хотя бы одним словом запроса - большая часть корпуса.
+        QueryConfig query_config;
+        query_config.queries = query_count;
+        query_config.min_length = 3;
+        query_config.max_length = 6;
+        query_config.min_rank = 3;
+        query_config.max_rank = 200;
+
+        const std::vector< std::string > queries = corpus.GenerateQueries( query_config );
+
+        for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+            {
+                SearchServer search_server( std::string( "w0 w1 w2" ), format );
+                search_server.AddDocuments( records.cbegin(), records.cend() );
+
+                std::uint64_t checksum = 0;
+
+                const auto measure = [&]( const QueryMode mode )
+                    {
+                        return
+                                MeasureSeconds(
+                                        [&]()
+                                            {
+                                                for( const std::string & query : queries )
+                                                    {
+                                                        for( const Document & document : search_server.FindTopDocuments( mode, query ) )
+                                                            {
+                                                                checksum += document.id;
+                                                            }
+                                                    }
+                                            } );
+                    };
+
+                const double exhaustive_seconds = measure( QueryMode::EXHAUSTIVE );
+                const double wand_seconds = measure( QueryMode::WAND );
+
+                std::cout
+                        << ( format == PostingsFormat::PLAIN ? "plain\n" : "compressed\n" )
+                        << std::fixed << std::setprecision( 0 )
+                        << "    exhaustive        " << std::setw( 10 ) << queries.size() / exhaustive_seconds << " queries/s\n"
+                        << "    WAND              " << std::setw( 10 ) << queries.size() / wand_seconds << " queries/s\n"
+                        << "    checksum " << checksum << '\n';
+            }
+    }
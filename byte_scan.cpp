@@ -0,0 +1,119 @@
+#include "byte_scan.h"
+
+#if defined( BYTE_SCAN_HAS_SSE2 ) || defined( BYTE_SCAN_HAS_AVX2 )
+#include <immintrin.h>
+#endif
+
+namespace
+    {
+        using ScanFunction = const char * (*)( const char *, const char *, const unsigned char );
+
+        ScanFunction
+        SelectScanFunction()
+            {
+#if defined( BYTE_SCAN_HAS_AVX2 )
+                if( IsAvx2Supported() )
+                    {
+                        return FindByteAtMostAvx2;
+                    }
+#endif
+
+#if defined( BYTE_SCAN_HAS_SSE2 )
+                return FindByteAtMostSse2;
+#else
+                return FindByteAtMostScalar;
+#endif
+            }
+    }
+
+const char *
+FindByteAtMost(
+        const char * begin,
+        const char * end,
+        const unsigned char limit )
+    {
+        static const ScanFunction scan_function = SelectScanFunction();
+
+        return scan_function( begin, end, limit );
+    }
+
+const char *
+FindByteAtMostScalar(
+        const char * begin,
+        const char * end,
+        const unsigned char limit )
+    {
+        for( ; begin != end; ++begin )
+            {
+                if( static_cast< unsigned char >( *begin ) <= limit )
+                    {
+                        return begin;
+                    }
+            }
+
+        return end;
+    }
+
+// Байт не превосходит limit тогда и только тогда, когда
+// беззнаковый минимум байта и limit равен самому байту.
+
+#if defined( BYTE_SCAN_HAS_SSE2 )
+const char *
+FindByteAtMostSse2(
+        const char * begin,
+        const char * end,
+        const unsigned char limit )
+    {
+        constexpr std::size_t block_size = sizeof( __m128i );
+
+        const __m128i limits = _mm_set1_epi8( static_cast< char >( limit ) );
+
+        for( ; static_cast< std::size_t >( end - begin ) >= block_size; begin += block_size )
+            {
+                const __m128i bytes = _mm_loadu_si128( reinterpret_cast< const __m128i * >( begin ) );
+                const __m128i matches = _mm_cmpeq_epi8( _mm_min_epu8( bytes, limits ), bytes );
+                const int mask = _mm_movemask_epi8( matches );
+
+                if( mask != 0 )
+                    {
+                        return begin + __builtin_ctz( static_cast< unsigned >( mask ) );
+                    }
+            }
+
+        return FindByteAtMostScalar( begin, end, limit );
+    }
+#endif
+
+#if defined( BYTE_SCAN_HAS_AVX2 )
+__attribute__(( target( "avx2" ) ))
+const char *
+FindByteAtMostAvx2(
+        const char * begin,
+        const char * end,
+        const unsigned char limit )
+    {
+        constexpr std::size_t block_size = sizeof( __m256i );
+
+        const __m256i limits = _mm256_set1_epi8( static_cast< char >( limit ) );
+
+        for( ; static_cast< std::size_t >( end - begin ) >= block_size; begin += block_size )
+            {
+                const __m256i bytes = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( begin ) );
+                const __m256i matches = _mm256_cmpeq_epi8( _mm256_min_epu8( bytes, limits ), bytes );
+                const int mask = _mm256_movemask_epi8( matches );
+
+                if( mask != 0 )
+                    {
+                        return begin + __builtin_ctz( static_cast< unsigned >( mask ) );
+                    }
+            }
+
+        return FindByteAtMostScalar( begin, end, limit );
+    }
+
+bool
+IsAvx2Supported()
+    {
+        return __builtin_cpu_supports( "avx2" );
+    }
+#endif
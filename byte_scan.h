@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+// Поиск первого байта в [begin, end), код которого (как unsigned char)
+// не превосходит limit. Возвращает end, если такого байта нет.
+//
+// С limit = ' ' находит границу слова или недопустимый символ за один проход,
+// с limit = ' ' - 1 находит только недопустимые символы с кодами от 0 до 31.
+// Реализация выбирается при первом вызове по возможностям процессора.
+const char *
+FindByteAtMost(
+        const char * begin,
+        const char * end,
+        const unsigned char limit );
+
+// Отдельные реализации; доступны для сравнения в бенчмарках.
+const char *
+FindByteAtMostScalar(
+        const char * begin,
+        const char * end,
+        const unsigned char limit );
+
+#if defined( __SSE2__ )
+#define BYTE_SCAN_HAS_SSE2 1
+
+const char *
+FindByteAtMostSse2(
+        const char * begin,
+        const char * end,
+        const unsigned char limit );
+#endif
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define BYTE_SCAN_HAS_AVX2 1
+
+const char *
+FindByteAtMostAvx2(
+        const char * begin,
+        const char * end,
+        const unsigned char limit );
+
+bool
+IsAvx2Supported();
+#endif
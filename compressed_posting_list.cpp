@@ -0,0 +1,451 @@
+#include <iterator>
+
+#include "compressed_posting_list.h"
+
+void
+CompressedPostingList::Insert(
+        const int document_id,
+        const std::uint32_t term_freq_code )
+    {
+        if(
+                blocks_.empty()
+                ||
+                blocks_.back().last_document_id < document_id )
+            {
+                Append( document_id, term_freq_code );
+
+                return;
+            }
+
+        std::vector< int > document_ids;
+        std::vector< std::uint32_t > term_freq_codes;
+        Decode( document_ids, term_freq_codes );
+
+        const auto position = std::lower_bound( document_ids.cbegin(), document_ids.cend(), document_id );
+        const auto offset = std::distance( document_ids.cbegin(), position );
+
+        document_ids.insert( position, document_id );
+        term_freq_codes.insert( std::next( term_freq_codes.cbegin(), offset ), term_freq_code );
+
+        Rebuild( document_ids, term_freq_codes );
+    }
+
+void
+CompressedPostingList::Merge(
+        const std::vector< int > & document_ids,
+        const std::vector< std::uint32_t > & term_freq_codes )
+    {
+        if( document_ids.empty() )
+            {
+                return;
+            }
+
+        if(
+                blocks_.empty()
+                ||
+                blocks_.back().last_document_id < document_ids.front() )
+            {
+                for( std::size_t i = 0; i < document_ids.size(); ++i )
+                    {
+                        Append( document_ids[ i ], term_freq_codes[ i ] );
+                    }
+
+                return;
+            }
+
+        std::vector< int > old_document_ids;
+        std::vector< std::uint32_t > old_term_freq_codes;
+        Decode( old_document_ids, old_term_freq_codes );
+
+        std::vector< int > merged_document_ids;
+        std::vector< std::uint32_t > merged_term_freq_codes;
+        merged_document_ids.reserve( old_document_ids.size() + document_ids.size() );
+        merged_term_freq_codes.reserve( old_document_ids.size() + document_ids.size() );
+
+        std::size_t i = 0;
+
+        for( std::size_t j = 0; j < document_ids.size(); ++j )
+            {
+                for( ; i < old_document_ids.size() && old_document_ids[ i ] < document_ids[ j ]; ++i )
+                    {
+                        merged_document_ids.push_back( old_document_ids[ i ] );
+                        merged_term_freq_codes.push_back( old_term_freq_codes[ i ] );
+                    }
+
+                merged_document_ids.push_back( document_ids[ j ] );
+                merged_term_freq_codes.push_back( term_freq_codes[ j ] );
+            }
+
+        for( ; i < old_document_ids.size(); ++i )
+            {
+                merged_document_ids.push_back( old_document_ids[ i ] );
+                merged_term_freq_codes.push_back( old_term_freq_codes[ i ] );
+            }
+
+        Rebuild( merged_document_ids, merged_term_freq_codes );
+    }
+
+void
+CompressedPostingList::Erase( const int document_id )
+    {
+        const auto block = std::lower_bound(
+                blocks_.begin(),
+                blocks_.end(),
+                document_id,
+                []( const Block & block, const int id )
+                    {
+                        return block.last_document_id < id;
+                    } );
+
+        if(
+                block == blocks_.end()
+                ||
+                block->first_document_id > document_id )
+            {
+                return;
+            }
+
+        std::array< int, BLOCK_SIZE > document_ids;
+        std::array< std::uint32_t, BLOCK_SIZE > term_freq_codes;
+        std::size_t kept_count = 0;
+        bool found = false;
+
+        auto visitor = [document_id, &document_ids, &term_freq_codes, &kept_count, &found]( const int id, const std::uint32_t term_freq_code )
+            {
+                if( id == document_id )
+                    {
+                        found = true;
+
+                        return;
+                    }
+
+                document_ids[ kept_count ] = id;
+                term_freq_codes[ kept_count ] = term_freq_code;
+                ++kept_count;
+            };
+
+        DecodeBlock( *block, visitor );
+
+        if( !found )
+            {
+                return;
+            }
+
+        --size_;
+
+        const bool is_last_block = ( std::next( block ) == blocks_.end() );
+
+        if( kept_count == 0 )
+            {
+                if( is_last_block )
+                    {
+                        bytes_.resize( block->offset );
+                    }
+
+                blocks_.erase( block );
+
+                return;
+            }
+
+        // Без одного постинга разности и коды блока занимают не больше байт,
+        // чем прежде, поэтому блок перезаписывается на своём месте. Освободившиеся
+        // байты в середине списка остаются неиспользованными до перекодирования.
+        std::uint8_t * position = bytes_.data() + block->offset;
+        int previous_document_id = document_ids[ 0 ];
+
+        for( std::size_t i = 0; i < kept_count; ++i )
+            {
+                WriteVarint( static_cast< std::uint32_t >( document_ids[ i ] - previous_document_id ), position );
+                WriteVarint( term_freq_codes[ i ], position );
+
+                previous_document_id = document_ids[ i ];
+            }
+
+        block->first_document_id = document_ids[ 0 ];
+        block->last_document_id = document_ids[ kept_count - 1 ];
+        block->size = static_cast< std::uint32_t >( kept_count );
+
+        // Append дописывает в последний блок с конца bytes_.
+        if( is_last_block )
+            {
+                bytes_.resize( static_cast< std::size_t >( position - bytes_.data() ) );
+            }
+    }
+
+void
+CompressedPostingList::Erase( const std::vector< int > & document_ids )
+    {
+        if( document_ids.empty() )
+            {
+                return;
+            }
+
+        std::vector< int > old_document_ids;
+        std::vector< std::uint32_t > old_term_freq_codes;
+        Decode( old_document_ids, old_term_freq_codes );
+
+        std::vector< int > kept_document_ids;
+        std::vector< std::uint32_t > kept_term_freq_codes;
+        kept_document_ids.reserve( old_document_ids.size() );
+        kept_term_freq_codes.reserve( old_document_ids.size() );
+
+        auto removed = document_ids.cbegin();
+
+        for( std::size_t i = 0; i < old_document_ids.size(); ++i )
+            {
+                while(
+                        removed != document_ids.cend()
+                        &&
+                        *removed < old_document_ids[ i ] )
+                    {
+                        ++removed;
+                    }
+
+                if(
+                        removed == document_ids.cend()
+                        ||
+                        *removed != old_document_ids[ i ] )
+                    {
+                        kept_document_ids.push_back( old_document_ids[ i ] );
+                        kept_term_freq_codes.push_back( old_term_freq_codes[ i ] );
+                    }
+            }
+
+        if( kept_document_ids.size() != old_document_ids.size() )
+            {
+                Rebuild( kept_document_ids, kept_term_freq_codes );
+            }
+    }
+
+bool
+CompressedPostingList::Contains( const int document_id ) const
+    {
+        const auto block = std::lower_bound(
+                blocks_.cbegin(),
+                blocks_.cend(),
+                document_id,
+                []( const Block & block, const int id )
+                    {
+                        return block.last_document_id < id;
+                    } );
+
+        if(
+                block == blocks_.cend()
+                ||
+                block->first_document_id > document_id )
+            {
+                return false;
+            }
+
+        bool found = false;
+
+        auto visitor = [document_id, &found]( const int id, const std::uint32_t )
+            {
+                found = found || ( id == document_id );
+            };
+
+        DecodeBlock( *block, visitor );
+
+        return found;
+    }
+
+std::size_t
+CompressedPostingList::size() const
+    {
+        return size_;
+    }
+
+std::size_t
+CompressedPostingList::GetMemoryUsage() const
+    {
+        return
+                sizeof( *this )
+                +
+                blocks_.capacity() * sizeof( Block )
+                +
+                bytes_.capacity() * sizeof( std::uint8_t );
+    }
+
+void
+CompressedPostingList::Append(
+        const int document_id,
+        const std::uint32_t term_freq_code )
+    {
+        if(
+                blocks_.empty()
+                ||
+                blocks_.back().size == BLOCK_SIZE )
+            {
+                blocks_.push_back(
+                        {
+                            document_id,
+                            document_id,
+                            static_cast< std::uint32_t >( bytes_.size() ),
+                            0
+                        } );
+            }
+
+        Block & block = blocks_.back();
+
+        WriteVarint( static_cast< std::uint32_t >( document_id - block.last_document_id ) );
+        WriteVarint( term_freq_code );
+
+        block.last_document_id = document_id;
+        ++block.size;
+        ++size_;
+    }
+
+void
+CompressedPostingList::Rebuild(
+        const std::vector< int > & document_ids,
+        const std::vector< std::uint32_t > & term_freq_codes )
+    {
+        blocks_.clear();
+        bytes_.clear();
+        size_ = 0;
+
+        for( std::size_t i = 0; i < document_ids.size(); ++i )
+            {
+                Append( document_ids[ i ], term_freq_codes[ i ] );
+            }
+    }
+
+void
+CompressedPostingList::Decode(
+        std::vector< int > & document_ids,
+        std::vector< std::uint32_t > & term_freq_codes ) const
+    {
+        document_ids.reserve( size_ );
+        term_freq_codes.reserve( size_ );
+
+        ForEach(
+                [&document_ids, &term_freq_codes]( const int document_id, const std::uint32_t term_freq_code )
+                    {
+                        document_ids.push_back( document_id );
+                        term_freq_codes.push_back( term_freq_code );
+                    } );
+    }
+
+void
+CompressedPostingList::WriteVarint( std::uint32_t value )
+    {
+        while( value >= 0x80 )
+            {
+                bytes_.push_back( static_cast< std::uint8_t >( value | 0x80 ) );
+                value >>= 7;
+            }
+
+        bytes_.push_back( static_cast< std::uint8_t >( value ) );
+    }
+
+void
+CompressedPostingList::WriteVarint(
+        std::uint32_t value,
+        std::uint8_t * & position )
+    {
+        while( value >= 0x80 )
+            {
+                *position++ = static_cast< std::uint8_t >( value | 0x80 );
+                value >>= 7;
+            }
+
+        *position++ = static_cast< std::uint8_t >( value );
+    }
+
+CompressedPostingList::Cursor::Cursor( const CompressedPostingList & postings )
+    :
+        postings_( &postings )
+    {
+        LoadBlock( 0 );
+    }
+
+bool
+CompressedPostingList::Cursor::IsEnd() const
+    {
+        return block_ >= postings_->blocks_.size();
+    }
+
+int
+CompressedPostingList::Cursor::GetDocumentId() const
+    {
+        return document_ids_[ position_ ];
+    }
+
+std::uint32_t
+CompressedPostingList::Cursor::GetTermFreqCode() const
+    {
+        return term_freq_codes_[ position_ ];
+    }
+
+void
+CompressedPostingList::Cursor::Next()
+    {
+        if( ++position_ == block_size_ )
+            {
+                LoadBlock( block_ + 1 );
+            }
+    }
+
+void
+CompressedPostingList::Cursor::Seek( const int document_id )
+    {
+        if(
+                IsEnd()
+                ||
+                GetDocumentId() >= document_id )
+            {
+                return;
+            }
+
+        const std::vector< Block > & blocks = postings_->blocks_;
+
+        if( blocks[ block_ ].last_document_id < document_id )
+            {
+                const auto block = std::lower_bound(
+                        std::next( blocks.cbegin(), block_ + 1 ),
+                        blocks.cend(),
+                        document_id,
+                        []( const Block & block, const int id )
+                            {
+                                return block.last_document_id < id;
+                            } );
+
+                LoadBlock( std::distance( blocks.cbegin(), block ) );
+
+                if( IsEnd() )
+                    {
+                        return;
+                    }
+            }
+
+        // В текущем блоке есть id не меньше document_id: его последний id.
+        position_ = std::distance(
+                document_ids_.cbegin(),
+                std::lower_bound(
+                        std::next( document_ids_.cbegin(), position_ ),
+                        std::next( document_ids_.cbegin(), block_size_ ),
+                        document_id ) );
+    }
+
+void
+CompressedPostingList::Cursor::LoadBlock( const std::size_t block )
+    {
+        block_ = block;
+        position_ = 0;
+        block_size_ = 0;
+
+        if( IsEnd() )
+            {
+                return;
+            }
+
+        auto append = [this]( const int document_id, const std::uint32_t term_freq_code )
+            {
+                document_ids_[ block_size_ ] = document_id;
+                term_freq_codes_[ block_size_ ] = term_freq_code;
+
+                ++block_size_;
+            };
+
+        postings_->DecodeBlock( postings_->blocks_[ block ], append );
+    }
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Сжатый список постингов. Постинги разбиты на блоки по BLOCK_SIZE штук;
+// внутри блока id документов записаны разностями с предыдущим id,
+// а разности и коды частот - в формате varint (по 7 бит в байте).
+// Заголовки блоков хранят границы id, что позволяет искать документ,
+// декодируя только один блок, и обходить блоки независимо.
+class CompressedPostingList
+    {
+
+        public:
+
+            static constexpr std::size_t BLOCK_SIZE = 128;
+
+            // Курсор по постингам в порядке возрастания id документов. Seek пропускает
+            // блоки по заголовкам, не декодируя их; декодируется только блок,
+            // на котором курсор остановился.
+            class Cursor
+                {
+
+                    public:
+
+                        explicit Cursor( const CompressedPostingList & postings );
+
+                        bool
+                        IsEnd() const;
+
+                        int
+                        GetDocumentId() const;
+
+                        std::uint32_t
+                        GetTermFreqCode() const;
+
+                        void
+                        Next();
+
+                        // Переходит к первому постингу с id не меньше document_id.
+                        void
+                        Seek( const int document_id );
+
+                    private:
+
+                        const CompressedPostingList * postings_;
+
+                        std::size_t block_ = 0;
+
+                        std::size_t position_ = 0;
+
+                        // Декодированный текущий блок: первые block_size_ элементов.
+                        // Массивы фиксированного размера - курсор не выделяет память.
+                        std::array< int, BLOCK_SIZE > document_ids_;
+
+                        std::array< std::uint32_t, BLOCK_SIZE > term_freq_codes_;
+
+                        std::size_t block_size_ = 0;
+
+                        void
+                        LoadBlock( const std::size_t block );
+                };
+
+            // Вставка в конец стоит O(1), вставка в середину перекодирует весь список.
+            void
+            Insert(
+                    const int document_id,
+                    const std::uint32_t term_freq_code );
+
+            // Вставляет постинги, упорядоченные по возрастанию id;
+            // список перекодируется не более одного раза.
+            void
+            Merge(
+                    const std::vector< int > & document_ids,
+                    const std::vector< std::uint32_t > & term_freq_codes );
+
+            // Декодирует и перезаписывает на месте только блок с документом:
+            // O( BLOCK_SIZE ) плюс O( число блоков ), если блок опустел.
+            void
+            Erase( const int document_id );
+
+            // Удаляет документы с id из document_ids, упорядоченных по возрастанию;
+            // список перекодируется не более одного раза.
+            void
+            Erase( const std::vector< int > & document_ids );
+
+            bool
+            Contains( const int document_id ) const;
+
+            std::size_t
+            size() const;
+
+            std::size_t
+            GetMemoryUsage() const;
+
+            template < typename Visitor >
+            void
+            ForEach( Visitor visitor ) const
+                {
+                    for( const Block & block : blocks_ )
+                        {
+                            DecodeBlock( block, visitor );
+                        }
+                }
+
+            // Обходит только постинги с id из [ first_document_id, last_document_id ];
+            // блоки вне отрезка пропускаются по заголовкам, не декодируясь.
+            template < typename Visitor >
+            void
+            ForEach(
+                    const int first_document_id,
+                    const int last_document_id,
+                    Visitor visitor ) const
+                {
+                    auto visit_in_range =
+                            [first_document_id, last_document_id, &visitor](
+                                    const int document_id,
+                                    const std::uint32_t term_freq_code )
+                                {
+                                    if(
+                                            document_id >= first_document_id
+                                            &&
+                                            document_id <= last_document_id )
+                                        {
+                                            visitor( document_id, term_freq_code );
+                                        }
+                                };
+
+                    auto block = std::lower_bound(
+                            blocks_.cbegin(),
+                            blocks_.cend(),
+                            first_document_id,
+                            []( const Block & block, const int document_id )
+                                {
+                                    return block.last_document_id < document_id;
+                                } );
+
+                    for( ; block != blocks_.cend() && block->first_document_id <= last_document_id; ++block )
+                        {
+                            DecodeBlock( *block, visit_in_range );
+                        }
+                }
+
+        private:
+
+            struct Block
+                {
+                    int first_document_id;
+                    int last_document_id;
+                    std::uint32_t offset;
+                    std::uint32_t size;
+                };
+
+            std::vector< Block > blocks_;
+
+            std::vector< std::uint8_t > bytes_;
+
+            std::size_t size_ = 0;
+
+            void
+            Append(
+                    const int document_id,
+                    const std::uint32_t term_freq_code );
+
+            void
+            Rebuild(
+                    const std::vector< int > & document_ids,
+                    const std::vector< std::uint32_t > & term_freq_codes );
+
+            void
+            Decode(
+                    std::vector< int > & document_ids,
+                    std::vector< std::uint32_t > & term_freq_codes ) const;
+
+            void
+            WriteVarint( std::uint32_t value );
+
+            static void
+            WriteVarint(
+                    std::uint32_t value,
+                    std::uint8_t * & position );
+
+            static std::uint32_t
+            ReadVarint( const std::uint8_t * & position );
+
+            template < typename Visitor >
+            void
+            DecodeBlock(
+                    const Block & block,
+                    Visitor & visitor ) const
+                {
+                    const std::uint8_t * position = bytes_.data() + block.offset;
+
+                    int document_id = block.first_document_id;
+
+                    for( std::uint32_t i = 0; i < block.size; ++i )
+                        {
+                            document_id += static_cast< int >( ReadVarint( position ) );
+
+                            const std::uint32_t term_freq_code = ReadVarint( position );
+
+                            visitor( document_id, term_freq_code );
+                        }
+                }
+    };
+
+inline std::uint32_t
+CompressedPostingList::ReadVarint( const std::uint8_t * & position )
+    {
+        std::uint32_t value = *position & 0x7F;
+
+        for( int shift = 7; *position++ & 0x80; shift += 7 )
+            {
+                value |= static_cast< std::uint32_t >( *position & 0x7F ) << shift;
+            }
+
+        return value;
+    }
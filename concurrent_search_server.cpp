@@ -0,0 +1,640 @@
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+
+#include "concurrent_search_server.h"
+
+ConcurrentSearchServer::ConcurrentSearchServer(
+        const std::string & stop_words_text,
+        const std::size_t segment_capacity )
+    :
+          stop_words_text_( stop_words_text )
+        , segment_capacity_( std::max( segment_capacity, std::size_t{ 1 } ) )
+        , mutable_segment_( std::make_unique< SearchServer >( stop_words_text ) )
+        , published_mutable_segment_( std::make_shared< const SearchServer >( *mutable_segment_ ) )
+    {
+        Publish();
+
+        merge_thread_ = std::thread( &ConcurrentSearchServer::MergeSegments, this );
+    }
+
+ConcurrentSearchServer::~ConcurrentSearchServer()
+    {
+        {
+            const std::lock_guard lock( write_mutex_ );
+
+            is_stopping_ = true;
+        }
+
+        merge_condition_.notify_all();
+        merge_thread_.join();
+
+        delete generation_.load();
+    }
+
+void
+ConcurrentSearchServer::AddDocument(
+        const int document_id,
+        const std::string_view document,
+        const DocumentStatus status,
+        const std::vector< int > & ratings )
+    {
+        const std::lock_guard lock( write_mutex_ );
+
+        ThrowIfLiveSegmentDocument( document_id );
+
+        mutable_segment_->AddDocument( document_id, document, status, ratings );
+
+        FreezeIfFull();
+        Publish();
+    }
+
+void
+ConcurrentSearchServer::RemoveDocument( const int document_id )
+    {
+        const std::lock_guard lock( write_mutex_ );
+
+        if( mutable_segment_->ContainsDocument( document_id ) )
+            {
+                mutable_segment_->RemoveDocument( document_id );
+
+                published_mutable_segment_ = std::make_shared< const SearchServer >( *mutable_segment_ );
+
+                Publish();
+
+                return;
+            }
+
+        const std::size_t segment_index = FindLiveSegment( document_id );
+
+        if( segment_index == segments_.size() )
+            {
+                return;
+            }
+
+        segments_[ segment_index ].MarkRemoved( document_id );
+
+        Publish();
+
+        merge_condition_.notify_all();
+    }
+
+std::vector< Document >
+ConcurrentSearchServer::FindTopDocuments(
+        const std::string_view raw_query,
+        const DocumentStatus status,
+        const std::size_t max_result_count ) const
+    {
+        return
+                FindTopDocuments(
+                        raw_query,
+                        MakeStatusPredicate( status ),
+                        max_result_count );
+    }
+
+std::tuple< std::vector< std::string >, DocumentStatus >
+ConcurrentSearchServer::MatchDocument(
+        const std::string_view raw_query,
+        const int document_id ) const
+    {
+        const EpochManager::Guard guard( epochs_ );
+
+        const Generation & generation = *generation_.load();
+
+        // Живой документ есть не более чем в одном сегменте. Если его нет нигде,
+        // изменяемый сегмент разберёт запрос и бросит то же исключение, что и единый сервер.
+        const SearchServer * server = generation.mutable_segment.get();
+
+        if( !server->ContainsDocument( document_id ) )
+            {
+                for( const Segment & segment : generation.segments )
+                    {
+                        if( segment.IsLive( document_id ) )
+                            {
+                                server = segment.server.get();
+
+                                break;
+                            }
+                    }
+            }
+
+        const auto [ words, status ] = server->MatchDocument( raw_query, document_id );
+
+        return { std::vector< std::string >( words.cbegin(), words.cend() ), status };
+    }
+
+int
+ConcurrentSearchServer::GetDocumentCount() const
+    {
+        const EpochManager::Guard guard( epochs_ );
+
+        return generation_.load()->document_count;
+    }
+
+std::size_t
+ConcurrentSearchServer::GetSegmentCount() const
+    {
+        const EpochManager::Guard guard( epochs_ );
+
+        return generation_.load()->segments.size();
+    }
+
+void
+ConcurrentSearchServer::WaitForMerges()
+    {
+        std::unique_lock lock( write_mutex_ );
+
+        merge_condition_.wait(
+                lock,
+                [this]()
+                    {
+                        return
+                                !is_merging_
+                                &&
+                                PlanMerge().empty();
+                    } );
+    }
+
+bool
+ConcurrentSearchServer::Segment::IsRemoved( const int document_id ) const
+    {
+        for( const TombstoneLevel * level = tombstones.get(); level != nullptr; level = level->older_level.get() )
+            {
+                if( std::binary_search( level->document_ids.cbegin(), level->document_ids.cend(), document_id ) )
+                    {
+                        return true;
+                    }
+            }
+
+        return false;
+    }
+
+bool
+ConcurrentSearchServer::Segment::IsLive( const int document_id ) const
+    {
+        return
+                server->ContainsDocument( document_id )
+                &&
+                !IsRemoved( document_id );
+    }
+
+std::size_t
+ConcurrentSearchServer::Segment::GetRemovedDocumentCount() const
+    {
+        return tombstones == nullptr ? 0 : tombstones->document_count;
+    }
+
+std::size_t
+ConcurrentSearchServer::Segment::GetLiveDocumentCount() const
+    {
+        return server->GetDocumentCount() - GetRemovedDocumentCount();
+    }
+
+std::size_t
+ConcurrentSearchServer::Segment::GetLiveDocumentFreq( const std::string_view word ) const
+    {
+        std::size_t document_freq = server->GetDocumentFreq( word );
+
+        for( const TombstoneLevel * level = tombstones.get(); level != nullptr; level = level->older_level.get() )
+            {
+                const auto it = level->document_freqs.find( word );
+
+                if( it != level->document_freqs.cend() )
+                    {
+                        document_freq -= it->second;
+                    }
+            }
+
+        return document_freq;
+    }
+
+std::vector< int >
+ConcurrentSearchServer::Segment::GetRemovedIds() const
+    {
+        std::vector< int > document_ids;
+        document_ids.reserve( GetRemovedDocumentCount() );
+
+        for( const TombstoneLevel * level = tombstones.get(); level != nullptr; level = level->older_level.get() )
+            {
+                const auto middle = document_ids.insert( document_ids.end(), level->document_ids.cbegin(), level->document_ids.cend() );
+
+                std::inplace_merge( document_ids.begin(), middle, document_ids.end() );
+            }
+
+        return document_ids;
+    }
+
+void
+ConcurrentSearchServer::Segment::MarkRemoved( const int document_id )
+    {
+        auto level = std::make_shared< TombstoneLevel >();
+
+        level->document_ids.push_back( document_id );
+
+        for( const auto & [ word, _ ] : server->GetWordFrequencies( document_id ) )
+            {
+                level->document_freqs.emplace( word, 1 );
+            }
+
+        level->older_level = tombstones;
+
+        // Уровни соседнего размера сливаются в новый; старые уровни остаются
+        // в опубликованных поколениях без изменений.
+        while(
+                level->older_level != nullptr
+                &&
+                level->older_level->document_ids.size() <= 2 * level->document_ids.size() )
+            {
+                const TombstoneLevel & older_level = *level->older_level;
+
+                std::vector< int > document_ids;
+                document_ids.reserve( level->document_ids.size() + older_level.document_ids.size() );
+
+                std::merge(
+                        level->document_ids.cbegin(),
+                        level->document_ids.cend(),
+                        older_level.document_ids.cbegin(),
+                        older_level.document_ids.cend(),
+                        std::back_inserter( document_ids ) );
+
+                level->document_ids = std::move( document_ids );
+
+                for( const auto & [ word, document_freq ] : older_level.document_freqs )
+                    {
+                        level->document_freqs[ word ] += document_freq;
+                    }
+
+                level->older_level = older_level.older_level;
+            }
+
+        level->document_count =
+                level->document_ids.size()
+                +
+                ( level->older_level == nullptr ? 0 : level->older_level->document_count );
+
+        tombstones = std::move( level );
+    }
+
+double
+ConcurrentSearchServer::Generation::ComputeWordInverseDocumentFreq( const std::string_view word ) const
+    {
+        std::size_t document_freq = mutable_segment->GetDocumentFreq( word );
+
+        for( const Segment & segment : segments )
+            {
+                document_freq += segment.GetLiveDocumentFreq( word );
+            }
+
+        return
+                std::log(
+                            1.0
+                            *
+                            document_count
+                            /
+                            document_freq );
+    }
+
+void
+ConcurrentSearchServer::AddDocumentBatch( const std::vector< DocumentRecord > & records )
+    {
+        if( records.empty() )
+            {
+                return;
+            }
+
+        const std::lock_guard lock( write_mutex_ );
+
+        // Записи до первого id, совпадающего с живым документом замороженного сегмента,
+        // передаются изменяемому сегменту; он принимает их до своей первой ошибки.
+        // Выбрасывается более ранняя из ошибок.
+        std::size_t valid_count = 0;
+        std::exception_ptr error;
+
+        for( ; valid_count < records.size(); ++valid_count )
+            {
+                try
+                    {
+                        ThrowIfLiveSegmentDocument( records[ valid_count ].id );
+                    }
+                catch( ... )
+                    {
+                        error = std::current_exception();
+
+                        break;
+                    }
+            }
+
+        const int document_count = mutable_segment_->GetDocumentCount();
+
+        try
+            {
+                mutable_segment_->AddDocuments( records.cbegin(), std::next( records.cbegin(), valid_count ) );
+            }
+        catch( ... )
+            {
+                error = std::current_exception();
+            }
+
+        // Большой пакет замораживается целиком: слияние разложит его по ярусам.
+        if( mutable_segment_->GetDocumentCount() > document_count )
+            {
+                FreezeIfFull();
+                Publish();
+            }
+
+        if( error )
+            {
+                std::rethrow_exception( error );
+            }
+    }
+
+std::size_t
+ConcurrentSearchServer::FindLiveSegment( const int document_id ) const
+    {
+        for( std::size_t i = 0; i < segments_.size(); ++i )
+            {
+                if( segments_[ i ].IsLive( document_id ) )
+                    {
+                        return i;
+                    }
+            }
+
+        return segments_.size();
+    }
+
+void
+ConcurrentSearchServer::ThrowIfLiveSegmentDocument( const int document_id ) const
+    {
+        // Отрицательный id отвергнет изменяемый сегмент, с тем же сообщением, что и единый сервер.
+        if(
+                document_id >= 0
+                &&
+                FindLiveSegment( document_id ) != segments_.size() )
+            {
+                using namespace std::string_literals;
+
+                throw std::invalid_argument(
+                        "Попытка добавить документ c id ранее добавленного документа."s );
+            }
+    }
+
+void
+ConcurrentSearchServer::FreezeIfFull()
+    {
+        if( static_cast< std::size_t >( mutable_segment_->GetDocumentCount() ) < segment_capacity_ )
+            {
+                published_mutable_segment_ = std::make_shared< const SearchServer >( *mutable_segment_ );
+
+                return;
+            }
+
+        segments_.push_back(
+                Segment
+                    {
+                        std::move( mutable_segment_ ),
+                        nullptr
+                    } );
+
+        mutable_segment_ = std::make_unique< SearchServer >( stop_words_text_ );
+        published_mutable_segment_ = std::make_shared< const SearchServer >( *mutable_segment_ );
+
+        merge_condition_.notify_all();
+    }
+
+std::vector< std::size_t >
+ConcurrentSearchServer::PlanMerge() const
+    {
+        // Ярус сегмента - число раз, которое segment_capacity_ можно умножить на MERGE_FACTOR,
+        // не превысив число его живых документов.
+        std::map< int, std::vector< std::size_t > > tiers;
+
+        for( std::size_t i = 0; i < segments_.size(); ++i )
+            {
+                int tier = 0;
+
+                for(
+                        std::size_t tier_limit = segment_capacity_ * MERGE_FACTOR;
+                        segments_[ i ].GetLiveDocumentCount() >= tier_limit;
+                        tier_limit *= MERGE_FACTOR )
+                    {
+                        ++tier;
+                    }
+
+                tiers[ tier ].push_back( i );
+            }
+
+        for( const auto & [ _, tier_segments ] : tiers )
+            {
+                if( tier_segments.size() >= MERGE_FACTOR )
+                    {
+                        return tier_segments;
+                    }
+            }
+
+        // Сегмент, в котором отмечена половина документов, переписывается отдельно.
+        for( std::size_t i = 0; i < segments_.size(); ++i )
+            {
+                const Segment & segment = segments_[ i ];
+
+                if(
+                        segment.tombstones != nullptr
+                        &&
+                        segment.GetRemovedDocumentCount() * 2 >= static_cast< std::size_t >( segment.server->GetDocumentCount() ) )
+                    {
+                        return { i };
+                    }
+            }
+
+        return {};
+    }
+
+void
+ConcurrentSearchServer::MergeSegments()
+    {
+        std::unique_lock lock( write_mutex_ );
+
+        while( true )
+            {
+                std::vector< std::size_t > plan;
+
+                merge_condition_.wait(
+                        lock,
+                        [this, &plan]()
+                            {
+                                if( is_stopping_ )
+                                    {
+                                        return true;
+                                    }
+
+                                plan = PlanMerge();
+
+                                return !plan.empty();
+                            } );
+
+                if( is_stopping_ )
+                    {
+                        return;
+                    }
+
+                std::vector< Segment > segments;
+
+                for( const std::size_t i : plan )
+                    {
+                        segments.push_back( segments_[ i ] );
+                    }
+
+                // Сегменты неизменяемы, поэтому сливаются без блокировки;
+                // писатели тем временем добавляют сегменты и отметки.
+                is_merging_ = true;
+                lock.unlock();
+
+                std::shared_ptr< const SearchServer > merged_server = BuildMergedSegment( segments );
+
+                lock.lock();
+                is_merging_ = false;
+
+                if( is_stopping_ )
+                    {
+                        return;
+                    }
+
+                InstallMergedSegment( segments, std::move( merged_server ) );
+                Publish();
+
+                merge_condition_.notify_all();
+            }
+    }
+
+std::shared_ptr< const SearchServer >
+ConcurrentSearchServer::BuildMergedSegment( const std::vector< Segment > & segments ) const
+    {
+        // Документы переносятся в порядке id, чтобы списки вхождений только дописывались.
+        std::vector< std::pair< int, const SearchServer * > > documents;
+
+        for( const Segment & segment : segments )
+            {
+                for( const int document_id : *segment.server )
+                    {
+                        if( !segment.IsRemoved( document_id ) )
+                            {
+                                documents.emplace_back( document_id, segment.server.get() );
+                            }
+                    }
+            }
+
+        std::sort( documents.begin(), documents.end() );
+
+        auto server = std::make_shared< SearchServer >( stop_words_text_ );
+
+        for( const auto & [ document_id, source ] : documents )
+            {
+                if( is_stopping_ )
+                    {
+                        break;
+                    }
+
+                server->AddDocumentFrom( *source, document_id );
+            }
+
+        return server;
+    }
+
+void
+ConcurrentSearchServer::InstallMergedSegment(
+        const std::vector< Segment > & segments,
+        std::shared_ptr< const SearchServer > merged_server )
+    {
+        // Отметки, поставленные во время слияния, относятся к документам нового сегмента.
+        Segment merged_segment{ std::move( merged_server ), nullptr };
+
+        std::vector< Segment > installed_segments;
+        std::size_t merged_position = segments_.size();
+
+        for( const Segment & segment : segments_ )
+            {
+                const auto merged = std::find_if(
+                        segments.cbegin(),
+                        segments.cend(),
+                        [&segment]( const Segment & merged_segment )
+                            {
+                                return merged_segment.server == segment.server;
+                            } );
+
+                if( merged == segments.cend() )
+                    {
+                        installed_segments.push_back( segment );
+
+                        continue;
+                    }
+
+                if( segment.tombstones != merged->tombstones )
+                    {
+                        const std::vector< int > removed_ids = segment.GetRemovedIds();
+                        const std::vector< int > merged_removed_ids = merged->GetRemovedIds();
+
+                        std::vector< int > new_removed_ids;
+
+                        std::set_difference(
+                                removed_ids.cbegin(),
+                                removed_ids.cend(),
+                                merged_removed_ids.cbegin(),
+                                merged_removed_ids.cend(),
+                                std::back_inserter( new_removed_ids ) );
+
+                        for( const int document_id : new_removed_ids )
+                            {
+                                merged_segment.MarkRemoved( document_id );
+                            }
+                    }
+
+                merged_position = std::min( merged_position, installed_segments.size() );
+            }
+
+        // Сегмент, все документы которого удалены, не нужен.
+        if( merged_segment.server->GetDocumentCount() > 0 )
+            {
+                installed_segments.insert(
+                        std::next( installed_segments.begin(), merged_position ),
+                        std::move( merged_segment ) );
+            }
+
+        segments_ = std::move( installed_segments );
+    }
+
+void
+ConcurrentSearchServer::Publish()
+    {
+        int document_count = mutable_segment_->GetDocumentCount();
+
+        for( const Segment & segment : segments_ )
+            {
+                document_count += static_cast< int >( segment.GetLiveDocumentCount() );
+            }
+
+        auto generation = std::make_unique< const Generation >(
+                Generation
+                    {
+                        segments_,
+                        published_mutable_segment_,
+                        document_count
+                    } );
+
+        const Generation * const retired = generation_.exchange( generation.release() );
+
+        if( retired != nullptr )
+            {
+                retired_generations_.emplace_back( epochs_.Advance(), retired );
+            }
+
+        // Освобождаются поколения, которые уже не может читать ни один поток.
+        retired_generations_.erase(
+                std::remove_if(
+                        retired_generations_.begin(),
+                        retired_generations_.end(),
+                        [this]( const auto & retired_generation )
+                            {
+                                return epochs_.IsQuiescent( retired_generation.first );
+                            } ),
+                retired_generations_.end() );
+    }
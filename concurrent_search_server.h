@@ -0,0 +1,317 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+#include "epoch_manager.h"
+#include "search_server.h"
+
+// Поисковый сервер, который можно опрашивать во время изменения.
+//
+// Индекс разбит на сегменты (LSM). Новые документы попадают в небольшой
+// изменяемый сегмент; когда в нём набирается segment_capacity документов,
+// он замораживается и становится неизменяемым. Фоновый поток сливает
+// замороженные сегменты по ярусной политике: как только в ярусе оказывается
+// MERGE_FACTOR сегментов близкого размера, они сливаются в один сегмент
+// следующего яруса. Поэтому стоимость добавления не растёт вместе с индексом,
+// а каждый документ переписывается O( log( N ) ) раз.
+//
+// Удаление документа замороженного сегмента - отметка (tombstone): документ
+// скрывается от запросов и исключается из IDF, а физически удаляется при
+// слиянии его сегмента. Сегмент, в котором удалена половина документов,
+// переписывается отдельно. Отметки сегмента хранятся уровнями (TombstoneLevel),
+// поэтому отметка не копирует ни набор отметок сегмента, ни счётчики слов.
+//
+// Читатели работают с неизменяемым поколением индекса: списком сегментов
+// с их отметками и опубликованной копией изменяемого сегмента. Запрос
+// обходит все сегменты с общим IDF и объединяет результаты. Писатель
+// и поток слияния публикуют новое поколение одной атомарной заменой
+// указателя; заменённые поколения освобождаются, когда их уже не может
+// читать ни один поток (EpochManager). Запросы не берут блокировок,
+// писатели и установка результата слияния упорядочены мьютексом.
+class ConcurrentSearchServer
+    {
+
+        public:
+
+            static constexpr std::size_t DEFAULT_SEGMENT_CAPACITY = 16;
+
+            static constexpr std::size_t MERGE_FACTOR = 4;
+
+            explicit ConcurrentSearchServer(
+                    const std::string & stop_words_text,
+                    const std::size_t segment_capacity = DEFAULT_SEGMENT_CAPACITY );
+
+            ConcurrentSearchServer( const ConcurrentSearchServer & ) = delete;
+
+            ConcurrentSearchServer &
+            operator=( const ConcurrentSearchServer & ) = delete;
+
+            ~ConcurrentSearchServer();
+
+            void
+            AddDocument(
+                    const int document_id,
+                    const std::string_view document,
+                    const DocumentStatus status,
+                    const std::vector< int > & ratings );
+
+            // Каждый пакет из ingest_batch_size_ записей публикуется одним поколением.
+            // При ошибке записи предшествующие ей документы уже добавлены.
+            template < typename InputIt >
+            void
+            AddDocuments(
+                    InputIt first,
+                    const InputIt last )
+                {
+                    std::vector< DocumentRecord > batch;
+
+                    for( ; first != last; ++first )
+                        {
+                            batch.push_back( *first );
+
+                            if( batch.size() == ingest_batch_size_ )
+                                {
+                                    AddDocumentBatch( batch );
+                                    batch.clear();
+                                }
+                        }
+
+                    AddDocumentBatch( batch );
+                }
+
+            void
+            RemoveDocument( const int document_id );
+
+            template < typename DocumentPredicate >
+            std::vector< Document >
+            FindTopDocuments(
+                    const std::string_view raw_query,
+                    const DocumentPredicate document_predicate,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const
+                {
+                    const EpochManager::Guard guard( epochs_ );
+
+                    const Generation & generation = *generation_.load();
+
+                    // IDF слова одинаков для всех сегментов и считается по всем сегментам,
+                    // поэтому вычисляется один раз на запрос.
+                    std::vector< std::pair< std::string_view, double > > inverse_document_freqs;
+
+                    const auto inverse_document_freq = [&generation, &inverse_document_freqs]( const std::string_view word )
+                        {
+                            for( const auto & [ known_word, known_inverse_document_freq ] : inverse_document_freqs )
+                                {
+                                    if( known_word == word )
+                                        {
+                                            return known_inverse_document_freq;
+                                        }
+                                }
+
+                            inverse_document_freqs.emplace_back( word, generation.ComputeWordInverseDocumentFreq( word ) );
+
+                            return inverse_document_freqs.back().second;
+                        };
+
+                    std::vector< Document > matched_documents = generation.mutable_segment->FindAllDocuments(
+                            raw_query,
+                            document_predicate,
+                            inverse_document_freq );
+
+                    for( const Segment & segment : generation.segments )
+                        {
+                            const std::vector< Document > segment_documents = segment.server->FindAllDocuments(
+                                    raw_query,
+                                    [&segment, &document_predicate](
+                                            const int document_id,
+                                            const DocumentStatus status,
+                                            const int rating )
+                                        {
+                                            return
+                                                    !segment.IsRemoved( document_id )
+                                                    &&
+                                                    document_predicate( document_id, status, rating );
+                                        },
+                                    inverse_document_freq );
+
+                            matched_documents.insert( matched_documents.end(), segment_documents.cbegin(), segment_documents.cend() );
+                        }
+
+                    SearchServer::SelectTopDocuments( matched_documents, max_result_count );
+
+                    return matched_documents;
+                }
+
+            std::vector< Document >
+            FindTopDocuments(
+                    const std::string_view raw_query,
+                    const DocumentStatus status = DocumentStatus::ACTUAL,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const;
+
+            // Слова возвращаются копиями: поколение, в словаре которого они лежат,
+            // может быть освобождено сразу после возврата.
+            std::tuple< std::vector< std::string >, DocumentStatus >
+            MatchDocument(
+                    const std::string_view raw_query,
+                    const int document_id ) const;
+
+            int
+            GetDocumentCount() const;
+
+            // Число замороженных сегментов в опубликованном поколении.
+            std::size_t
+            GetSegmentCount() const;
+
+            // Ждёт, пока поток слияния не выполнит все слияния, которых требует политика.
+            void
+            WaitForMerges();
+
+        private:
+
+            using RemovedDocumentFreqs = std::map< std::string, int, std::less<> >;
+
+            // Уровень отметок об удалении документов сегмента. Отметки хранятся
+            // неизменяемыми уровнями от новых к старым, как сегменты в LSM: отметка
+            // добавляет уровень из одного документа, и он сливается с более старыми,
+            // пока следующий уровень не больше чем вдвое крупнее. Уровней O( log( n ) ),
+            // каждая отметка переписывается O( log( n ) ) раз, а новый набор делит
+            // с опубликованным все уровни, кроме слитых.
+            struct TombstoneLevel
+                {
+                    // Упорядочены по возрастанию.
+                    std::vector< int > document_ids;
+
+                    // Число отмеченных документов уровня, содержащих слово.
+                    RemovedDocumentFreqs document_freqs;
+
+                    std::shared_ptr< const TombstoneLevel > older_level;
+
+                    // Число отметок этого и более старых уровней.
+                    std::size_t document_count;
+                };
+
+            // Замороженный сегмент и отметки об удалении его документов.
+            struct Segment
+                {
+                    std::shared_ptr< const SearchServer > server;
+
+                    // nullptr, если отметок нет.
+                    std::shared_ptr< const TombstoneLevel > tombstones;
+
+                    bool
+                    IsRemoved( const int document_id ) const;
+
+                    bool
+                    IsLive( const int document_id ) const;
+
+                    std::size_t
+                    GetRemovedDocumentCount() const;
+
+                    std::size_t
+                    GetLiveDocumentCount() const;
+
+                    // Число неотмеченных документов сегмента, содержащих слово.
+                    std::size_t
+                    GetLiveDocumentFreq( const std::string_view word ) const;
+
+                    // Отмеченные документы в порядке возрастания id.
+                    std::vector< int >
+                    GetRemovedIds() const;
+
+                    // Заменяет набор отметок новым, не меняя опубликованные уровни:
+                    // амортизированно O( log( n ) ) на отметку плюс слова документа.
+                    void
+                    MarkRemoved( const int document_id );
+                };
+
+            // Неизменяемое состояние индекса, которое видят читатели.
+            struct Generation
+                {
+                    std::vector< Segment > segments;
+                    std::shared_ptr< const SearchServer > mutable_segment;
+
+                    int document_count;
+
+                    // Совпадает с IDF единого сервера, содержащего те же документы.
+                    double
+                    ComputeWordInverseDocumentFreq( const std::string_view word ) const;
+                };
+
+            static constexpr std::size_t ingest_batch_size_ = 16384;
+
+            const std::string stop_words_text_;
+
+            const std::size_t segment_capacity_;
+
+            // Состояние писателя; изменяется только под write_mutex_.
+            std::mutex write_mutex_;
+
+            // Оповещает поток слияния о новых сегментах и отметках,
+            // а WaitForMerges - о завершённых слияниях.
+            std::condition_variable merge_condition_;
+
+            bool is_merging_ = false;
+
+            std::atomic< bool > is_stopping_{ false };
+
+            // Замороженные сегменты, от старых к новым.
+            std::vector< Segment > segments_;
+
+            std::unique_ptr< SearchServer > mutable_segment_;
+
+            std::shared_ptr< const SearchServer > published_mutable_segment_;
+
+            // Опубликованное поколение и поколения, ожидающие освобождения.
+            std::atomic< const Generation * > generation_{ nullptr };
+
+            mutable EpochManager epochs_;
+
+            std::vector< std::pair< std::uint64_t, std::unique_ptr< const Generation > > > retired_generations_;
+
+            // Запускается последним, когда остальное состояние уже создано.
+            std::thread merge_thread_;
+
+            void
+            AddDocumentBatch( const std::vector< DocumentRecord > & records );
+
+            // Замороженный сегмент, в котором документ жив, или segments_.size().
+            std::size_t
+            FindLiveSegment( const int document_id ) const;
+
+            void
+            ThrowIfLiveSegmentDocument( const int document_id ) const;
+
+            void
+            FreezeIfFull();
+
+            // Номера сегментов, которые политика требует слить, в порядке возрастания.
+            std::vector< std::size_t >
+            PlanMerge() const;
+
+            void
+            MergeSegments();
+
+            std::shared_ptr< const SearchServer >
+            BuildMergedSegment( const std::vector< Segment > & segments ) const;
+
+            void
+            InstallMergedSegment(
+                    const std::vector< Segment > & segments,
+                    std::shared_ptr< const SearchServer > merged_server );
+
+            void
+            Publish();
+    };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 struct Document
     {
@@ -24,6 +26,15 @@ enum class DocumentStatus
         REMOVED,
     };
 
+// Документ для пакетной загрузки в SearchServer::AddDocuments.
+struct DocumentRecord
+    {
+        int id = 0;
+        std::string text;
+        DocumentStatus status = DocumentStatus::ACTUAL;
+        std::vector< int > ratings;
+    };
+
 void
 PrintDocument( const Document & document );
 
@@ -0,0 +1,29 @@
+#include <bitset>
+
+#include "document_bitmap.h"
+
+DocumentBitmap::DocumentBitmap(
+        const std::size_t document_count,
+        std::pmr::memory_resource * const resource )
+    :
+        words_( ( document_count + WORD_BITS - 1 ) / WORD_BITS, resource )
+    {}
+
+void
+DocumentBitmap::Insert( const std::size_t ordinal )
+    {
+        words_[ ordinal / WORD_BITS ] |= std::uint64_t{ 1 } << ( ordinal % WORD_BITS );
+    }
+
+std::size_t
+DocumentBitmap::GetCount() const
+    {
+        std::size_t count = 0;
+
+        for( const std::uint64_t word : words_ )
+            {
+                count += std::bitset< WORD_BITS >( word ).count();
+            }
+
+        return count;
+    }
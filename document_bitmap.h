@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Множество документов по их номерам ( ordinal ) в DocumentStore: бит на документ,
+// проверка - одно чтение слова. Запрос собирает в него документы с минус-словами
+// до оценки, и обход постингов пропускает их, не начисляя релевантность.
+class DocumentBitmap
+    {
+
+        public:
+
+            // Пустое множество без памяти: Contains для него всегда false.
+            DocumentBitmap() = default;
+
+            explicit DocumentBitmap(
+                    const std::size_t document_count,
+                    std::pmr::memory_resource * const resource = std::pmr::get_default_resource() );
+
+            void
+            Insert( const std::size_t ordinal );
+
+            bool
+            Contains( const std::size_t ordinal ) const;
+
+            // Число документов в множестве; O( размер / 64 ).
+            std::size_t
+            GetCount() const;
+
+        private:
+
+            static constexpr std::size_t WORD_BITS = 64;
+
+            std::pmr::vector< std::uint64_t > words_;
+    };
+
+inline bool
+DocumentBitmap::Contains( const std::size_t ordinal ) const
+    {
+        const std::size_t word = ordinal / WORD_BITS;
+
+        return
+                word < words_.size()
+                &&
+                ( words_[ word ] >> ( ordinal % WORD_BITS ) & 1 ) != 0;
+    }
@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "document_store.h"
+
+DocumentStore::DocumentStore(
+        const int * ids,
+        const int * ratings,
+        const DocumentStatus * statuses,
+        const std::size_t count )
+    :
+          ids_( ids )
+        , ratings_( ratings )
+        , statuses_( statuses )
+        , size_( count )
+        , is_mapped_( true )
+    {}
+
+DocumentStore::DocumentStore( const DocumentStore & other )
+    {
+        *this = other;
+    }
+
+DocumentStore::DocumentStore( DocumentStore && other )
+    {
+        *this = std::move( other );
+    }
+
+DocumentStore &
+DocumentStore::operator=( const DocumentStore & other )
+    {
+        owned_ids_ = other.owned_ids_;
+        owned_ratings_ = other.owned_ratings_;
+        owned_statuses_ = other.owned_statuses_;
+        owned_is_removed_ = other.owned_is_removed_;
+        removed_count_ = other.removed_count_;
+        ordinal_table_ = other.ordinal_table_;
+        has_ordinal_table_ = other.has_ordinal_table_;
+        is_mapped_ = other.is_mapped_;
+
+        if( is_mapped_ )
+            {
+                ids_ = other.ids_;
+                ratings_ = other.ratings_;
+                statuses_ = other.statuses_;
+                size_ = other.size_;
+            }
+        else
+            {
+                UpdateViews();
+            }
+
+        return *this;
+    }
+
+DocumentStore &
+DocumentStore::operator=( DocumentStore && other )
+    {
+        owned_ids_ = std::exchange( other.owned_ids_, {} );
+        owned_ratings_ = std::exchange( other.owned_ratings_, {} );
+        owned_statuses_ = std::exchange( other.owned_statuses_, {} );
+        owned_is_removed_ = std::exchange( other.owned_is_removed_, {} );
+        removed_count_ = std::exchange( other.removed_count_, 0 );
+        ordinal_table_ = std::exchange( other.ordinal_table_, {} );
+        has_ordinal_table_ = std::exchange( other.has_ordinal_table_, false );
+        is_mapped_ = std::exchange( other.is_mapped_, false );
+        ids_ = std::exchange( other.ids_, nullptr );
+        ratings_ = std::exchange( other.ratings_, nullptr );
+        statuses_ = std::exchange( other.statuses_, nullptr );
+        size_ = std::exchange( other.size_, 0 );
+
+        return *this;
+    }
+
+void
+DocumentStore::Add(
+        const int document_id,
+        const int rating,
+        const DocumentStatus status )
+    {
+        ThrowIfMapped();
+
+        // Документы обычно добавляются с возрастающими id,
+        // поэтому в типичном случае метаданные дописываются в конец.
+        const auto position = std::lower_bound( owned_ids_.cbegin(), owned_ids_.cend(), document_id );
+        const auto offset = std::distance( owned_ids_.cbegin(), position );
+
+        // Удалённый, но не вычищенный документ с тем же id занимает своё место снова.
+        if(
+                position != owned_ids_.cend()
+                &&
+                *position == document_id )
+            {
+                owned_ratings_[ offset ] = rating;
+                owned_statuses_[ offset ] = status;
+                owned_is_removed_[ offset ] = false;
+                --removed_count_;
+
+                if( has_ordinal_table_ )
+                    {
+                        ordinal_table_[ document_id ] = static_cast< std::uint32_t >( offset );
+                    }
+
+                return;
+            }
+
+        owned_ids_.insert( position, document_id );
+        owned_ratings_.insert( std::next( owned_ratings_.cbegin(), offset ), rating );
+        owned_statuses_.insert( std::next( owned_statuses_.cbegin(), offset ), status );
+        owned_is_removed_.insert( std::next( owned_is_removed_.cbegin(), offset ), false );
+
+        UpdateViews();
+        UpdateOrdinalTable( offset );
+    }
+
+void
+DocumentStore::Remove( const int document_id )
+    {
+        ThrowIfMapped();
+
+        MarkRemoved( document_id );
+        CompactIfSparse();
+    }
+
+void
+DocumentStore::Remove( const std::vector< int > & document_ids )
+    {
+        ThrowIfMapped();
+
+        for( const int document_id : document_ids )
+            {
+                MarkRemoved( document_id );
+            }
+
+        CompactIfSparse();
+    }
+
+void
+DocumentStore::Compact()
+    {
+        // Хранилище снимка отмеченных документов не имеет.
+        if( removed_count_ == 0 )
+            {
+                return;
+            }
+
+        std::size_t first_removed_ordinal = size_;
+        std::size_t kept_count = 0;
+
+        for( std::size_t ordinal = 0; ordinal < owned_ids_.size(); ++ordinal )
+            {
+                if( owned_is_removed_[ ordinal ] )
+                    {
+                        first_removed_ordinal = std::min( first_removed_ordinal, ordinal );
+
+                        continue;
+                    }
+
+                owned_ids_[ kept_count ] = owned_ids_[ ordinal ];
+                owned_ratings_[ kept_count ] = owned_ratings_[ ordinal ];
+                owned_statuses_[ kept_count ] = owned_statuses_[ ordinal ];
+                ++kept_count;
+            }
+
+        owned_ids_.resize( kept_count );
+        owned_ratings_.resize( kept_count );
+        owned_statuses_.resize( kept_count );
+        owned_is_removed_.assign( kept_count, false );
+        removed_count_ = 0;
+
+        UpdateViews();
+        UpdateOrdinalTable( first_removed_ordinal );
+    }
+
+bool
+DocumentStore::Contains( const int document_id ) const
+    {
+        return FindOrdinal( document_id ) != NO_ORDINAL;
+    }
+
+std::size_t
+DocumentStore::FindOrdinal( const int document_id ) const
+    {
+        if( has_ordinal_table_ )
+            {
+                if(
+                        document_id < 0
+                        ||
+                        static_cast< std::size_t >( document_id ) >= ordinal_table_.size() )
+                    {
+                        return NO_ORDINAL;
+                    }
+
+                const std::uint32_t ordinal = ordinal_table_[ document_id ];
+
+                return ordinal == NO_TABLE_ORDINAL ? NO_ORDINAL : ordinal;
+            }
+
+        const int * const position = std::lower_bound( ids_, ids_ + size_, document_id );
+
+        if(
+                position == ids_ + size_
+                ||
+                *position != document_id
+                ||
+                IsRemoved( position - ids_ ) )
+            {
+                return NO_ORDINAL;
+            }
+
+        return position - ids_;
+    }
+
+std::size_t
+DocumentStore::GetOrdinalCount() const
+    {
+        return size_;
+    }
+
+int
+DocumentStore::GetNthId( const std::size_t index ) const
+    {
+        if( removed_count_ == 0 )
+            {
+                return ids_[ index ];
+            }
+
+        return *std::next( begin(), index );
+    }
+
+int
+DocumentStore::GetId( const std::size_t ordinal ) const
+    {
+        return ids_[ ordinal ];
+    }
+
+int
+DocumentStore::GetRating( const std::size_t ordinal ) const
+    {
+        return ratings_[ ordinal ];
+    }
+
+DocumentStatus
+DocumentStore::GetStatus( const std::size_t ordinal ) const
+    {
+        return statuses_[ ordinal ];
+    }
+
+const int *
+DocumentStore::GetIds() const
+    {
+        return ids_;
+    }
+
+const int *
+DocumentStore::GetRatings() const
+    {
+        return ratings_;
+    }
+
+const DocumentStatus *
+DocumentStore::GetStatuses() const
+    {
+        return statuses_;
+    }
+
+std::size_t
+DocumentStore::size() const
+    {
+        return size_ - removed_count_;
+    }
+
+DocumentStore::Iterator
+DocumentStore::begin() const
+    {
+        return Iterator( this, 0 );
+    }
+
+DocumentStore::Iterator
+DocumentStore::end() const
+    {
+        return Iterator( this, size_ );
+    }
+
+void
+DocumentStore::ThrowIfMapped() const
+    {
+        if( is_mapped_ )
+            {
+                throw std::logic_error( "Хранилище документов, загруженное из снимка, доступно только для чтения." );
+            }
+    }
+
+void
+DocumentStore::MarkRemoved( const int document_id )
+    {
+        const std::size_t ordinal = FindOrdinal( document_id );
+
+        if( ordinal == NO_ORDINAL )
+            {
+                return;
+            }
+
+        owned_is_removed_[ ordinal ] = true;
+        ++removed_count_;
+
+        if( has_ordinal_table_ )
+            {
+                ordinal_table_[ document_id ] = NO_TABLE_ORDINAL;
+            }
+    }
+
+void
+DocumentStore::CompactIfSparse()
+    {
+        // Уплотнение стоит O( число документов ) и выполняется не чаще, чем раз
+        // на size_ / 2 удалений.
+        if( 2 * removed_count_ > size_ )
+            {
+                Compact();
+            }
+    }
+
+void
+DocumentStore::UpdateViews()
+    {
+        ids_ = owned_ids_.data();
+        ratings_ = owned_ratings_.data();
+        statuses_ = owned_statuses_.data();
+        size_ = owned_ids_.size();
+    }
+
+void
+DocumentStore::UpdateOrdinalTable( const std::size_t first_changed_ordinal )
+    {
+        const bool fits_table =
+                size_ == 0
+                ||
+                (
+                    ids_[ 0 ] >= 0
+                    &&
+                    static_cast< std::size_t >( ids_[ size_ - 1 ] ) < std::max( 2 * size_, MIN_ORDINAL_TABLE_SIZE )
+                    &&
+                    size_ < NO_TABLE_ORDINAL );
+
+        if( !fits_table )
+            {
+                ordinal_table_.clear();
+                ordinal_table_.shrink_to_fit();
+                has_ordinal_table_ = false;
+
+                return;
+            }
+
+        // Таблица, которой не было, заполняется целиком.
+        const std::size_t first_ordinal = has_ordinal_table_ ? first_changed_ordinal : 0;
+
+        has_ordinal_table_ = true;
+
+        if( size_ > 0 )
+            {
+                const std::size_t last_id = static_cast< std::size_t >( ids_[ size_ - 1 ] );
+
+                if( last_id >= ordinal_table_.size() )
+                    {
+                        ordinal_table_.resize( last_id + 1, NO_TABLE_ORDINAL );
+                    }
+            }
+
+        for( std::size_t ordinal = first_ordinal; ordinal < size_; ++ordinal )
+            {
+                ordinal_table_[ ids_[ ordinal ] ] = IsRemoved( ordinal ) ? NO_TABLE_ORDINAL : static_cast< std::uint32_t >( ordinal );
+            }
+    }
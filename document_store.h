@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "document.h"
+
+// Метаданные документов: id, рейтинги и статусы в отдельных массивах,
+// упорядоченных по возрастанию id. Номер документа в этом порядке - его ordinal.
+//
+// Удалённый документ только отмечается, и его номер перестаёт находиться; массивы
+// уплотняются, когда отмеченных становится больше половины, поэтому удаление
+// стоит O( 1 ) в среднем. Номера документов меньше GetOrdinalCount(), но
+// до уплотнения среди них есть номера удалённых документов.
+//
+// Хранилище либо владеет массивами, либо ссылается на массивы снимка индекса;
+// во втором случае оно доступно только для чтения.
+//
+// Если id собственных документов неотрицательны и не больше чем вдвое
+// превосходят их число, FindOrdinal читает номер из таблицы, индексированной id,
+// за O( 1 ); иначе, как и для снимка, номер ищется двоичным поиском.
+class DocumentStore
+    {
+
+        public:
+
+            static constexpr std::size_t NO_ORDINAL = static_cast< std::size_t >( -1 );
+
+            class Iterator;
+
+            DocumentStore() = default;
+
+            DocumentStore(
+                    const int * ids,
+                    const int * ratings,
+                    const DocumentStatus * statuses,
+                    const std::size_t count );
+
+            DocumentStore( const DocumentStore & other );
+
+            // Массивы хранятся в векторах, буфер которых при перемещении не меняется,
+            // поэтому указатели остаются действительными. Источник становится
+            // пустым собственным хранилищем.
+            DocumentStore( DocumentStore && other );
+
+            DocumentStore &
+            operator=( const DocumentStore & other );
+
+            DocumentStore &
+            operator=( DocumentStore && other );
+
+            void
+            Add(
+                    const int document_id,
+                    const int rating,
+                    const DocumentStatus status );
+
+            // Отмечает документ удалённым; отсутствующий id пропускается.
+            void
+            Remove( const int document_id );
+
+            // Удаляет документы с id из document_ids; отсутствующие id пропускаются.
+            void
+            Remove( const std::vector< int > & document_ids );
+
+            // Вычищает отмеченные документы из массивов; номера документов меняются.
+            void
+            Compact();
+
+            bool
+            Contains( const int document_id ) const;
+
+            std::size_t
+            FindOrdinal( const int document_id ) const;
+
+            // Граница номеров документов, включая ещё не вычищенные удалённые.
+            std::size_t
+            GetOrdinalCount() const;
+
+            // id документа, index-го по возрастанию id среди неудалённых:
+            // O( 1 ), если отмеченных документов нет, иначе O( index ).
+            int
+            GetNthId( const std::size_t index ) const;
+
+            int
+            GetId( const std::size_t ordinal ) const;
+
+            int
+            GetRating( const std::size_t ordinal ) const;
+
+            DocumentStatus
+            GetStatus( const std::size_t ordinal ) const;
+
+            // Массивы по номерам документов, до Compact() - вместе с удалёнными.
+            const int *
+            GetIds() const;
+
+            const int *
+            GetRatings() const;
+
+            const DocumentStatus *
+            GetStatuses() const;
+
+            // Число неудалённых документов.
+            std::size_t
+            size() const;
+
+            Iterator
+            begin() const;
+
+            Iterator
+            end() const;
+
+        private:
+
+            std::vector< int > owned_ids_;
+
+            std::vector< int > owned_ratings_;
+
+            std::vector< DocumentStatus > owned_statuses_;
+
+            // Указывают либо на owned-массивы, либо в отображённый снимок.
+            const int * ids_ = nullptr;
+
+            const int * ratings_ = nullptr;
+
+            const DocumentStatus * statuses_ = nullptr;
+
+            std::size_t size_ = 0;
+
+            bool is_mapped_ = false;
+
+            // owned_is_removed_[ ordinal ] - документ удалён, но ещё не вычищен.
+            std::vector< bool > owned_is_removed_;
+
+            std::size_t removed_count_ = 0;
+
+            static constexpr std::uint32_t NO_TABLE_ORDINAL = std::numeric_limits< std::uint32_t >::max();
+
+            // Небольшие корпуса с разреженными id тоже получают таблицу.
+            static constexpr std::size_t MIN_ORDINAL_TABLE_SIZE = 1024;
+
+            // ordinal_table_[ id ] - номер документа id или NO_TABLE_ORDINAL.
+            // Используется, только если has_ordinal_table_: тогда таблица покрывает все id.
+            std::vector< std::uint32_t > ordinal_table_;
+
+            bool has_ordinal_table_ = false;
+
+            bool
+            IsRemoved( const std::size_t ordinal ) const;
+
+            void
+            ThrowIfMapped() const;
+
+            // Отмечает документ удалённым, не уплотняя массивы.
+            void
+            MarkRemoved( const int document_id );
+
+            // Уплотняет массивы, если отмеченных документов больше половины.
+            void
+            CompactIfSparse();
+
+            // Обновляет таблицу после вставки или удаления документа
+            // с номером first_changed_ordinal: номера следующих документов сдвинулись.
+            void
+            UpdateOrdinalTable( const std::size_t first_changed_ordinal );
+
+            void
+            UpdateViews();
+    };
+
+// Обходит id неудалённых документов по возрастанию.
+class DocumentStore::Iterator
+    {
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = int;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const int *;
+            using reference = const int &;
+
+            Iterator() = default;
+
+            reference
+            operator*() const;
+
+            Iterator &
+            operator++();
+
+            Iterator
+            operator++( int );
+
+            bool
+            operator==( const Iterator & other ) const;
+
+            bool
+            operator!=( const Iterator & other ) const;
+
+        private:
+
+            friend class DocumentStore;
+
+            const DocumentStore * store_ = nullptr;
+
+            std::size_t ordinal_ = 0;
+
+            Iterator(
+                    const DocumentStore * store,
+                    const std::size_t ordinal );
+
+            void
+            SkipRemoved();
+    };
+
+inline bool
+DocumentStore::IsRemoved( const std::size_t ordinal ) const
+    {
+        return
+                removed_count_ != 0
+                &&
+                owned_is_removed_[ ordinal ];
+    }
+
+inline
+DocumentStore::Iterator::Iterator(
+        const DocumentStore * store,
+        const std::size_t ordinal )
+    :
+          store_( store )
+        , ordinal_( ordinal )
+    {
+        SkipRemoved();
+    }
+
+inline DocumentStore::Iterator::reference
+DocumentStore::Iterator::operator*() const
+    {
+        return store_->ids_[ ordinal_ ];
+    }
+
+inline DocumentStore::Iterator &
+DocumentStore::Iterator::operator++()
+    {
+        ++ordinal_;
+
+        SkipRemoved();
+
+        return *this;
+    }
+
+inline DocumentStore::Iterator
+DocumentStore::Iterator::operator++( int )
+    {
+        Iterator previous = *this;
+
+        ++*this;
+
+        return previous;
+    }
+
+inline bool
+DocumentStore::Iterator::operator==( const Iterator & other ) const
+    {
+        return ordinal_ == other.ordinal_;
+    }
+
+inline bool
+DocumentStore::Iterator::operator!=( const Iterator & other ) const
+    {
+        return !( *this == other );
+    }
+
+inline void
+DocumentStore::Iterator::SkipRemoved()
+    {
+        while(
+                ordinal_ < store_->size_
+                &&
+                store_->IsRemoved( ordinal_ ) )
+            {
+                ++ordinal_;
+            }
+    }
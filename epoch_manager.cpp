@@ -0,0 +1,66 @@
+#include <functional>
+#include <thread>
+
+#include "epoch_manager.h"
+
+EpochManager::Guard::Guard( EpochManager & epochs )
+    :
+        slot_( &epochs.AcquireSlot() )
+    {}
+
+EpochManager::Guard::~Guard()
+    {
+        slot_->epoch.store( INACTIVE );
+    }
+
+std::uint64_t
+EpochManager::Advance()
+    {
+        return global_epoch_.fetch_add( 1 );
+    }
+
+bool
+EpochManager::IsQuiescent( const std::uint64_t retire_epoch ) const
+    {
+        for( const Slot & slot : slots_ )
+            {
+                const std::uint64_t epoch = slot.epoch.load();
+
+                if(
+                        epoch != INACTIVE
+                        &&
+                        epoch <= retire_epoch )
+                    {
+                        return false;
+                    }
+            }
+
+        return true;
+    }
+
+EpochManager::Slot &
+EpochManager::AcquireSlot()
+    {
+        // Поток начинает поиск свободного слота с «своего» места,
+        // поэтому разные потоки обычно сразу занимают разные слоты.
+        thread_local const std::size_t first_slot = std::hash< std::thread::id >{}( std::this_thread::get_id() );
+
+        for( std::size_t attempt = 0; ; ++attempt )
+            {
+                Slot & slot = slots_[ ( first_slot + attempt ) % SLOT_COUNT ];
+
+                std::uint64_t expected = INACTIVE;
+
+                // Эпоха читается до захвата слота: если писатель успел её увеличить,
+                // слот получит устаревшую эпоху, что лишь задержит освобождение.
+                if( slot.epoch.compare_exchange_strong( expected, global_epoch_.load() ) )
+                    {
+                        return slot;
+                    }
+
+                if( attempt % SLOT_COUNT == SLOT_COUNT - 1 )
+                    {
+                        std::this_thread::yield();
+                    }
+            }
+    }
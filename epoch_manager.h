@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Эпохи для безопасного освобождения данных, которые читаются без блокировок.
+//
+// Читатель на время чтения занимает слот и объявляет в нём текущую эпоху (Guard).
+// Писатель, заменив опубликованный объект, вызывает Advance и запоминает
+// возвращённую эпоху; старый объект можно удалить, когда IsQuiescent( эпоха )
+// вернёт true - ни один читатель, который мог его видеть, уже не читает.
+// Все операции - атомарные без мьютексов; писатель никогда не ждёт читателей.
+class EpochManager
+    {
+
+        private:
+
+            // Слоты выровнены по кэш-линии, чтобы читатели не мешали друг другу.
+            struct alignas( 64 ) Slot
+                {
+                    std::atomic< std::uint64_t > epoch{ INACTIVE };
+                };
+
+        public:
+
+            static constexpr std::size_t SLOT_COUNT = 128;
+
+            class Guard
+                {
+
+                    public:
+
+                        explicit Guard( EpochManager & epochs );
+
+                        Guard( const Guard & ) = delete;
+
+                        Guard &
+                        operator=( const Guard & ) = delete;
+
+                        ~Guard();
+
+                    private:
+
+                        Slot * slot_;
+                };
+
+            EpochManager() = default;
+
+            EpochManager( const EpochManager & ) = delete;
+
+            EpochManager &
+            operator=( const EpochManager & ) = delete;
+
+            // Вызывается после замены опубликованного объекта;
+            // возвращает эпоху, которой помечается заменённый объект.
+            std::uint64_t
+            Advance();
+
+            bool
+            IsQuiescent( const std::uint64_t retire_epoch ) const;
+
+        private:
+
+            static constexpr std::uint64_t INACTIVE = 0;
+
+            std::atomic< std::uint64_t > global_epoch_{ 1 };
+
+            Slot slots_[ SLOT_COUNT ];
+
+            Slot &
+            AcquireSlot();
+    };
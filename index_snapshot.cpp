@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "index_snapshot.h"
+
+namespace
+    {
+        constexpr std::uint64_t section_alignment = 8;
+
+        void
+        ThrowCorruptedSnapshot( const std::string & reason )
+            {
+                using namespace std::string_literals;
+
+                throw std::runtime_error( "Повреждённый снимок индекса: "s + reason );
+            }
+    }
+
+IndexSnapshotWriter::IndexSnapshotWriter( const std::string & path )
+    :
+          path_( path )
+        , temporary_path_( path + ".tmp" )
+        , out_( temporary_path_, std::ios::binary | std::ios::trunc )
+    {
+        if( !out_ )
+            {
+                using namespace std::string_literals;
+
+                throw std::runtime_error( "Не удалось создать файл "s + temporary_path_ + "."s );
+            }
+
+        // Место под заголовок; он записывается в Finish, когда известны все секции.
+        const std::uint64_t header_size = sizeof( SnapshotHeader );
+        const std::string placeholder( header_size, '\0' );
+
+        WriteBytes( placeholder.data(), placeholder.size() );
+    }
+
+IndexSnapshotWriter::~IndexSnapshotWriter()
+    {
+        // Недописанный снимок удаляется: Finish не вызывался или завершился ошибкой.
+        if( !is_finished_ )
+            {
+                out_.close();
+                std::remove( temporary_path_.c_str() );
+            }
+    }
+
+void
+IndexSnapshotWriter::BeginSection( const SnapshotSection section )
+    {
+        const std::uint64_t padding = ( section_alignment - position_ % section_alignment ) % section_alignment;
+        const char zeros[ section_alignment ] = {};
+
+        WriteBytes( zeros, padding );
+
+        current_section_ = section;
+        header_.sections[ static_cast< std::size_t >( section ) ] = { position_, 0 };
+    }
+
+void
+IndexSnapshotWriter::EndSection()
+    {
+        SnapshotHeader::Section & section = header_.sections[ static_cast< std::size_t >( current_section_ ) ];
+
+        section.size = position_ - section.offset;
+
+        current_section_ = SnapshotSection::COUNT;
+    }
+
+void
+IndexSnapshotWriter::Finish( const SnapshotCounts & counts )
+    {
+        std::memcpy( header_.magic, SnapshotHeader::MAGIC, sizeof( header_.magic ) );
+        header_.version = SnapshotHeader::VERSION;
+        header_.byte_order_mark = SnapshotHeader::BYTE_ORDER_MARK;
+        header_.file_size = position_;
+        header_.counts = counts;
+
+        out_.seekp( 0 );
+        out_.write( reinterpret_cast< const char * >( &header_ ), sizeof( header_ ) );
+        out_.close();
+
+        if( !out_ )
+            {
+                throw std::runtime_error( "Ошибка записи снимка индекса." );
+            }
+
+        if( std::rename( temporary_path_.c_str(), path_.c_str() ) != 0 )
+            {
+                std::remove( temporary_path_.c_str() );
+
+                using namespace std::string_literals;
+
+                throw std::runtime_error( "Не удалось переименовать снимок индекса в "s + path_ + "."s );
+            }
+
+        is_finished_ = true;
+    }
+
+void
+IndexSnapshotWriter::WriteBytes(
+        const char * data,
+        const std::size_t size )
+    {
+        out_.write( data, size );
+
+        if( !out_ )
+            {
+                throw std::runtime_error( "Ошибка записи снимка индекса." );
+            }
+
+        position_ += size;
+    }
+
+IndexSnapshot::IndexSnapshot( const std::string & path )
+    :
+        file_( path )
+    {
+        if( file_.size() < sizeof( SnapshotHeader ) )
+            {
+                ThrowCorruptedSnapshot( "файл короче заголовка." );
+            }
+
+        header_ = reinterpret_cast< const SnapshotHeader * >( file_.data() );
+
+        if( std::memcmp( header_->magic, SnapshotHeader::MAGIC, sizeof( header_->magic ) ) != 0 )
+            {
+                ThrowCorruptedSnapshot( "неизвестный формат файла." );
+            }
+
+        if( header_->version != SnapshotHeader::VERSION )
+            {
+                ThrowCorruptedSnapshot( "неподдерживаемая версия формата." );
+            }
+
+        if( header_->byte_order_mark != SnapshotHeader::BYTE_ORDER_MARK )
+            {
+                ThrowCorruptedSnapshot( "снимок записан на платформе с другим порядком байтов." );
+            }
+
+        if( header_->file_size != file_.size() )
+            {
+                ThrowCorruptedSnapshot( "размер файла не совпадает с записанным." );
+            }
+
+        // Последние смещения задают размеры секций слов и постингов; остальные
+        // смещения проверяются на возрастание, чтобы слова и списки постингов
+        // не выходили за свои секции. Проверка читает только массивы смещений.
+        const SnapshotCounts & counts = header_->counts;
+
+        const std::uint64_t * word_offsets = GetSection< std::uint64_t >(
+                SnapshotSection::WORD_OFFSETS,
+                counts.term_count + 1 );
+
+        const std::uint64_t * posting_offsets = GetSection< std::uint64_t >(
+                SnapshotSection::POSTING_OFFSETS,
+                counts.term_count + 1 );
+
+        if(
+                word_offsets[ 0 ] != 0
+                ||
+                posting_offsets[ 0 ] != 0 )
+            {
+                ThrowCorruptedSnapshot( "смещения слов или постингов начинаются не с нуля." );
+            }
+
+        for( std::uint64_t term = 0; term < counts.term_count; ++term )
+            {
+                if(
+                        word_offsets[ term + 1 ] < word_offsets[ term ]
+                        ||
+                        posting_offsets[ term + 1 ] < posting_offsets[ term ] )
+                    {
+                        ThrowCorruptedSnapshot( "смещения слов или постингов убывают." );
+                    }
+            }
+
+        GetSection< char >( SnapshotSection::WORD_CHARS, word_offsets[ counts.term_count ] );
+
+        if(
+                counts.stop_term_count > counts.term_count
+                ||
+                posting_offsets[ counts.term_count ] != counts.posting_count )
+            {
+                ThrowCorruptedSnapshot( "неверные количества слов или постингов." );
+            }
+
+        // Поиск по снимку полагается на то, что id документов и постингов каждого
+        // слова возрастают, а постинги ссылаются на документы таблицы. Проверка
+        // читает все постинги: O( постингов * log( документов ) ).
+        const int * document_ids = GetSection< int >( SnapshotSection::DOCUMENT_IDS, counts.document_count );
+
+        for( std::uint64_t i = 0; i < counts.document_count; ++i )
+            {
+                if(
+                        document_ids[ i ] < 0
+                        ||
+                        ( i > 0 && document_ids[ i ] <= document_ids[ i - 1 ] ) )
+                    {
+                        ThrowCorruptedSnapshot( "id документов отрицательны или не возрастают." );
+                    }
+            }
+
+        const int * posting_document_ids = GetSection< int >( SnapshotSection::POSTING_DOCUMENT_IDS, counts.posting_count );
+
+        for( std::uint64_t term = 0; term < counts.term_count; ++term )
+            {
+                for( std::uint64_t i = posting_offsets[ term ]; i < posting_offsets[ term + 1 ]; ++i )
+                    {
+                        if( i > posting_offsets[ term ] && posting_document_ids[ i ] <= posting_document_ids[ i - 1 ] )
+                            {
+                                ThrowCorruptedSnapshot( "id документов в постингах слова не возрастают." );
+                            }
+
+                        if( !std::binary_search( document_ids, document_ids + counts.document_count, posting_document_ids[ i ] ) )
+                            {
+                                ThrowCorruptedSnapshot( "постинг ссылается на отсутствующий документ." );
+                            }
+                    }
+            }
+    }
+
+const SnapshotCounts &
+IndexSnapshot::GetCounts() const
+    {
+        return header_->counts;
+    }
+
+const char *
+IndexSnapshot::GetSectionData(
+        const SnapshotSection section,
+        const std::uint64_t size,
+        const std::size_t alignment ) const
+    {
+        const SnapshotHeader::Section & bounds = header_->sections[ static_cast< std::size_t >( section ) ];
+
+        if(
+                bounds.size != size
+                ||
+                bounds.offset > file_.size()
+                ||
+                bounds.size > file_.size() - bounds.offset
+                ||
+                bounds.offset % alignment != 0 )
+            {
+                ThrowCorruptedSnapshot( "неверные границы секции." );
+            }
+
+        return file_.data() + bounds.offset;
+    }
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "mapped_file.h"
+
+// Бинарный снимок индекса. Все секции выровнены по 8 байтам и хранятся
+// в том виде, в котором используются при поиске, поэтому после отображения
+// файла в память запросы выполняются прямо по его страницам.
+//
+// Слова упорядочены: сначала стоп-слова, затем слова с постингами,
+// каждая группа по алфавиту; id слова равен его номеру в этом порядке.
+enum class SnapshotSection : std::uint32_t
+    {
+        WORD_OFFSETS,           // std::uint64_t[ term_count + 1 ]
+        WORD_CHARS,             // char[]
+        POSTING_OFFSETS,        // std::uint64_t[ term_count + 1 ]
+        POSTING_DOCUMENT_IDS,   // int[ posting_count ]
+        POSTING_TERM_FREQS,     // double[ posting_count ]
+        DOCUMENT_IDS,           // int[ document_count ], по возрастанию
+        DOCUMENT_RATINGS,       // int[ document_count ]
+        DOCUMENT_STATUSES,      // DocumentStatus[ document_count ]
+        COUNT,
+    };
+
+struct SnapshotCounts
+    {
+        std::uint64_t term_count = 0;
+        std::uint64_t stop_term_count = 0;
+        std::uint64_t posting_count = 0;
+        std::uint64_t document_count = 0;
+    };
+
+struct SnapshotHeader
+    {
+        struct Section
+            {
+                std::uint64_t offset;
+                std::uint64_t size;
+            };
+
+        static constexpr char MAGIC[ 8 ] = { 'S', 'R', 'C', 'H', 'I', 'D', 'X', '\0' };
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        char magic[ 8 ];
+        std::uint32_t version;
+        std::uint32_t byte_order_mark;
+        std::uint64_t file_size;
+        SnapshotCounts counts;
+        Section sections[ static_cast< std::size_t >( SnapshotSection::COUNT ) ];
+    };
+
+// Последовательно записывает секции снимка; заголовок дописывается в Finish.
+// Запись идёт во временный файл, который в Finish атомарно переименовывается в path,
+// поэтому читатели никогда не видят недописанный снимок. Если Finish не вызван
+// или завершился ошибкой, временный файл удаляется в деструкторе.
+class IndexSnapshotWriter
+    {
+
+        public:
+
+            explicit IndexSnapshotWriter( const std::string & path );
+
+            IndexSnapshotWriter( const IndexSnapshotWriter & ) = delete;
+
+            IndexSnapshotWriter &
+            operator=( const IndexSnapshotWriter & ) = delete;
+
+            ~IndexSnapshotWriter();
+
+            void
+            BeginSection( const SnapshotSection section );
+
+            template < typename T >
+            void
+            Write(
+                    const T * data,
+                    const std::size_t count )
+                {
+                    WriteBytes( reinterpret_cast< const char * >( data ), count * sizeof( T ) );
+                }
+
+            void
+            EndSection();
+
+            void
+            Finish( const SnapshotCounts & counts );
+
+        private:
+
+            const std::string path_;
+
+            const std::string temporary_path_;
+
+            std::ofstream out_;
+
+            SnapshotHeader header_{};
+
+            SnapshotSection current_section_ = SnapshotSection::COUNT;
+
+            std::uint64_t position_ = 0;
+
+            bool is_finished_ = false;
+
+            void
+            WriteBytes(
+                    const char * data,
+                    const std::size_t size );
+    };
+
+// Снимок, отображённый в память. Проверяет при открытии заголовок, границы секций
+// и порядок id документов и постингов.
+class IndexSnapshot
+    {
+
+        public:
+
+            explicit IndexSnapshot( const std::string & path );
+
+            const SnapshotCounts &
+            GetCounts() const;
+
+            template < typename T >
+            const T *
+            GetSection(
+                    const SnapshotSection section,
+                    const std::uint64_t count ) const
+                {
+                    return reinterpret_cast< const T * >( GetSectionData( section, count * sizeof( T ), alignof( T ) ) );
+                }
+
+        private:
+
+            MappedFile file_;
+
+            const SnapshotHeader * header_ = nullptr;
+
+            const char *
+            GetSectionData(
+                    const SnapshotSection section,
+                    const std::uint64_t size,
+                    const std::size_t alignment ) const;
+    };
@@ -0,0 +1,21 @@
+#include "inverse_document_freq_cache.h"
+
+InverseDocumentFreqCache::InverseDocumentFreqCache( const InverseDocumentFreqCache & other )
+    :
+        entries_( other.entries_.size() )
+    {}
+
+void
+InverseDocumentFreqCache::Resize( const std::size_t term_count )
+    {
+        if( term_count > entries_.size() )
+            {
+                entries_.resize( term_count );
+            }
+    }
+
+InverseDocumentFreqCache::Entry::Entry( const Entry & other )
+    :
+          generation( other.generation.load( std::memory_order_relaxed ) )
+        , inverse_document_freq( other.inverse_document_freq.load( std::memory_order_relaxed ) )
+    {}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "term_dictionary.h"
+
+// IDF слов, вычисленные при первом запросе с ними и действительные,
+// пока не изменится поколение индекса.
+//
+// Значение слова помечено поколением, для которого оно вычислено, поэтому
+// изменение индекса делает недействительными все значения за O( 1 ), без
+// обхода словаря. Запросы выполняются параллельно и заполняют кэш сами:
+// потоки, одновременно вычисляющие IDF одного слова, записывают одно и то же
+// значение, а отметка поколения публикуется после него.
+class InverseDocumentFreqCache
+    {
+
+        public:
+
+            InverseDocumentFreqCache() = default;
+
+            // Значения копии относились бы к поколениям другого сервера.
+            InverseDocumentFreqCache( const InverseDocumentFreqCache & other );
+
+            InverseDocumentFreqCache( InverseDocumentFreqCache && other ) = default;
+
+            InverseDocumentFreqCache &
+            operator=( const InverseDocumentFreqCache & ) = delete;
+
+            // Вызывается при изменении индекса, когда запросы не выполняются.
+            void
+            Resize( const std::size_t term_count );
+
+            // compute() вычисляет IDF слова, если значения для generation ещё нет.
+            template < typename Compute >
+            double
+            Get(
+                    const TermId term,
+                    const std::uint64_t generation,
+                    const Compute & compute ) const
+                {
+                    if( term >= entries_.size() )
+                        {
+                            return compute();
+                        }
+
+                    Entry & entry = entries_[ term ];
+
+                    if( entry.generation.load( std::memory_order_acquire ) == generation )
+                        {
+                            return entry.inverse_document_freq.load( std::memory_order_relaxed );
+                        }
+
+                    const double inverse_document_freq = compute();
+
+                    entry.inverse_document_freq.store( inverse_document_freq, std::memory_order_relaxed );
+                    entry.generation.store( generation, std::memory_order_release );
+
+                    return inverse_document_freq;
+                }
+
+        private:
+
+            static constexpr std::uint64_t NO_GENERATION = std::numeric_limits< std::uint64_t >::max();
+
+            struct Entry
+                {
+                    std::atomic< std::uint64_t > generation{ NO_GENERATION };
+                    std::atomic< double > inverse_document_freq{ 0.0 };
+
+                    Entry() = default;
+
+                    // Нужен std::vector при росте словаря; перенесённое значение
+                    // остаётся действительным для своего поколения.
+                    Entry( const Entry & other );
+                };
+
+            mutable std::vector< Entry > entries_;
+    };
@@ -0,0 +1,514 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "inverted_index.h"
+
+InvertedIndex::InvertedIndex( const PostingsFormat format )
+    :
+        format_( format )
+    {}
+
+InvertedIndex::InvertedIndex(
+        const std::uint64_t * posting_offsets,
+        const int * document_ids,
+        const double * term_freqs,
+        const std::size_t term_count )
+    :
+          format_( PostingsFormat::PLAIN )
+        , mapped_posting_offsets_( posting_offsets )
+        , mapped_document_ids_( document_ids )
+        , mapped_term_freqs_( term_freqs )
+        , mapped_term_count_( term_count )
+    {}
+
+InvertedIndex::InvertedIndex( InvertedIndex && other )
+    :
+          format_( other.format_ )
+        , plain_postings_( std::exchange( other.plain_postings_, {} ) )
+        , compressed_postings_( std::exchange( other.compressed_postings_, {} ) )
+        , term_freq_values_( std::exchange( other.term_freq_values_, {} ) )
+        , term_freq_codes_( std::exchange( other.term_freq_codes_, {} ) )
+        , max_term_freqs_( std::exchange( other.max_term_freqs_, {} ) )
+        , mapped_posting_offsets_( std::exchange( other.mapped_posting_offsets_, nullptr ) )
+        , mapped_document_ids_( std::exchange( other.mapped_document_ids_, nullptr ) )
+        , mapped_term_freqs_( std::exchange( other.mapped_term_freqs_, nullptr ) )
+        , mapped_term_count_( std::exchange( other.mapped_term_count_, 0 ) )
+    {}
+
+InvertedIndex::TermFreqs
+InvertedIndex::ComputeTermFreqs( std::vector< TermId > document_terms )
+    {
+        const double inv_word_count = 1.0 / document_terms.size();
+
+        std::sort( document_terms.begin(), document_terms.end() );
+
+        TermFreqs term_freqs;
+
+        for( const TermId term : document_terms )
+            {
+                if(
+                        term_freqs.empty()
+                        ||
+                        term_freqs.back().first != term )
+                    {
+                        term_freqs.emplace_back( term, 0.0 );
+                    }
+
+                term_freqs.back().second += inv_word_count;
+            }
+
+        return term_freqs;
+    }
+
+void
+InvertedIndex::AddDocument(
+        const int document_id,
+        const TermFreqs & term_freqs )
+    {
+        ThrowIfMapped();
+
+        for( const auto & [ term, term_freq ] : term_freqs )
+            {
+                if( term >= max_term_freqs_.size() )
+                    {
+                        max_term_freqs_.resize( term + 1 );
+                    }
+
+                UpdateMaxTermFreq( term, term_freq );
+
+                if( format_ == PostingsFormat::PLAIN )
+                    {
+                        if( term >= plain_postings_.size() )
+                            {
+                                plain_postings_.resize( term + 1 );
+                            }
+
+                        InsertPosting( plain_postings_[ term ], document_id, term_freq );
+                    }
+                else
+                    {
+                        if( term >= compressed_postings_.size() )
+                            {
+                                compressed_postings_.resize( term + 1 );
+                            }
+
+                        compressed_postings_[ term ].Insert( document_id, GetTermFreqCode( term_freq ) );
+                    }
+            }
+    }
+
+void
+InvertedIndex::RemoveDocument(
+        const int document_id,
+        const TermFreqs & term_freqs )
+    {
+        RemoveDocument( std::execution::seq, document_id, term_freqs );
+    }
+
+void
+InvertedIndex::RemoveDocuments( const TermDocuments & term_documents )
+    {
+        ThrowIfMapped();
+
+        for( const auto & [ term, document_ids ] : term_documents )
+            {
+                if( format_ == PostingsFormat::PLAIN )
+                    {
+                        PostingList & postings = plain_postings_[ term ];
+
+                        for( const int document_id : document_ids )
+                            {
+                                ErasePosting( postings, document_id );
+                            }
+
+                        CompactIfSparse( postings );
+                    }
+                else
+                    {
+                        compressed_postings_[ term ].Erase( document_ids );
+                    }
+            }
+    }
+
+std::size_t
+InvertedIndex::GetDocumentFreq( const TermId term ) const
+    {
+        if( format_ == PostingsFormat::PLAIN )
+            {
+                const PostingsView postings = GetPlainPostings( term );
+
+                return postings.size - postings.removed_count;
+            }
+
+        return
+                term < compressed_postings_.size()
+                ?
+                compressed_postings_[ term ].size()
+                :
+                0;
+    }
+
+bool
+InvertedIndex::ContainsDocument(
+        const TermId term,
+        const int document_id ) const
+    {
+        if( format_ == PostingsFormat::PLAIN )
+            {
+                const PostingsView postings = GetPlainPostings( term );
+
+                const int * const position = std::lower_bound(
+                        postings.document_ids,
+                        postings.document_ids + postings.size,
+                        document_id );
+
+                return
+                        position != postings.document_ids + postings.size
+                        &&
+                        *position == document_id
+                        &&
+                        postings.term_freqs[ position - postings.document_ids ] != REMOVED_TERM_FREQ;
+            }
+
+        return
+                term < compressed_postings_.size()
+                &&
+                compressed_postings_[ term ].Contains( document_id );
+    }
+
+double
+InvertedIndex::GetMaxTermFreq( const TermId term ) const
+    {
+        if( mapped_posting_offsets_ != nullptr )
+            {
+                return 1.0;
+            }
+
+        return term < max_term_freqs_.size() ? max_term_freqs_[ term ] : 0.0;
+    }
+
+InvertedIndex::PostingCursor
+InvertedIndex::GetPostingCursor( const TermId term ) const
+    {
+        PostingCursor cursor;
+
+        if( format_ == PostingsFormat::PLAIN )
+            {
+                cursor.plain_postings_ = GetPlainPostings( term );
+                cursor.SkipRemoved();
+            }
+        else if( term < compressed_postings_.size() )
+            {
+                cursor.compressed_cursor_.emplace( compressed_postings_[ term ] );
+                cursor.term_freq_values_ = &term_freq_values_;
+            }
+
+        return cursor;
+    }
+
+void
+InvertedIndex::PostingCursor::Seek( const int document_id )
+    {
+        if( compressed_cursor_ )
+            {
+                compressed_cursor_->Seek( document_id );
+
+                return;
+            }
+
+        const int * const first = plain_postings_.document_ids + position_;
+        const int * const last = plain_postings_.document_ids + plain_postings_.size;
+
+        if(
+                first == last
+                ||
+                *first >= document_id )
+            {
+                return;
+            }
+
+        position_ = std::lower_bound( first, last, document_id ) - plain_postings_.document_ids;
+
+        SkipRemoved();
+    }
+
+std::size_t
+InvertedIndex::GetMemoryUsage() const
+    {
+        std::size_t memory_usage = sizeof( *this );
+
+        for( const PostingList & postings : plain_postings_ )
+            {
+                memory_usage +=
+                        sizeof( postings )
+                        +
+                        postings.document_ids.capacity() * sizeof( int )
+                        +
+                        postings.term_freqs.capacity() * sizeof( double );
+            }
+
+        for( const CompressedPostingList & postings : compressed_postings_ )
+            {
+                memory_usage += postings.GetMemoryUsage();
+            }
+
+        memory_usage += term_freq_values_.capacity() * sizeof( double );
+
+        // Узел unordered_map - ключ, значение и указатель на следующий узел;
+        // бакет - указатель. Накладные расходы распределителя не учитываются.
+        memory_usage +=
+                term_freq_codes_.size() * ( sizeof( void * ) + sizeof( std::pair< const std::uint64_t, std::uint32_t > ) )
+                +
+                term_freq_codes_.bucket_count() * sizeof( void * );
+
+        memory_usage += max_term_freqs_.capacity() * sizeof( double );
+
+        // Отображённые страницы снимка учитываются так же, как собственные массивы.
+        if( mapped_posting_offsets_ != nullptr )
+            {
+                memory_usage +=
+                        ( mapped_term_count_ + 1 ) * sizeof( std::uint64_t )
+                        +
+                        mapped_posting_offsets_[ mapped_term_count_ ] * ( sizeof( int ) + sizeof( double ) );
+            }
+
+        return memory_usage;
+    }
+
+void
+InvertedIndex::UpdateMaxTermFreq(
+        const TermId term,
+        const double term_freq )
+    {
+        max_term_freqs_[ term ] = std::max( max_term_freqs_[ term ], term_freq );
+    }
+
+std::uint32_t
+InvertedIndex::GetTermFreqCode( const double term_freq )
+    {
+        std::uint64_t bits;
+        std::memcpy( &bits, &term_freq, sizeof( bits ) );
+
+        const auto [ it, inserted ] = term_freq_codes_.emplace(
+                bits,
+                static_cast< std::uint32_t >( term_freq_values_.size() ) );
+
+        if( inserted )
+            {
+                term_freq_values_.push_back( term_freq );
+            }
+
+        return it->second;
+    }
+
+InvertedIndex::PostingsView
+InvertedIndex::GetPlainPostings( const TermId term ) const
+    {
+        if( mapped_posting_offsets_ != nullptr )
+            {
+                if( term >= mapped_term_count_ )
+                    {
+                        return { nullptr, nullptr, 0, 0 };
+                    }
+
+                const std::uint64_t offset = mapped_posting_offsets_[ term ];
+
+                return
+                    {
+                        mapped_document_ids_ + offset,
+                        mapped_term_freqs_ + offset,
+                        mapped_posting_offsets_[ term + 1 ] - offset,
+                        0
+                    };
+            }
+
+        if( term >= plain_postings_.size() )
+            {
+                return { nullptr, nullptr, 0, 0 };
+            }
+
+        const PostingList & postings = plain_postings_[ term ];
+
+        return
+            {
+                postings.document_ids.data(),
+                postings.term_freqs.data(),
+                postings.document_ids.size(),
+                postings.removed_count
+            };
+    }
+
+void
+InvertedIndex::ThrowIfMapped() const
+    {
+        if( mapped_posting_offsets_ != nullptr )
+            {
+                throw std::logic_error( "Индекс, загруженный из снимка, доступен только для чтения." );
+            }
+    }
+
+void
+InvertedIndex::InsertPosting(
+        PostingList & postings,
+        const int document_id,
+        const double term_freq )
+    {
+        // Документы обычно добавляются с возрастающими id,
+        // поэтому в типичном случае постинг дописывается в конец.
+        if(
+                postings.document_ids.empty()
+                ||
+                postings.document_ids.back() < document_id )
+            {
+                postings.document_ids.push_back( document_id );
+                postings.term_freqs.push_back( term_freq );
+
+                return;
+            }
+
+        const auto position = std::lower_bound(
+                postings.document_ids.cbegin(),
+                postings.document_ids.cend(),
+                document_id );
+
+        const auto offset = std::distance( postings.document_ids.cbegin(), position );
+
+        // Постинг удалённого документа с тем же id ещё не вычищен: он занимает место снова.
+        if(
+                position != postings.document_ids.cend()
+                &&
+                *position == document_id )
+            {
+                postings.term_freqs[ offset ] = term_freq;
+                --postings.removed_count;
+
+                return;
+            }
+
+        postings.document_ids.insert( position, document_id );
+        postings.term_freqs.insert( std::next( postings.term_freqs.cbegin(), offset ), term_freq );
+    }
+
+void
+InvertedIndex::MergePostings(
+        PostingList & postings,
+        const Postings & added_postings )
+    {
+        if( added_postings.empty() )
+            {
+                return;
+            }
+
+        // Как и в InsertPosting, в типичном случае новые id больше уже имеющихся.
+        if(
+                postings.document_ids.empty()
+                ||
+                postings.document_ids.back() < added_postings.front().first )
+            {
+                postings.document_ids.reserve( postings.document_ids.size() + added_postings.size() );
+                postings.term_freqs.reserve( postings.term_freqs.size() + added_postings.size() );
+
+                for( const auto & [ document_id, term_freq ] : added_postings )
+                    {
+                        postings.document_ids.push_back( document_id );
+                        postings.term_freqs.push_back( term_freq );
+                    }
+
+                return;
+            }
+
+        // Отмеченные постинги могли бы совпасть по id с добавляемыми.
+        Compact( postings );
+
+        PostingList merged;
+        merged.document_ids.reserve( postings.document_ids.size() + added_postings.size() );
+        merged.term_freqs.reserve( postings.term_freqs.size() + added_postings.size() );
+
+        std::size_t i = 0;
+
+        for( const auto & [ document_id, term_freq ] : added_postings )
+            {
+                for( ; i < postings.document_ids.size() && postings.document_ids[ i ] < document_id; ++i )
+                    {
+                        merged.document_ids.push_back( postings.document_ids[ i ] );
+                        merged.term_freqs.push_back( postings.term_freqs[ i ] );
+                    }
+
+                merged.document_ids.push_back( document_id );
+                merged.term_freqs.push_back( term_freq );
+            }
+
+        for( ; i < postings.document_ids.size(); ++i )
+            {
+                merged.document_ids.push_back( postings.document_ids[ i ] );
+                merged.term_freqs.push_back( postings.term_freqs[ i ] );
+            }
+
+        postings = std::move( merged );
+    }
+
+void
+InvertedIndex::ErasePosting(
+        PostingList & postings,
+        const int document_id )
+    {
+        const auto position = std::lower_bound(
+                postings.document_ids.cbegin(),
+                postings.document_ids.cend(),
+                document_id );
+
+        if(
+                position == postings.document_ids.cend()
+                ||
+                *position != document_id )
+            {
+                return;
+            }
+
+        double & term_freq = postings.term_freqs[ std::distance( postings.document_ids.cbegin(), position ) ];
+
+        if( term_freq != REMOVED_TERM_FREQ )
+            {
+                term_freq = REMOVED_TERM_FREQ;
+                ++postings.removed_count;
+            }
+    }
+
+void
+InvertedIndex::CompactIfSparse( PostingList & postings )
+    {
+        if( 2 * postings.removed_count > postings.document_ids.size() )
+            {
+                Compact( postings );
+            }
+    }
+
+void
+InvertedIndex::Compact( PostingList & postings )
+    {
+        if( postings.removed_count == 0 )
+            {
+                return;
+            }
+
+        std::size_t kept_count = 0;
+
+        for( std::size_t i = 0; i < postings.document_ids.size(); ++i )
+            {
+                if( postings.term_freqs[ i ] == REMOVED_TERM_FREQ )
+                    {
+                        continue;
+                    }
+
+                postings.document_ids[ kept_count ] = postings.document_ids[ i ];
+                postings.term_freqs[ kept_count ] = postings.term_freqs[ i ];
+                ++kept_count;
+            }
+
+        postings.document_ids.resize( kept_count );
+        postings.term_freqs.resize( kept_count );
+        postings.removed_count = 0;
+    }
@@ -0,0 +1,488 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "compressed_posting_list.h"
+#include "term_dictionary.h"
+
+enum class PostingsFormat
+    {
+        PLAIN,
+        COMPRESSED,
+    };
+
+class InvertedIndex
+    {
+
+        public:
+
+            using TermFreqs = std::vector< std::pair< TermId, double > >;
+
+            // Удаляемые документы пакета по словам: слово и id его удаляемых
+            // документов по возрастанию.
+            using TermDocuments = std::vector< std::pair< TermId, std::vector< int > > >;
+
+            // Постинги одного слова для пакетной вставки: пары ( id документа, частота )
+            // по возрастанию id.
+            using Postings = std::vector< std::pair< int, double > >;
+
+            using TermPostings = std::pair< TermId, Postings >;
+
+            class PostingCursor;
+
+            explicit InvertedIndex( const PostingsFormat format = PostingsFormat::PLAIN );
+
+            // Индекс только для чтения над массивами снимка: постинги слова term
+            // занимают позиции [ posting_offsets[ term ]; posting_offsets[ term + 1 ] ).
+            InvertedIndex(
+                    const std::uint64_t * posting_offsets,
+                    const int * document_ids,
+                    const double * term_freqs,
+                    const std::size_t term_count );
+
+            InvertedIndex( const InvertedIndex & other ) = default;
+
+            // Источник остаётся пустым собственным индексом того же формата.
+            InvertedIndex( InvertedIndex && other );
+
+            // Частоты слов документа, слова которого перечислены в document_terms
+            // по порядку текста: доля вхождений каждого слова, по возрастанию TermId.
+            // Все способы добавления документов считают частоты здесь, поэтому
+            // частоты совпадают побитово.
+            static TermFreqs
+            ComputeTermFreqs( std::vector< TermId > document_terms );
+
+            void
+            AddDocument(
+                    const int document_id,
+                    const TermFreqs & term_freqs );
+
+            // Вливает постинги пакета документов; слова в term_postings не повторяются,
+            // поэтому списки разных слов объединяются параллельно.
+            template < typename ExecutionPolicy >
+            void
+            AddPostings(
+                    ExecutionPolicy && policy,
+                    const std::vector< TermPostings > & term_postings )
+                {
+                    ThrowIfMapped();
+
+                    TermId term_count = 0;
+
+                    for( const auto & [ term, _ ] : term_postings )
+                        {
+                            term_count = std::max( term_count, term + 1 );
+                        }
+
+                    if( term_count > max_term_freqs_.size() )
+                        {
+                            max_term_freqs_.resize( term_count );
+                        }
+
+                    // Слова пакета не повторяются, поэтому максимумы обновляются параллельно.
+                    std::for_each(
+                            policy,
+                            term_postings.cbegin(),
+                            term_postings.cend(),
+                            [this]( const TermPostings & postings )
+                                {
+                                    for( const auto & [ _, term_freq ] : postings.second )
+                                        {
+                                            UpdateMaxTermFreq( postings.first, term_freq );
+                                        }
+                                } );
+
+                    if( format_ == PostingsFormat::PLAIN )
+                        {
+                            if( term_count > plain_postings_.size() )
+                                {
+                                    plain_postings_.resize( term_count );
+                                }
+
+                            std::for_each(
+                                    policy,
+                                    term_postings.cbegin(),
+                                    term_postings.cend(),
+                                    [this]( const TermPostings & postings )
+                                        {
+                                            MergePostings( plain_postings_[ postings.first ], postings.second );
+                                        } );
+                        }
+                    else
+                        {
+                            if( term_count > compressed_postings_.size() )
+                                {
+                                    compressed_postings_.resize( term_count );
+                                }
+
+                            // Таблица кодов частот общая для всех слов, поэтому коды
+                            // назначаются заранее, а списки заполняются параллельно.
+                            std::vector< std::vector< std::uint32_t > > term_freq_codes( term_postings.size() );
+
+                            for( std::size_t i = 0; i < term_postings.size(); ++i )
+                                {
+                                    term_freq_codes[ i ].reserve( term_postings[ i ].second.size() );
+
+                                    for( const auto & [ _, term_freq ] : term_postings[ i ].second )
+                                        {
+                                            term_freq_codes[ i ].push_back( GetTermFreqCode( term_freq ) );
+                                        }
+                                }
+
+                            std::vector< std::size_t > term_indices( term_postings.size() );
+                            std::iota( term_indices.begin(), term_indices.end(), std::size_t{ 0 } );
+
+                            std::for_each(
+                                    policy,
+                                    term_indices.cbegin(),
+                                    term_indices.cend(),
+                                    [this, &term_postings, &term_freq_codes]( const std::size_t i )
+                                        {
+                                            const TermPostings & postings = term_postings[ i ];
+
+                                            std::vector< int > document_ids;
+                                            document_ids.reserve( postings.second.size() );
+
+                                            for( const auto & [ document_id, _ ] : postings.second )
+                                                {
+                                                    document_ids.push_back( document_id );
+                                                }
+
+                                            compressed_postings_[ postings.first ].Merge( document_ids, term_freq_codes[ i ] );
+                                        } );
+                        }
+                }
+
+            // Постинг в простом списке слова только отмечается удалённым за O( log df );
+            // список вычищается, когда отмеченных становится больше половины.
+            // Сжатый список перекодирует только блок с документом.
+            void
+            RemoveDocument(
+                    const int document_id,
+                    const TermFreqs & term_freqs );
+
+            // Постинги разных слов независимы, поэтому удаляются параллельно.
+            template < typename ExecutionPolicy >
+            void
+            RemoveDocument(
+                    ExecutionPolicy && policy,
+                    const int document_id,
+                    const TermFreqs & term_freqs )
+                {
+                    ThrowIfMapped();
+
+                    std::for_each(
+                            policy,
+                            term_freqs.cbegin(),
+                            term_freqs.cend(),
+                            [this, document_id]( const auto & term_freq )
+                                {
+                                    if( format_ == PostingsFormat::PLAIN )
+                                        {
+                                            PostingList & postings = plain_postings_[ term_freq.first ];
+
+                                            ErasePosting( postings, document_id );
+                                            CompactIfSparse( postings );
+                                        }
+                                    else
+                                        {
+                                            compressed_postings_[ term_freq.first ].Erase( document_id );
+                                        }
+                                } );
+                }
+
+            // Сжатый список постингов каждого слова пакета перекодируется один раз;
+            // в простых списках постинги отмечаются удалёнными, как в RemoveDocument.
+            void
+            RemoveDocuments( const TermDocuments & term_documents );
+
+            // Число документов, содержащих слово.
+            std::size_t
+            GetDocumentFreq( const TermId term ) const;
+
+            bool
+            ContainsDocument(
+                    const TermId term,
+                    const int document_id ) const;
+
+            // Верхняя граница частоты слова в документах: после удаления документов
+            // граница не уменьшается. Для снимка - 1, частота слова не больше единицы.
+            double
+            GetMaxTermFreq( const TermId term ) const;
+
+            PostingCursor
+            GetPostingCursor( const TermId term ) const;
+
+            std::size_t
+            GetMemoryUsage() const;
+
+            // Вызывает visitor( document_id, term_freq ) для каждого постинга слова
+            // в порядке возрастания id документов.
+            template < typename Visitor >
+            void
+            ForEachPosting(
+                    const TermId term,
+                    Visitor visitor ) const
+                {
+                    if( format_ == PostingsFormat::PLAIN )
+                        {
+                            const PostingsView postings = GetPlainPostings( term );
+
+                            for( std::size_t i = 0; i < postings.size; ++i )
+                                {
+                                    if( postings.term_freqs[ i ] != REMOVED_TERM_FREQ )
+                                        {
+                                            visitor( postings.document_ids[ i ], postings.term_freqs[ i ] );
+                                        }
+                                }
+                        }
+                    else
+                        {
+                            if( term >= compressed_postings_.size() )
+                                {
+                                    return;
+                                }
+
+                            compressed_postings_[ term ].ForEach(
+                                    [this, &visitor]( const int document_id, const std::uint32_t term_freq_code )
+                                        {
+                                            visitor( document_id, term_freq_values_[ term_freq_code ] );
+                                        } );
+                        }
+                }
+
+            // Как ForEachPosting, но только для документов с id из
+            // [ first_document_id, last_document_id ]. Простой список пропускает
+            // постинги до отрезка двоичным поиском, сжатый - блоками.
+            template < typename Visitor >
+            void
+            ForEachPosting(
+                    const TermId term,
+                    const int first_document_id,
+                    const int last_document_id,
+                    Visitor visitor ) const
+                {
+                    if( format_ == PostingsFormat::PLAIN )
+                        {
+                            const PostingsView postings = GetPlainPostings( term );
+
+                            const std::size_t first = std::lower_bound(
+                                    postings.document_ids,
+                                    postings.document_ids + postings.size,
+                                    first_document_id ) - postings.document_ids;
+
+                            for( std::size_t i = first; i < postings.size && postings.document_ids[ i ] <= last_document_id; ++i )
+                                {
+                                    if( postings.term_freqs[ i ] != REMOVED_TERM_FREQ )
+                                        {
+                                            visitor( postings.document_ids[ i ], postings.term_freqs[ i ] );
+                                        }
+                                }
+                        }
+                    else
+                        {
+                            if( term >= compressed_postings_.size() )
+                                {
+                                    return;
+                                }
+
+                            compressed_postings_[ term ].ForEach(
+                                    first_document_id,
+                                    last_document_id,
+                                    [this, &visitor]( const int document_id, const std::uint32_t term_freq_code )
+                                        {
+                                            visitor( document_id, term_freq_values_[ term_freq_code ] );
+                                        } );
+                        }
+                }
+
+        private:
+
+            // Частота удалённого, но ещё не вычищенного постинга простого списка.
+            static constexpr double REMOVED_TERM_FREQ = -1.0;
+
+            // Постинги одного слова: отсортированные по возрастанию id документов
+            // и соответствующие им частоты слова, хранящиеся в непрерывных массивах.
+            // Удалённые постинги остаются на месте с частотой REMOVED_TERM_FREQ,
+            // пока список не будет уплотнён.
+            struct PostingList
+                {
+                    std::vector< int > document_ids;
+                    std::vector< double > term_freqs;
+                    std::size_t removed_count = 0;
+                };
+
+            // Постинги одного слова в несжатом формате - из PostingList или из снимка;
+            // size включает removed_count отмеченных удалёнными постингов.
+            struct PostingsView
+                {
+                    const int * document_ids;
+                    const double * term_freqs;
+                    std::size_t size;
+                    std::size_t removed_count;
+                };
+
+            const PostingsFormat format_;
+
+            std::vector< PostingList > plain_postings_;
+
+            std::vector< CompressedPostingList > compressed_postings_;
+
+            // В сжатом формате частота слова хранится кодом - номером значения в таблице.
+            // Различных частот (k / n для небольших k и n) немного, а значения
+            // в таблице точные, поэтому релевантность не отличается от несжатого формата.
+            std::vector< double > term_freq_values_;
+
+            std::unordered_map< std::uint64_t, std::uint32_t > term_freq_codes_;
+
+            std::vector< double > max_term_freqs_;
+
+            const std::uint64_t * mapped_posting_offsets_ = nullptr;
+
+            const int * mapped_document_ids_ = nullptr;
+
+            const double * mapped_term_freqs_ = nullptr;
+
+            std::size_t mapped_term_count_ = 0;
+
+            PostingsView
+            GetPlainPostings( const TermId term ) const;
+
+            void
+            ThrowIfMapped() const;
+
+            void
+            UpdateMaxTermFreq(
+                    const TermId term,
+                    const double term_freq );
+
+            std::uint32_t
+            GetTermFreqCode( const double term_freq );
+
+            static void
+            InsertPosting(
+                    PostingList & postings,
+                    const int document_id,
+                    const double term_freq );
+
+            static void
+            MergePostings(
+                    PostingList & postings,
+                    const Postings & added_postings );
+
+            // Отмечает постинг документа удалённым, не уплотняя список.
+            static void
+            ErasePosting(
+                    PostingList & postings,
+                    const int document_id );
+
+            // Вычищает отмеченные постинги, если их больше половины списка:
+            // уплотнение за O( df ) приходится не чаще, чем на df / 2 удалений.
+            static void
+            CompactIfSparse( PostingList & postings );
+
+            static void
+            Compact( PostingList & postings );
+    };
+
+// Курсор по постингам слова в порядке возрастания id документов,
+// для поиска с пропуском документов (WAND).
+class InvertedIndex::PostingCursor
+    {
+
+        public:
+
+            // id документа курсора, прошедшего все постинги.
+            static constexpr int END_DOCUMENT_ID = std::numeric_limits< int >::max();
+
+            int
+            GetDocumentId() const;
+
+            double
+            GetTermFreq() const;
+
+            void
+            Next();
+
+            // Переходит к первому постингу с id не меньше document_id.
+            void
+            Seek( const int document_id );
+
+        private:
+
+            friend class InvertedIndex;
+
+            // Пропускает отмеченные удалёнными постинги простого списка.
+            void
+            SkipRemoved();
+
+            PostingsView plain_postings_{ nullptr, nullptr, 0, 0 };
+
+            std::size_t position_ = 0;
+
+            std::optional< CompressedPostingList::Cursor > compressed_cursor_;
+
+            const std::vector< double > * term_freq_values_ = nullptr;
+    };
+
+inline int
+InvertedIndex::PostingCursor::GetDocumentId() const
+    {
+        if( compressed_cursor_ )
+            {
+                return compressed_cursor_->IsEnd() ? END_DOCUMENT_ID : compressed_cursor_->GetDocumentId();
+            }
+
+        return position_ < plain_postings_.size ? plain_postings_.document_ids[ position_ ] : END_DOCUMENT_ID;
+    }
+
+inline double
+InvertedIndex::PostingCursor::GetTermFreq() const
+    {
+        if( compressed_cursor_ )
+            {
+                return ( *term_freq_values_ )[ compressed_cursor_->GetTermFreqCode() ];
+            }
+
+        return plain_postings_.term_freqs[ position_ ];
+    }
+
+inline void
+InvertedIndex::PostingCursor::Next()
+    {
+        if( compressed_cursor_ )
+            {
+                compressed_cursor_->Next();
+            }
+        else
+            {
+                ++position_;
+
+                SkipRemoved();
+            }
+    }
+
+inline void
+InvertedIndex::PostingCursor::SkipRemoved()
+    {
+        if( plain_postings_.removed_count == 0 )
+            {
+                return;
+            }
+
+        while(
+                position_ < plain_postings_.size
+                &&
+                plain_postings_.term_freqs[ position_ ] == REMOVED_TERM_FREQ )
+            {
+                ++position_;
+            }
+    }
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -12,7 +13,24 @@ main()
         using namespace std::string_literals;
 
         SearchServer search_server( "and in at"s );
-        RequestQueue request_queue( search_server );
+
+        // Сутки из 1440 минут; каждый запрос приходит через минуту после предыдущего.
+        RequestQueue::Clock::time_point now;
+
+        RequestQueue request_queue(
+                search_server,
+                std::chrono::hours( 24 ),
+                [&now]()
+                    {
+                        return now;
+                    } );
+
+        const auto add_find_request = [&]( const std::string & raw_query )
+            {
+                now += std::chrono::minutes( 1 );
+
+                request_queue.AddFindRequest( raw_query );
+            };
 
         search_server.AddDocument( 1, "curly cat curly tail"s,       DocumentStatus::ACTUAL, { 7, 2, 7 } );
         search_server.AddDocument( 2, "curly dog and fancy collar"s, DocumentStatus::ACTUAL, { 1, 2, 3 } );
@@ -23,17 +41,17 @@ main()
         // 1439 запросов с нулевым результатом
         for( int i = 0; i < 1439; ++i )
             {
-                request_queue.AddFindRequest( "empty request"s );
+                add_find_request( "empty request"s );
             }
 
         // все еще 1439 запросов с нулевым результатом
-        request_queue.AddFindRequest( "curly dog"s );
+        add_find_request( "curly dog"s );
 
         // новые сутки, первый запрос удален, 1438 запросов с нулевым результатом
-        request_queue.AddFindRequest( "big collar"s );
+        add_find_request( "big collar"s );
 
         // первый запрос удален, 1437 запросов с нулевым результатом
-        request_queue.AddFindRequest( "sparrow"s );
+        add_find_request( "sparrow"s );
 
         std::cout << "Total empty requests: "s << request_queue.GetNoResultRequests() << '\n';
     }
@@ -0,0 +1,63 @@
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+MappedFile::MappedFile( const std::string & path )
+    {
+        using namespace std::string_literals;
+
+        const int descriptor = ::open( path.c_str(), O_RDONLY );
+
+        if( descriptor < 0 )
+            {
+                throw std::runtime_error( "Не удалось открыть файл "s + path + "."s );
+            }
+
+        struct stat file_status;
+
+        if(
+                ::fstat( descriptor, &file_status ) != 0
+                ||
+                file_status.st_size == 0 )
+            {
+                ::close( descriptor );
+
+                throw std::runtime_error( "Файл "s + path + " пуст или недоступен."s );
+            }
+
+        size_ = static_cast< std::size_t >( file_status.st_size );
+
+        void * const address = ::mmap( nullptr, size_, PROT_READ, MAP_SHARED, descriptor, 0 );
+
+        // Отображение остаётся действительным и после закрытия дескриптора.
+        ::close( descriptor );
+
+        if( address == MAP_FAILED )
+            {
+                throw std::runtime_error( "Не удалось отобразить в память файл "s + path + "."s );
+            }
+
+        data_ = static_cast< const char * >( address );
+    }
+
+MappedFile::~MappedFile()
+    {
+        ::munmap( const_cast< char * >( data_ ), size_ );
+    }
+
+const char *
+MappedFile::data() const
+    {
+        return data_;
+    }
+
+std::size_t
+MappedFile::size() const
+    {
+        return size_;
+    }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Файл, отображённый в память только для чтения.
+// Отображение снимается при разрушении объекта.
+class MappedFile
+    {
+
+        public:
+
+            explicit MappedFile( const std::string & path );
+
+            MappedFile( const MappedFile & ) = delete;
+
+            MappedFile &
+            operator=( const MappedFile & ) = delete;
+
+            ~MappedFile();
+
+            const char *
+            data() const;
+
+            std::size_t
+            size() const;
+
+        private:
+
+            const char * data_ = nullptr;
+
+            std::size_t size_ = 0;
+    };
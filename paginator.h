@@ -1,8 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
-#include <vector>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
 
 template < typename Iterator >
 class IteratorRange
@@ -16,7 +19,6 @@ class IteratorRange
                 :
                       first_( begin )
                     , last_( end )
-                    , size_( distance( first_, last_ ) )
                 {}
 
             Iterator
@@ -31,17 +33,17 @@ class IteratorRange
                     return last_;
                 }
 
+            // O( 1 ) для итераторов произвольного доступа, иначе - обход диапазона.
             std::size_t
             size() const
                 {
-                    return size_;
+                    return std::distance( first_, last_ );
                 }
 
         private:
 
             const Iterator first_;
             const Iterator last_;
-            const std::size_t size_;
     };
 
 template < typename Iterator >
@@ -58,62 +60,167 @@ operator<<(
         return out;
     }
 
+// Разбиение диапазона на страницы по page_size элементов. Границы страниц
+// вычисляются при обходе, поэтому страницы не хранятся, а создание разбиения
+// не обходит диапазон. Для итераторов произвольного доступа size() и доступ
+// к странице по номеру стоят O( 1 ); по однонаправленным итераторам, например
+// по потоку результатов, обход оплачивает только пройденные страницы.
 template < typename Iterator >
 class Paginator
     {
 
         public:
 
+            // Итератор по страницам; страница возвращается по значению.
+            class PageIterator
+                {
+
+                    public:
+
+                        using iterator_category = std::input_iterator_tag;
+                        using value_type = IteratorRange< Iterator >;
+                        using difference_type = std::ptrdiff_t;
+                        using pointer = void;
+                        using reference = value_type;
+
+                        PageIterator(
+                                const Iterator page_begin,
+                                const Iterator end,
+                                const std::size_t page_size )
+                            :
+                                  page_begin_( page_begin )
+                                , page_end_( AdvanceBounded( page_begin, end, page_size ) )
+                                , end_( end )
+                                , page_size_( page_size )
+                            {}
+
+                        value_type
+                        operator*() const
+                            {
+                                return { page_begin_, page_end_ };
+                            }
+
+                        PageIterator &
+                        operator++()
+                            {
+                                page_begin_ = page_end_;
+                                page_end_ = AdvanceBounded( page_begin_, end_, page_size_ );
+
+                                return *this;
+                            }
+
+                        PageIterator
+                        operator++( int )
+                            {
+                                PageIterator previous = *this;
+
+                                ++*this;
+
+                                return previous;
+                            }
+
+                        bool
+                        operator==( const PageIterator & other ) const
+                            {
+                                return page_begin_ == other.page_begin_;
+                            }
+
+                        bool
+                        operator!=( const PageIterator & other ) const
+                            {
+                                return !( *this == other );
+                            }
+
+                    private:
+
+                        Iterator page_begin_;
+                        Iterator page_end_;
+                        Iterator end_;
+                        std::size_t page_size_;
+                };
+
             Paginator(
                     const Iterator begin,
                     const Iterator end,
                     const std::size_t page_size )
                 :
-                    pages_( Paginator::CreatePages( begin, end, page_size ) )
-                {}
+                      first_( begin )
+                    , last_( end )
+                    , page_size_( page_size )
+                {
+                    if( page_size_ == 0 )
+                        {
+                            throw std::invalid_argument( "Размер страницы должен быть положительным." );
+                        }
+                }
 
-            auto
+            PageIterator
             begin() const
                 {
-                    return pages_.begin();
+                    return { first_, last_, page_size_ };
                 }
 
-            auto
+            PageIterator
             end() const
                 {
-                    return pages_.end();
+                    return { last_, last_, page_size_ };
                 }
 
             std::size_t
             size() const
                 {
-                    return pages_.size();
+                    const std::size_t item_count = std::distance( first_, last_ );
+
+                    return ( item_count + page_size_ - 1 ) / page_size_;
+                }
+
+            // Страница с номером page; за последней страницей - пустой диапазон.
+            IteratorRange< Iterator >
+            operator[]( const std::size_t page ) const
+                {
+                    static_assert(
+                            IS_RANDOM_ACCESS,
+                            "Paginator::operator[] requires random access iterators" );
+
+                    const std::size_t item_count = last_ - first_;
+                    const std::size_t page_first = std::min( page * page_size_, item_count );
+                    const std::size_t page_last = std::min( page_first + page_size_, item_count );
+
+                    return { first_ + page_first, first_ + page_last };
                 }
 
         private:
 
-            static auto
-            CreatePages(
-                    Iterator begin,
+            static constexpr bool IS_RANDOM_ACCESS =
+                    std::is_base_of_v<
+                            std::random_access_iterator_tag,
+                            typename std::iterator_traits< Iterator >::iterator_category >;
+
+            const Iterator first_;
+            const Iterator last_;
+            const std::size_t page_size_;
+
+            // Итератор на count элементов дальше it, но не дальше end.
+            static Iterator
+            AdvanceBounded(
+                    Iterator it,
                     const Iterator end,
-                    const std::size_t page_size )
+                    std::size_t count )
                 {
-                    std::vector< IteratorRange< Iterator > > result;
-
-                    for( std::size_t left = std::distance( begin, end ); left > 0; )
+                    if constexpr( IS_RANDOM_ACCESS )
                         {
-                            const std::size_t current_page_size = std::min( page_size, left );
-                            const Iterator current_page_end = std::next( begin, current_page_size );
-                            result.push_back( { begin, current_page_end } );
-
-                            left -= current_page_size;
-                            begin = current_page_end;
+                            return it + std::min< std::ptrdiff_t >( count, end - it );
                         }
+                    else
+                        {
+                            for( ; count > 0 && it != end; --count )
+                                {
+                                    ++it;
+                                }
 
-                    return result;
+                            return it;
+                        }
                 }
-
-            const std::vector< IteratorRange< Iterator > > pages_;
     };
 
 template < typename Container >
@@ -124,4 +231,3 @@ Paginate(
     {
         return Paginator( std::begin( c ), std::end(c), page_size );
     }
-
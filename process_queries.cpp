@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <execution>
+#include <iterator>
+#include <numeric>
+
+#include "process_queries.h"
+
+std::vector< std::vector< Document > >
+ProcessQueries(
+        const SearchServer & search_server,
+        const std::vector< std::string > & queries )
+    {
+        std::vector< std::vector< Document > > documents_lists( queries.size() );
+
+        std::transform(
+                std::execution::par,
+                queries.cbegin(),
+                queries.cend(),
+                documents_lists.begin(),
+                [&search_server]( const std::string & query )
+                    {
+                        return search_server.FindTopDocuments( query );
+                    } );
+
+        return documents_lists;
+    }
+
+std::vector< Document >
+ProcessQueriesJoined(
+        const SearchServer & search_server,
+        const std::vector< std::string > & queries )
+    {
+        // Каждому запросу отведён участок на MAX_RESULT_DOCUMENT_COUNT документов:
+        // запросы пишут результаты прямо в общий вектор, а после поиска участки
+        // один раз сдвигаются к началу.
+        const std::size_t slot_size = MAX_RESULT_DOCUMENT_COUNT;
+
+        std::vector< Document > joined_documents( queries.size() * slot_size );
+        std::vector< std::size_t > result_counts( queries.size() );
+
+        std::vector< std::size_t > query_indices( queries.size() );
+        std::iota( query_indices.begin(), query_indices.end(), 0 );
+
+        std::for_each(
+                std::execution::par,
+                query_indices.cbegin(),
+                query_indices.cend(),
+                [&]( const std::size_t query_index )
+                    {
+                        result_counts[ query_index ] = search_server.FindTopDocumentsInto(
+                                queries[ query_index ],
+                                DocumentStatus::ACTUAL,
+                                slot_size,
+                                joined_documents.data() + query_index * slot_size );
+                    } );
+
+        auto joined_end = joined_documents.begin();
+
+        for( std::size_t query_index = 0; query_index < queries.size(); ++query_index )
+            {
+                const auto slot = std::next( joined_documents.begin(), query_index * slot_size );
+
+                joined_end = std::move( slot, std::next( slot, result_counts[ query_index ] ), joined_end );
+            }
+
+        joined_documents.erase( joined_end, joined_documents.end() );
+
+        return joined_documents;
+    }
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "query_arena.h"
+
+namespace
+    {
+        // Память сверх буфера арены: берётся из кучи, а объём запоминается,
+        // чтобы увеличить буфер.
+        class OverflowResource : public std::pmr::memory_resource
+            {
+
+                public:
+
+                    std::size_t allocated_bytes = 0;
+
+                private:
+
+                    void *
+                    do_allocate(
+                            const std::size_t bytes,
+                            const std::size_t alignment ) override
+                        {
+                            allocated_bytes += bytes;
+
+                            return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+                        }
+
+                    void
+                    do_deallocate(
+                            void * const pointer,
+                            const std::size_t bytes,
+                            const std::size_t alignment ) override
+                        {
+                            std::pmr::new_delete_resource()->deallocate( pointer, bytes, alignment );
+                        }
+
+                    bool
+                    do_is_equal( const std::pmr::memory_resource & other ) const noexcept override
+                        {
+                            return this == &other;
+                        }
+            };
+    }
+
+struct QueryArena::ThreadState
+    {
+        std::vector< std::byte > buffer = std::vector< std::byte >( INITIAL_BUFFER_SIZE );
+
+        OverflowResource overflow;
+
+        std::optional< std::pmr::monotonic_buffer_resource > resource;
+
+        std::size_t depth = 0;
+    };
+
+QueryArena::QueryArena()
+    :
+        state_( GetThreadState() )
+    {
+        if( state_.depth++ == 0 )
+            {
+                state_.resource.emplace( state_.buffer.data(), state_.buffer.size(), &state_.overflow );
+            }
+    }
+
+QueryArena::~QueryArena()
+    {
+        if( --state_.depth > 0 )
+            {
+                return;
+            }
+
+        state_.resource.reset();
+
+        if(
+                state_.overflow.allocated_bytes > 0
+                &&
+                state_.buffer.size() < MAX_BUFFER_SIZE )
+            {
+                const std::size_t buffer_size = std::max( 2 * state_.buffer.size(), state_.buffer.size() + state_.overflow.allocated_bytes );
+
+                state_.buffer.resize( std::min( buffer_size, MAX_BUFFER_SIZE ) );
+            }
+
+        state_.overflow.allocated_bytes = 0;
+    }
+
+std::pmr::memory_resource *
+QueryArena::GetResource() const
+    {
+        return &*state_.resource;
+    }
+
+QueryArena::ThreadState &
+QueryArena::GetThreadState()
+    {
+        thread_local ThreadState state;
+
+        return state;
+    }
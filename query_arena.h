@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Арена для временных данных запроса: слов запроса, накопителя релевантности,
+// списка найденных документов. Память выдаётся из буфера потока подряд и
+// освобождается разом при выходе из внешнего объекта QueryArena, без обращений
+// к общему распределителю памяти и без блокировок между потоками.
+//
+// Если запросу не хватило буфера, недостающее берётся из кучи, а буфер потока
+// к следующему запросу увеличивается, но не больше MAX_BUFFER_SIZE; в
+// установившемся режиме временные данные запросов в куче не выделяются. Редкий
+// запрос крупнее предела берёт остаток из кучи и не раздувает буфер потока
+// навсегда. Вложенные QueryArena используют арену внешнего.
+//
+// Память арены действительна, пока жив внешний объект: данные, которые
+// возвращаются вызывающему, копируются в обычные контейнеры.
+class QueryArena
+    {
+
+        public:
+
+            static constexpr std::size_t INITIAL_BUFFER_SIZE = 64 * 1024;
+
+            static constexpr std::size_t MAX_BUFFER_SIZE = 16 * 1024 * 1024;
+
+            QueryArena();
+
+            QueryArena( const QueryArena & ) = delete;
+
+            QueryArena &
+            operator=( const QueryArena & ) = delete;
+
+            ~QueryArena();
+
+            std::pmr::memory_resource *
+            GetResource() const;
+
+        private:
+
+            struct ThreadState;
+
+            ThreadState & state_;
+
+            static ThreadState &
+            GetThreadState();
+    };
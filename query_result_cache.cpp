@@ -0,0 +1,208 @@
+#include <functional>
+#include <utility>
+
+#include "query_result_cache.h"
+
+bool
+QueryResultCache::Key::operator==( const Key & other ) const
+    {
+        return
+                status == other.status
+                &&
+                max_result_count == other.max_result_count
+                &&
+                plus_terms == other.plus_terms
+                &&
+                minus_terms == other.minus_terms;
+    }
+
+std::size_t
+QueryResultCache::KeyHash::operator()( const Key & key ) const
+    {
+        std::size_t hash = std::hash< std::size_t >()( key.max_result_count );
+
+        const auto combine = [&hash]( const std::size_t value )
+            {
+                hash ^= value + 0x9e3779b97f4a7c15ULL + ( hash << 6 ) + ( hash >> 2 );
+            };
+
+        combine( static_cast< std::size_t >( key.status ) );
+
+        for( const TermId term : key.plus_terms )
+            {
+                combine( term );
+            }
+
+        // Разделитель: иначе { a } { b } и { a, b } { } получили бы один хеш.
+        combine( key.plus_terms.size() );
+
+        for( const TermId term : key.minus_terms )
+            {
+                combine( term );
+            }
+
+        return hash;
+    }
+
+QueryResultCache::QueryResultCache( const std::size_t capacity )
+    :
+        capacity_( capacity )
+    {}
+
+QueryResultCache::QueryResultCache( const QueryResultCache & other )
+    :
+        capacity_( other.capacity_.load() )
+    {}
+
+QueryResultCache::QueryResultCache( QueryResultCache && other )
+    {
+        const std::lock_guard lock( other.mutex_ );
+
+        // Узлы unordered_map и list при перемещении контейнеров остаются на месте,
+        // поэтому указатели на ключи и позиции в recency_ остаются верными.
+        capacity_ = other.capacity_.load();
+        generation_ = other.generation_;
+        entries_ = std::move( other.entries_ );
+        recency_ = std::move( other.recency_ );
+        stats_ = other.stats_;
+
+        other.entries_.clear();
+        other.recency_.clear();
+    }
+
+bool
+QueryResultCache::IsEnabled() const
+    {
+        return capacity_ != 0;
+    }
+
+std::shared_ptr< const std::vector< Document > >
+QueryResultCache::Find(
+        const Key & key,
+        const std::uint64_t generation )
+    {
+        if( capacity_ == 0 )
+            {
+                return nullptr;
+            }
+
+        const std::lock_guard lock( mutex_ );
+
+        // Ёмкость могла стать нулевой до блокировки.
+        if( capacity_ == 0 )
+            {
+                return nullptr;
+            }
+
+        ClearIfStale( generation );
+
+        const auto it = entries_.find( key );
+
+        if( it == entries_.end() )
+            {
+                ++stats_.misses;
+
+                return nullptr;
+            }
+
+        ++stats_.hits;
+
+        recency_.splice( recency_.begin(), recency_, it->second.recency_position );
+
+        return it->second.documents;
+    }
+
+void
+QueryResultCache::Insert(
+        const Key & key,
+        const std::pmr::vector< Document > & documents,
+        const std::uint64_t generation )
+    {
+        if( capacity_ == 0 )
+            {
+                return;
+            }
+
+        // Копии pmr-векторов получают ресурс по умолчанию, а не арену запроса.
+        Key stored_key{
+                { key.plus_terms.cbegin(), key.plus_terms.cend() },
+                { key.minus_terms.cbegin(), key.minus_terms.cend() },
+                key.status,
+                key.max_result_count };
+
+        auto stored_documents = std::make_shared< const std::vector< Document > >( documents.cbegin(), documents.cend() );
+
+        const std::lock_guard lock( mutex_ );
+
+        // Ёмкость могла стать нулевой, пока готовились копии.
+        if( capacity_ == 0 )
+            {
+                return;
+            }
+
+        ClearIfStale( generation );
+
+        const auto [ it, is_inserted ] = entries_.try_emplace( std::move( stored_key ) );
+
+        // Запись могла появиться, пока другой поток выполнял тот же запрос.
+        if( !is_inserted )
+            {
+                return;
+            }
+
+        recency_.push_front( &it->first );
+
+        it->second.documents = std::move( stored_documents );
+        it->second.recency_position = recency_.begin();
+
+        EvictToCapacity();
+    }
+
+void
+QueryResultCache::SetCapacity( const std::size_t capacity )
+    {
+        const std::lock_guard lock( mutex_ );
+
+        capacity_ = capacity;
+
+        EvictToCapacity();
+    }
+
+QueryResultCache::Stats
+QueryResultCache::GetStats() const
+    {
+        const std::lock_guard lock( mutex_ );
+
+        return stats_;
+    }
+
+void
+QueryResultCache::ClearIfStale( const std::uint64_t generation )
+    {
+        if( generation == generation_ )
+            {
+                return;
+            }
+
+        if( !entries_.empty() )
+            {
+                ++stats_.invalidations;
+            }
+
+        entries_.clear();
+        recency_.clear();
+
+        generation_ = generation;
+    }
+
+void
+QueryResultCache::EvictToCapacity()
+    {
+        while( entries_.size() > capacity_ )
+            {
+                entries_.erase( entries_.find( *recency_.back() ) );
+                recency_.pop_back();
+
+                ++stats_.evictions;
+            }
+    }
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+#include "term_dictionary.h"
+
+// Ограниченный кэш результатов поиска с вытеснением давно не использованных
+// записей (LRU).
+//
+// Ключ - разобранный запрос: упорядоченные плюс- и минус-слова без стоп-слов
+// и неизвестных словарю слов, фильтр по статусу и число результатов. Поэтому
+// запросы, которые отличаются порядком слов, повторами или стоп-словами,
+// попадают в одну запись. Записи действительны для одного поколения индекса:
+// при обращении с другим поколением кэш очищается.
+//
+// Потокобезопасен: запросы к серверу могут выполняться параллельно. Под
+// мьютексом выполняются только поиск и правка записей; документы хранятся
+// в неизменяемых разделяемых векторах и копируются вне блокировки.
+//
+// По умолчанию кэш выключен: включённый берёт общий мьютекс дважды на промах,
+// и при параллельных запросах без повторов это дороже самого поиска. Включать
+// его стоит для потока запросов, где одни и те же запросы повторяются.
+// Выключенный кэш стоит одного чтения атомарной ёмкости, без блокировки.
+class QueryResultCache
+    {
+
+        public:
+
+            static constexpr std::size_t DEFAULT_CAPACITY = 0;
+
+            // Ключ поиска можно собрать в арене запроса.
+            struct Key
+                {
+                    std::pmr::vector< TermId > plus_terms;
+                    std::pmr::vector< TermId > minus_terms;
+                    DocumentStatus status;
+                    std::size_t max_result_count;
+
+                    bool
+                    operator==( const Key & other ) const;
+                };
+
+            struct Stats
+                {
+                    std::uint64_t hits = 0;
+                    std::uint64_t misses = 0;
+
+                    // Записи, вытесненные из заполненного кэша.
+                    std::uint64_t evictions = 0;
+
+                    // Очистки кэша из-за смены поколения индекса.
+                    std::uint64_t invalidations = 0;
+                };
+
+            explicit QueryResultCache( const std::size_t capacity = DEFAULT_CAPACITY );
+
+            // Копия получает пустой кэш той же ёмкости: её результаты относились бы
+            // к индексу другого сервера. Перемещение переносит записи и статистику.
+            QueryResultCache( const QueryResultCache & other );
+
+            QueryResultCache( QueryResultCache && other );
+
+            QueryResultCache &
+            operator=( const QueryResultCache & ) = delete;
+
+            // Ёмкость не нулевая; проверяется без блокировки.
+            bool
+            IsEnabled() const;
+
+            // nullptr, если записи нет или кэш выключен.
+            std::shared_ptr< const std::vector< Document > >
+            Find(
+                    const Key & key,
+                    const std::uint64_t generation );
+
+            // Сохраняет копии ключа и документов в обычной памяти; копии готовятся
+            // до блокировки и ничего не копируется, если кэш выключен.
+            //
+            // Промах включённого кэша стоит копии ключа, копии найденных документов
+            // и одного make_shared в куче: при потоке неповторяющихся запросов кэш
+            // только добавляет работу, поэтому он и выключен по умолчанию.
+            void
+            Insert(
+                    const Key & key,
+                    const std::pmr::vector< Document > & documents,
+                    const std::uint64_t generation );
+
+            // Ёмкость 0 отключает кэш.
+            void
+            SetCapacity( const std::size_t capacity );
+
+            Stats
+            GetStats() const;
+
+        private:
+
+            struct KeyHash
+                {
+                    std::size_t
+                    operator()( const Key & key ) const;
+                };
+
+            struct Entry
+                {
+                    std::shared_ptr< const std::vector< Document > > documents;
+
+                    // Позиция ключа в recency_.
+                    std::list< const Key * >::iterator recency_position;
+                };
+
+            mutable std::mutex mutex_;
+
+            // Читается без блокировки, чтобы выключенный кэш ничего не копировал.
+            std::atomic< std::size_t > capacity_;
+
+            std::uint64_t generation_ = 0;
+
+            std::unordered_map< Key, Entry, KeyHash > entries_;
+
+            // Ключи записей от недавно использованных к давно использованным.
+            std::list< const Key * > recency_;
+
+            Stats stats_;
+
+            void
+            ClearIfStale( const std::uint64_t generation );
+
+            void
+            EvictToCapacity();
+    };
@@ -1,21 +1,102 @@
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
 #include "read_input_functions.h"
 
 std::string
 ReadLine()
+    {
+        return ReadLine( std::cin );
+    }
+
+std::string
+ReadLine( std::istream & input )
     {
         std::string s;
-        std::getline( std::cin, s );
+        std::getline( input, s );
         return s;
     }
 
 int
 ReadLineWithNumber()
+    {
+        return ReadLineWithNumber( std::cin );
+    }
+
+int
+ReadLineWithNumber( std::istream & input )
     {
         int result;
-        std::cin >> result;
-        ReadLine();
+        input >> result;
+        ReadLine( input );
         return result;
     }
 
+std::istream &
+operator>>(
+        std::istream & input,
+        DocumentRecord & record )
+    {
+        std::string header;
+
+        while(
+                header.empty()
+                &&
+                input )
+            {
+                header = ReadLine( input );
+            }
+
+        if( !input )
+            {
+                return input;
+            }
+
+        std::istringstream header_input( header );
+
+        int status = 0;
+        std::size_t rating_count = 0;
+
+        header_input >> record.id >> status >> rating_count;
+
+        if( header_input )
+            {
+                using namespace std::string_literals;
+
+                if(
+                        status < static_cast< int >( DocumentStatus::ACTUAL )
+                        ||
+                        status > static_cast< int >( DocumentStatus::REMOVED ) )
+                    {
+                        throw std::invalid_argument( "Неизвестный статус документа "s + std::to_string( status ) + "."s );
+                    }
+
+                // Средний рейтинг документа без оценок не определён.
+                if( rating_count == 0 )
+                    {
+                        throw std::invalid_argument( "У документа "s + std::to_string( record.id ) + " нет оценок."s );
+                    }
+
+                record.status = static_cast< DocumentStatus >( status );
+                record.ratings.clear();
+
+                for( int rating = 0; record.ratings.size() < rating_count && header_input >> rating; )
+                    {
+                        record.ratings.push_back( rating );
+                    }
+
+                record.text = ReadLine( input );
+            }
+
+        if(
+                !header_input
+                ||
+                !input )
+            {
+                input.clear( input.rdstate() & ~std::ios::eofbit );
+                input.setstate( std::ios::failbit );
+            }
+
+        return input;
+    }
@@ -1,10 +1,29 @@
 #pragma once
 
+#include <istream>
 #include <string>
 
+#include "document.h"
+
 std::string
 ReadLine();
 
+std::string
+ReadLine( std::istream & input );
+
 int
 ReadLineWithNumber();
 
+int
+ReadLineWithNumber( std::istream & input );
+
+// Читает запись документа из двух строк:
+//     <id> <статус> <число оценок> <оценки...>
+//     <текст документа>
+// Пустые строки перед записью пропускаются. При неверном формате
+// у потока выставляется failbit без eofbit; неизвестный статус и нулевое
+// число оценок - ошибка данных, а не формата: бросается invalid_argument.
+std::istream &
+operator>>(
+        std::istream & input,
+        DocumentRecord & record );
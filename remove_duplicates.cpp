@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+
+#include "remove_duplicates.h"
+
+namespace
+    {
+        using WordFreqs = std::map< std::string_view, double >;
+
+        // Отпечаток набора слов документа. Слова в WordFreqs упорядочены,
+        // поэтому одинаковые наборы всегда дают одинаковый отпечаток.
+        std::uint64_t
+        ComputeWordsFingerprint( const WordFreqs & word_freqs )
+            {
+                std::uint64_t fingerprint = word_freqs.size();
+
+                for( const auto & [ word, _ ] : word_freqs )
+                    {
+                        const std::uint64_t word_hash = std::hash< std::string_view >{}( word );
+
+                        fingerprint ^= word_hash + 0x9e3779b97f4a7c15ULL + ( fingerprint << 6 ) + ( fingerprint >> 2 );
+                    }
+
+                return fingerprint;
+            }
+
+        bool
+        HaveSameWords(
+                const WordFreqs & lhs,
+                const WordFreqs & rhs )
+            {
+                return
+                        std::equal(
+                                lhs.cbegin(),
+                                lhs.cend(),
+                                rhs.cbegin(),
+                                rhs.cend(),
+                                []( const auto & lhs_word_freq, const auto & rhs_word_freq )
+                                    {
+                                        return lhs_word_freq.first == rhs_word_freq.first;
+                                    } );
+            }
+    }
+
+std::vector< int >
+RemoveDuplicates( SearchServer & search_server )
+    {
+        // Документы с одинаковым отпечатком; при совпадении отпечатков
+        // наборы слов сравниваются явно, чтобы коллизия не удалила лишнего.
+        std::unordered_map< std::uint64_t, std::vector< int > > fingerprint_to_document_ids;
+
+        std::vector< int > duplicate_ids;
+
+        for( const int document_id : search_server )
+            {
+                const WordFreqs & word_freqs = search_server.GetWordFrequencies( document_id );
+
+                std::vector< int > & candidate_ids
+                                = fingerprint_to_document_ids[ ComputeWordsFingerprint( word_freqs ) ];
+
+                const bool is_duplicate = std::any_of(
+                        candidate_ids.cbegin(),
+                        candidate_ids.cend(),
+                        [&search_server, &word_freqs]( const int candidate_id )
+                            {
+                                return HaveSameWords( search_server.GetWordFrequencies( candidate_id ), word_freqs );
+                            } );
+
+                if( is_duplicate )
+                    {
+                        duplicate_ids.push_back( document_id );
+                    }
+                else
+                    {
+                        candidate_ids.push_back( document_id );
+                    }
+            }
+
+        search_server.RemoveDocuments( duplicate_ids );
+
+        return duplicate_ids;
+    }
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+
+#include "search_server.h"
+
+// Удаляет документы, набор слов которых совпадает с набором слов документа
+// с меньшим id. Возвращает id удалённых документов в порядке возрастания.
+// Дубликаты ищутся по отпечаткам наборов слов и удаляются одним пакетом
+// SearchServer::RemoveDocuments, поэтому время линейно по числу постингов.
+// Сервер, загруженный из снимка, не хранит слова документов: бросает std::logic_error.
+std::vector< int >
+RemoveDuplicates( SearchServer & search_server );
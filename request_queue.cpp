@@ -1,43 +1,183 @@
 #include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 
 #include "request_queue.h"
 
-RequestQueue::RequestQueue( const SearchServer & search_server )
+RequestQueue::Stats &
+RequestQueue::Stats::operator+=( const Stats & other )
+    {
+        request_count += other.request_count;
+        no_result_request_count += other.no_result_request_count;
+        result_count += other.result_count;
+
+        for( std::size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i )
+            {
+                latency_counts[ i ] += other.latency_counts[ i ];
+            }
+
+        return *this;
+    }
+
+RequestQueue::Stats &
+RequestQueue::Stats::operator-=( const Stats & other )
+    {
+        request_count -= other.request_count;
+        no_result_request_count -= other.no_result_request_count;
+        result_count -= other.result_count;
+
+        for( std::size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i )
+            {
+                latency_counts[ i ] -= other.latency_counts[ i ];
+            }
+
+        return *this;
+    }
+
+RequestQueue::RequestQueue(
+        const SearchServer & search_server,
+        const Clock::duration window,
+        std::function< Clock::time_point() > clock )
     :
-        server_( search_server )
-    {}
+          server_( search_server )
+        , slot_duration_( window / SLOT_COUNT )
+        , clock_( std::move( clock ) )
+    {
+        if( slot_duration_ <= Clock::duration::zero() )
+            {
+                using namespace std::string_literals;
+
+                throw std::invalid_argument(
+                        "Окно статистики должно быть не короче "s + std::to_string( SLOT_COUNT ) + " тактов часов."s );
+            }
+
+        for( Shard & shard : shards_ )
+            {
+                shard.slots.resize( SLOT_COUNT );
+            }
+    }
+
+std::vector< Document >
+RequestQueue::AddFindRequest(
+        const std::string_view raw_query )
+    {
+        return AddFindRequest( raw_query, DocumentStatus::ACTUAL );
+    }
 
 int
 RequestQueue::GetNoResultRequests() const
     {
-        const int number_of_no_result_requests = std::count_if(
-                requests_.cbegin(),
-                requests_.cend(),
-                []( const QueryResult & query ){ return !query.has_result; } );
+        return static_cast< int >( GetStats().no_result_request_count );
+    }
+
+RequestQueue::Stats
+RequestQueue::GetStats() const
+    {
+        const std::int64_t tick = GetTick( clock_() );
+
+        Stats stats;
+
+        for( Shard & shard : shards_ )
+            {
+                const std::lock_guard lock( shard.mutex );
 
-        return number_of_no_result_requests;
+                AdvanceWindow( shard, tick );
+
+                stats += shard.totals;
+            }
+
+        return stats;
     }
 
 void
 RequestQueue::UpdateRequestsResultInfo(
-        const std::vector< Document > & found_documents )
+        const std::vector< Document > & found_documents,
+        const Clock::duration latency )
     {
-        if( requests_.size() == sec_in_day_ )
+        const std::int64_t tick = GetTick( clock_() );
+
+        Shard & shard = GetCurrentThreadShard();
+
+        const std::lock_guard lock( shard.mutex );
+
+        AdvanceWindow( shard, tick );
+
+        // Время запроса взято до блокировки: другой поток мог успеть сдвинуть окно.
+        // Запрос, чей интервал уже вышел из окна, не учитывается.
+        if( tick <= shard.last_tick - static_cast< std::int64_t >( SLOT_COUNT ) )
             {
-                requests_.pop_front();
+                return;
             }
 
-        requests_.push_back( { !found_documents.empty() } );
+        Stats request_stats;
+        request_stats.request_count = 1;
+        request_stats.no_result_request_count = found_documents.empty() ? 1 : 0;
+        request_stats.result_count = found_documents.size();
+        request_stats.latency_counts[ GetLatencyBucket( latency ) ] = 1;
+
+        shard.slots[ tick % SLOT_COUNT ] += request_stats;
+        shard.totals += request_stats;
     }
 
-std::vector< Document >
-RequestQueue::AddFindRequest(
-        const std::string & raw_query )
+std::int64_t
+RequestQueue::GetTick( const Clock::time_point time ) const
+    {
+        return std::max< std::int64_t >( time.time_since_epoch() / slot_duration_, 0 );
+    }
+
+void
+RequestQueue::AdvanceWindow(
+        Shard & shard,
+        const std::int64_t tick )
+    {
+        if( tick <= shard.last_tick )
+            {
+                return;
+            }
+
+        // Окно сдвинулось не меньше чем на свою длину: все интервалы вышли из него.
+        if( tick - shard.last_tick >= static_cast< std::int64_t >( SLOT_COUNT ) )
+            {
+                std::fill( shard.slots.begin(), shard.slots.end(), Stats() );
+
+                shard.totals = {};
+            }
+        else
+            {
+                for( std::int64_t expired_tick = shard.last_tick + 1; expired_tick <= tick; ++expired_tick )
+                    {
+                        Stats & slot = shard.slots[ expired_tick % SLOT_COUNT ];
+
+                        shard.totals -= slot;
+                        slot = {};
+                    }
+            }
+
+        shard.last_tick = tick;
+    }
+
+std::size_t
+RequestQueue::GetLatencyBucket( const Clock::duration latency )
     {
-        const std::vector< Document > found_documents = server_.FindTopDocuments( raw_query );
+        auto microseconds = std::chrono::duration_cast< std::chrono::microseconds >( latency ).count();
+
+        std::size_t bucket = 0;
 
-        UpdateRequestsResultInfo( found_documents );
+        while(
+                microseconds > 0
+                &&
+                bucket + 1 < LATENCY_BUCKET_COUNT )
+            {
+                microseconds >>= 1;
+                ++bucket;
+            }
 
-        return found_documents;
+        return bucket;
     }
 
+RequestQueue::Shard &
+RequestQueue::GetCurrentThreadShard() const
+    {
+        return shards_[ std::hash< std::thread::id >()( std::this_thread::get_id() ) % SHARD_COUNT ];
+    }
@@ -1,52 +1,133 @@
 #pragma once
 
-#include <deque>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "search_server.h"
 
+// Статистика запросов к серверу за скользящее окно времени, по умолчанию - сутки.
+//
+// Окно разбито на SLOT_COUNT интервалов. Для каждого интервала хранятся счётчики
+// его запросов, а итоги окна поддерживаются на ходу: при сдвиге окна из них
+// вычитаются счётчики вышедших интервалов. Поэтому запрос статистики стоит O( 1 ),
+// а запись запроса не выделяет памяти.
+//
+// AddFindRequest можно вызывать из нескольких потоков: каждый поток пишет в одну
+// из SHARD_COUNT частей со своим мьютексом, а статистика складывается по частям.
 class RequestQueue
     {
+
         public:
 
-            explicit RequestQueue( const SearchServer & search_server );
+            using Clock = std::chrono::steady_clock;
+
+            static constexpr std::size_t SLOT_COUNT = 1440;
+
+            static constexpr std::size_t SHARD_COUNT = 4;
+
+            // Бакет 0 - запросы быстрее микросекунды, бакет i - от 2^( i - 1 ) до 2^i мкс,
+            // последний бакет - все более долгие запросы.
+            static constexpr std::size_t LATENCY_BUCKET_COUNT = 20;
+
+            struct Stats
+                {
+                    std::uint64_t request_count = 0;
+                    std::uint64_t no_result_request_count = 0;
+
+                    // Сумма числа найденных документов по запросам.
+                    std::uint64_t result_count = 0;
+
+                    std::array< std::uint64_t, LATENCY_BUCKET_COUNT > latency_counts{};
+
+                    Stats &
+                    operator+=( const Stats & other );
+
+                    Stats &
+                    operator-=( const Stats & other );
+                };
+
+            // clock задаёт время запросов; его можно подменить, например для
+            // воспроизводимого журнала. Время выполнения запроса всегда измеряется по Clock.
+            explicit RequestQueue(
+                    const SearchServer & search_server,
+                    const Clock::duration window = std::chrono::hours( 24 ),
+                    std::function< Clock::time_point() > clock = Clock::now );
 
             template < typename SearchParameter >
             std::vector< Document >
             AddFindRequest(
-                    const std::string & raw_query,
+                    const std::string_view raw_query,
                     const SearchParameter search_parameter )
                 {
-                    const std::vector< Document > found_documents
+                    const Clock::time_point start = Clock::now();
+
+                    std::vector< Document > found_documents
                                     = server_.FindTopDocuments( raw_query, search_parameter );
 
-                    UpdateRequestsResultInfo( found_documents );
+                    UpdateRequestsResultInfo( found_documents, Clock::now() - start );
 
                     return found_documents;
                 }
 
             std::vector< Document >
-            AddFindRequest( const std::string & raw_query );
+            AddFindRequest( const std::string_view raw_query );
 
             int
             GetNoResultRequests() const;
 
+            // Итоги запросов, попавших в окно.
+            Stats
+            GetStats() const;
+
 
         private:
 
-            struct QueryResult
+            struct Shard
                 {
-                    const bool has_result = false;
-                };
+                    std::mutex mutex;
 
-            std::deque< QueryResult > requests_;
+                    // Счётчики интервала с номером tick хранятся в slots[ tick % SLOT_COUNT ].
+                    std::vector< Stats > slots;
 
-            static constexpr int sec_in_day_ = 1440;
+                    // Сумма slots: итоги окна, которое заканчивается интервалом last_tick.
+                    Stats totals;
+
+                    std::int64_t last_tick = -1;
+                };
 
             const SearchServer & server_;
 
+            const Clock::duration slot_duration_;
+
+            const std::function< Clock::time_point() > clock_;
+
+            mutable std::array< Shard, SHARD_COUNT > shards_;
+
             void
             UpdateRequestsResultInfo(
-                    const std::vector< Document > & found_documents );
-    };
+                    const std::vector< Document > & found_documents,
+                    const Clock::duration latency );
 
+            std::int64_t
+            GetTick( const Clock::time_point time ) const;
 
+            // Сдвигает окно части так, чтобы оно заканчивалось интервалом tick;
+            // tick - номер интервала от начала отсчёта Clock.
+            static void
+            AdvanceWindow(
+                    Shard & shard,
+                    const std::int64_t tick );
+
+            static std::size_t
+            GetLatencyBucket( const Clock::duration latency );
+
+            Shard &
+            GetCurrentThreadShard() const;
+    };
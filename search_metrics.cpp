@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <utility>
+
+#include "search_metrics.h"
+
+std::uint64_t
+LatencyHistogram::Snapshot::GetPercentile( const double fraction ) const
+    {
+        if( count == 0 )
+            {
+                return 0;
+            }
+
+        const std::uint64_t rank = std::max< std::uint64_t >(
+                1,
+                static_cast< std::uint64_t >( fraction * count + 0.5 ) );
+
+        std::uint64_t seen = 0;
+
+        for( std::size_t bucket = 0; bucket < counts.size(); ++bucket )
+            {
+                seen += counts[ bucket ];
+
+                if( seen >= rank )
+                    {
+                        return std::min( GetBucketUpperBound( bucket ), max_nanoseconds );
+                    }
+            }
+
+        return max_nanoseconds;
+    }
+
+void
+LatencyHistogram::Record( const std::uint64_t nanoseconds )
+    {
+        counts_[ GetBucket( nanoseconds ) ].fetch_add( 1, std::memory_order_relaxed );
+        total_nanoseconds_.fetch_add( nanoseconds, std::memory_order_relaxed );
+
+        std::uint64_t max_nanoseconds = max_nanoseconds_.load( std::memory_order_relaxed );
+
+        while(
+                nanoseconds > max_nanoseconds
+                &&
+                !max_nanoseconds_.compare_exchange_weak( max_nanoseconds, nanoseconds, std::memory_order_relaxed ) )
+            {}
+    }
+
+LatencyHistogram::Snapshot
+LatencyHistogram::GetSnapshot() const
+    {
+        Snapshot snapshot;
+        snapshot.counts.resize( BUCKET_COUNT );
+
+        for( std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket )
+            {
+                snapshot.counts[ bucket ] = counts_[ bucket ].load( std::memory_order_relaxed );
+                snapshot.count += snapshot.counts[ bucket ];
+            }
+
+        snapshot.total_nanoseconds = total_nanoseconds_.load( std::memory_order_relaxed );
+        snapshot.max_nanoseconds = max_nanoseconds_.load( std::memory_order_relaxed );
+
+        return snapshot;
+    }
+
+void
+LatencyHistogram::Reset()
+    {
+        for( std::atomic< std::uint64_t > & count : counts_ )
+            {
+                count.store( 0, std::memory_order_relaxed );
+            }
+
+        total_nanoseconds_.store( 0, std::memory_order_relaxed );
+        max_nanoseconds_.store( 0, std::memory_order_relaxed );
+    }
+
+std::size_t
+LatencyHistogram::GetBucket( const std::uint64_t nanoseconds )
+    {
+        if( nanoseconds < SUB_BUCKET_COUNT )
+            {
+                return static_cast< std::size_t >( nanoseconds );
+            }
+
+        // Номер старшего единичного бита.
+#if defined( __GNUC__ )
+        const std::size_t exponent = 63 - __builtin_clzll( nanoseconds );
+#else
+        std::size_t exponent = 0;
+
+        for( std::uint64_t value = nanoseconds; value > 1; value >>= 1 )
+            {
+                ++exponent;
+            }
+#endif
+
+        const std::size_t shift = exponent - SUB_BUCKET_BITS;
+        const std::size_t sub_bucket = ( nanoseconds >> shift ) & ( SUB_BUCKET_COUNT - 1 );
+
+        return ( shift + 1 ) * SUB_BUCKET_COUNT + sub_bucket;
+    }
+
+std::uint64_t
+LatencyHistogram::GetBucketUpperBound( const std::size_t bucket )
+    {
+        if( bucket < SUB_BUCKET_COUNT )
+            {
+                return bucket;
+            }
+
+        const std::size_t shift = bucket / SUB_BUCKET_COUNT - 1;
+        const std::uint64_t lower_bound = ( SUB_BUCKET_COUNT + bucket % SUB_BUCKET_COUNT ) << shift;
+
+        return lower_bound + ( ( std::uint64_t{ 1 } << shift ) - 1 );
+    }
+
+const LatencyHistogram::Snapshot &
+SearchMetrics::Snapshot::GetStage( const Stage stage ) const
+    {
+        return stages[ static_cast< std::size_t >( stage ) ];
+    }
+
+std::uint64_t
+SearchMetrics::Snapshot::GetCounter( const Counter counter ) const
+    {
+        return counters[ static_cast< std::size_t >( counter ) ];
+    }
+
+SearchMetrics::SearchMetrics()
+    :
+        state_( std::make_unique< State >() )
+    {}
+
+SearchMetrics::SearchMetrics( const SearchMetrics & other )
+    :
+        state_( std::make_unique< State >() )
+    {
+        SetEnabled( other.state_->is_enabled.load( std::memory_order_relaxed ) );
+    }
+
+SearchMetrics::SearchMetrics( SearchMetrics && other )
+    :
+        state_( std::exchange( other.state_, std::make_unique< State >() ) )
+    {}
+
+void
+SearchMetrics::SetEnabled( const bool is_enabled )
+    {
+        state_->is_enabled.store( is_enabled, std::memory_order_relaxed );
+    }
+
+SearchMetrics::Snapshot
+SearchMetrics::GetSnapshot() const
+    {
+        Snapshot snapshot;
+
+        for( std::size_t stage = 0; stage < STAGE_COUNT; ++stage )
+            {
+                snapshot.stages[ stage ] = state_->stages[ stage ].GetSnapshot();
+            }
+
+        for( std::size_t counter = 0; counter < COUNTER_COUNT; ++counter )
+            {
+                snapshot.counters[ counter ] = state_->counters[ counter ].load( std::memory_order_relaxed );
+            }
+
+        return snapshot;
+    }
+
+void
+SearchMetrics::Reset()
+    {
+        for( LatencyHistogram & stage : state_->stages )
+            {
+                stage.Reset();
+            }
+
+        for( std::atomic< std::uint64_t > & counter : state_->counters )
+            {
+                counter.store( 0, std::memory_order_relaxed );
+            }
+    }
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Гистограмма длительностей в наносекундах с логарифмическими бакетами, как в HDR
+// Histogram: значения до 8 хранятся точно, далее каждая степень двойки делится на
+// 8 бакетов, и погрешность значения не превышает 12,5 %. Запись - одно атомарное
+// сложение без блокировок, поэтому писать могут несколько потоков сразу.
+class LatencyHistogram
+    {
+
+        public:
+
+            static constexpr std::size_t SUB_BUCKET_BITS = 3;
+
+            static constexpr std::size_t SUB_BUCKET_COUNT = std::size_t{ 1 } << SUB_BUCKET_BITS;
+
+            // Покрывает все значения std::uint64_t.
+            static constexpr std::size_t BUCKET_COUNT = ( 64 - SUB_BUCKET_BITS + 1 ) * SUB_BUCKET_COUNT;
+
+            struct Snapshot
+                {
+                    std::vector< std::uint64_t > counts;
+
+                    std::uint64_t count = 0;
+                    std::uint64_t total_nanoseconds = 0;
+                    std::uint64_t max_nanoseconds = 0;
+
+                    // Верхняя граница бакета, в который попадает доля fraction значений.
+                    std::uint64_t
+                    GetPercentile( const double fraction ) const;
+                };
+
+            void
+            Record( const std::uint64_t nanoseconds );
+
+            Snapshot
+            GetSnapshot() const;
+
+            void
+            Reset();
+
+            static std::size_t
+            GetBucket( const std::uint64_t nanoseconds );
+
+            static std::uint64_t
+            GetBucketUpperBound( const std::size_t bucket );
+
+        private:
+
+            std::array< std::atomic< std::uint64_t >, BUCKET_COUNT > counts_{};
+
+            std::atomic< std::uint64_t > total_nanoseconds_{ 0 };
+
+            std::atomic< std::uint64_t > max_nanoseconds_{ 0 };
+    };
+
+// Метрики поиска: время этапов запроса и счётчики работы. Выключены по умолчанию;
+// выключенные стоят одного чтения атомарного флага на этап, а при сборке
+// с SEARCH_METRICS_DISABLED код учёта не компилируется вовсе.
+class SearchMetrics
+    {
+
+        public:
+
+            enum class Stage
+                {
+                    // Разбор запроса и поиск его слов в словаре.
+                    PARSE_QUERY,
+
+                    // Обход постингов с IDF, предикатом и минус-словами.
+                    SCORE_DOCUMENTS,
+
+                    // Перенос релевантностей в вектор Document с рейтингами.
+                    COLLECT_DOCUMENTS,
+
+                    // Упорядочивание и отбор лучших документов.
+                    SELECT_TOP_DOCUMENTS,
+                };
+
+            static constexpr std::size_t STAGE_COUNT = 4;
+
+            enum class Counter
+                {
+                    // Постинги плюс- и минус-слов, пройденные при оценке.
+                    POSTINGS_SCANNED,
+
+                    // Документы, получившие релевантность.
+                    DOCUMENTS_SCORED,
+
+                    // Документы с минус-словами, исключённые до оценки.
+                    DOCUMENTS_EXCLUDED,
+                };
+
+            static constexpr std::size_t COUNTER_COUNT = 3;
+
+            struct Snapshot
+                {
+                    std::array< LatencyHistogram::Snapshot, STAGE_COUNT > stages;
+
+                    std::array< std::uint64_t, COUNTER_COUNT > counters{};
+
+                    const LatencyHistogram::Snapshot &
+                    GetStage( const Stage stage ) const;
+
+                    std::uint64_t
+                    GetCounter( const Counter counter ) const;
+                };
+
+            // Замеряет этап от создания до разрушения, если метрики включены.
+            class StageTimer
+                {
+
+                    public:
+
+                        StageTimer(
+                                const SearchMetrics & metrics,
+                                const Stage stage );
+
+                        StageTimer( const StageTimer & ) = delete;
+
+                        StageTimer &
+                        operator=( const StageTimer & ) = delete;
+
+                        ~StageTimer();
+
+                        // Завершает замер раньше конца области видимости.
+                        void
+                        Stop();
+
+                    private:
+
+                        const SearchMetrics & metrics_;
+
+                        const Stage stage_;
+
+                        bool is_running_;
+
+                        std::chrono::steady_clock::time_point start_;
+                };
+
+            SearchMetrics();
+
+            // Копия начинает учёт с нуля, с тем же состоянием включения.
+            SearchMetrics( const SearchMetrics & other );
+
+            // Перемещённый объект получает новое выключенное состояние и остаётся
+            // пригодным: перемещённый сервер продолжает вызывать метрики.
+            SearchMetrics( SearchMetrics && other );
+
+            SearchMetrics &
+            operator=( const SearchMetrics & ) = delete;
+
+            bool
+            IsEnabled() const;
+
+            void
+            SetEnabled( const bool is_enabled );
+
+            void
+            Add(
+                    const Counter counter,
+                    const std::uint64_t value ) const;
+
+            Snapshot
+            GetSnapshot() const;
+
+            void
+            Reset();
+
+        private:
+
+            struct State
+                {
+                    std::atomic< bool > is_enabled{ false };
+
+                    std::array< LatencyHistogram, STAGE_COUNT > stages;
+
+                    std::array< std::atomic< std::uint64_t >, COUNTER_COUNT > counters{};
+                };
+
+            // Отдельный объект: атомарные поля не перемещаются, а сервер перемещаемый.
+            std::unique_ptr< State > state_;
+    };
+
+inline bool
+SearchMetrics::IsEnabled() const
+    {
+#if defined( SEARCH_METRICS_DISABLED )
+        return false;
+#else
+        return state_->is_enabled.load( std::memory_order_relaxed );
+#endif
+    }
+
+inline
+SearchMetrics::StageTimer::StageTimer(
+        const SearchMetrics & metrics,
+        const Stage stage )
+    :
+          metrics_( metrics )
+        , stage_( stage )
+        , is_running_( metrics.IsEnabled() )
+    {
+        if( is_running_ )
+            {
+                start_ = std::chrono::steady_clock::now();
+            }
+    }
+
+inline
+SearchMetrics::StageTimer::~StageTimer()
+    {
+        Stop();
+    }
+
+inline void
+SearchMetrics::StageTimer::Stop()
+    {
+        if( is_running_ )
+            {
+                const auto elapsed = std::chrono::steady_clock::now() - start_;
+
+                metrics_.state_->stages[ static_cast< std::size_t >( stage_ ) ].Record(
+                        std::chrono::duration_cast< std::chrono::nanoseconds >( elapsed ).count() );
+
+                is_running_ = false;
+            }
+    }
+
+inline void
+SearchMetrics::Add(
+        const Counter counter,
+        const std::uint64_t value ) const
+    {
+        if( IsEnabled() )
+            {
+                state_->counters[ static_cast< std::size_t >( counter ) ].fetch_add( value, std::memory_order_relaxed );
+            }
+    }
@@ -3,71 +3,497 @@
 #include <iterator>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 
 #include "search_server.h"
 #include "string_processing.h"
 
-SearchServer::SearchServer( const std::string & stop_words_text )
+namespace
+    {
+        TermDictionary
+        MapSnapshotTerms( const IndexSnapshot & snapshot )
+            {
+                const SnapshotCounts & counts = snapshot.GetCounts();
+
+                const std::uint64_t * word_offsets = snapshot.GetSection< std::uint64_t >(
+                        SnapshotSection::WORD_OFFSETS,
+                        counts.term_count + 1 );
+
+                return
+                        TermDictionary(
+                                word_offsets,
+                                snapshot.GetSection< char >(
+                                        SnapshotSection::WORD_CHARS,
+                                        word_offsets[ counts.term_count ] ),
+                                static_cast< TermId >( counts.term_count ),
+                                static_cast< TermId >( counts.stop_term_count ) );
+            }
+
+        InvertedIndex
+        MapSnapshotIndex( const IndexSnapshot & snapshot )
+            {
+                const SnapshotCounts & counts = snapshot.GetCounts();
+
+                return
+                        InvertedIndex(
+                                snapshot.GetSection< std::uint64_t >(
+                                        SnapshotSection::POSTING_OFFSETS,
+                                        counts.term_count + 1 ),
+                                snapshot.GetSection< int >(
+                                        SnapshotSection::POSTING_DOCUMENT_IDS,
+                                        counts.posting_count ),
+                                snapshot.GetSection< double >(
+                                        SnapshotSection::POSTING_TERM_FREQS,
+                                        counts.posting_count ),
+                                counts.term_count );
+            }
+
+        DocumentStore
+        MapSnapshotDocuments( const IndexSnapshot & snapshot )
+            {
+                const SnapshotCounts & counts = snapshot.GetCounts();
+
+                return
+                        DocumentStore(
+                                snapshot.GetSection< int >(
+                                        SnapshotSection::DOCUMENT_IDS,
+                                        counts.document_count ),
+                                snapshot.GetSection< int >(
+                                        SnapshotSection::DOCUMENT_RATINGS,
+                                        counts.document_count ),
+                                snapshot.GetSection< DocumentStatus >(
+                                        SnapshotSection::DOCUMENT_STATUSES,
+                                        counts.document_count ),
+                                counts.document_count );
+            }
+
+        template < typename T >
+        void
+        WriteSnapshotSection(
+                IndexSnapshotWriter & writer,
+                const SnapshotSection section,
+                const std::vector< T > & values )
+            {
+                writer.BeginSection( section );
+                writer.Write( values.data(), values.size() );
+                writer.EndSection();
+            }
+    }
+
+SearchServer::SearchServer(
+        const std::string & stop_words_text,
+        const PostingsFormat postings_format )
     :
-        SearchServer( SplitIntoWords( stop_words_text ) )
+        SearchServer( std::string_view( stop_words_text ), postings_format )
     {}
 
+SearchServer::SearchServer(
+        const std::string_view stop_words_text,
+        const PostingsFormat postings_format )
+    :
+        SearchServer( SplitIntoWords( stop_words_text ), postings_format )
+    {}
+
+SearchServer::SearchServer( const SearchServer & other )
+    :
+          terms_( other.terms_ )
+        , stop_term_count_( other.stop_term_count_ )
+        , index_( other.index_ )
+        , documents_( other.documents_ )
+        , snapshot_( other.snapshot_ )
+        , query_cache_( other.query_cache_ )
+        , inverse_document_freqs_( other.inverse_document_freqs_ )
+        , metrics_( other.metrics_ )
+    {
+        for( const auto & [ document_id, other_word_freqs ] : other.document_to_word_freqs_ )
+            {
+                std::map< std::string_view, double > & word_freqs = document_to_word_freqs_.emplace_hint(
+                        document_to_word_freqs_.cend(),
+                        document_id,
+                        std::map< std::string_view, double >() )->second;
+
+                for( const auto & [ word, term_freq ] : other_word_freqs )
+                    {
+                        word_freqs.emplace_hint( word_freqs.cend(), terms_.GetWord( terms_.Find( word ) ), term_freq );
+                    }
+            }
+    }
+
+SearchServer::SearchServer( SearchServer && other )
+    :
+          terms_( std::move( other.terms_ ) )
+        , stop_term_count_( other.stop_term_count_ )
+        , index_( std::move( other.index_ ) )
+        , document_to_word_freqs_( std::exchange( other.document_to_word_freqs_, {} ) )
+        , documents_( std::move( other.documents_ ) )
+        , snapshot_( std::move( other.snapshot_ ) )
+        , index_generation_( other.index_generation_ )
+        , query_cache_( std::move( other.query_cache_ ) )
+        , inverse_document_freqs_( std::move( other.inverse_document_freqs_ ) )
+        , metrics_( std::move( other.metrics_ ) )
+    {
+        // Стоп-слова получают в словаре источника прежние id [0; stop_term_count_).
+        for( TermId term = 0; term < stop_term_count_; ++term )
+            {
+                other.terms_.Intern( terms_.GetWord( term ) );
+            }
+
+        other.OnIndexChanged();
+    }
+
+SearchServer::SearchServer( std::shared_ptr< const IndexSnapshot > snapshot )
+    :
+          terms_( MapSnapshotTerms( *snapshot ) )
+        , stop_term_count_( static_cast< TermId >( snapshot->GetCounts().stop_term_count ) )
+        , index_( MapSnapshotIndex( *snapshot ) )
+        , documents_( MapSnapshotDocuments( *snapshot ) )
+        , snapshot_( std::move( snapshot ) )
+    {
+        inverse_document_freqs_.Resize( terms_.size() );
+    }
+
 void
 SearchServer::AddDocument(
         const int document_id,
-        const std::string & document,
+        const std::string_view document,
         const DocumentStatus status,
         const std::vector< int > & ratings )
     {
-        if( document_id < 0 )
+        ThrowIfSnapshot();
+
+        ValidateDocumentId( document_id );
+
+        const InvertedIndex::TermFreqs term_freqs = InvertedIndex::ComputeTermFreqs( SplitIntoTermsNoStop( document ) );
+
+        index_.AddDocument( document_id, term_freqs );
+
+        std::map< std::string_view, double > & word_freqs = document_to_word_freqs_[ document_id ];
+
+        for( const auto & [ term, term_freq ] : term_freqs )
             {
-                using namespace std::string_literals;
+                word_freqs.emplace( terms_.GetWord( term ), term_freq );
+            }
 
-                throw std::invalid_argument(
-                        "Попытка добавить документ с отрицательным id."s );
+        documents_.Add( document_id, ComputeAverageRating( ratings ), status );
+
+        OnIndexChanged();
+    }
+
+void
+SearchServer::AddDocumentFrom(
+        const SearchServer & source,
+        const int document_id )
+    {
+        ThrowIfSnapshot();
+
+        ValidateDocumentId( document_id );
+
+        const std::size_t source_ordinal = source.GetDocumentOrdinal( document_id );
+
+        InvertedIndex::TermFreqs term_freqs;
+
+        for( const auto & [ word, term_freq ] : source.GetWordFrequencies( document_id ) )
+            {
+                term_freqs.emplace_back( terms_.Intern( word ), term_freq );
+            }
+
+        std::sort( term_freqs.begin(), term_freqs.end() );
+
+        index_.AddDocument( document_id, term_freqs );
+
+        std::map< std::string_view, double > & word_freqs = document_to_word_freqs_[ document_id ];
+
+        for( const auto & [ term, term_freq ] : term_freqs )
+            {
+                word_freqs.emplace( terms_.GetWord( term ), term_freq );
             }
 
-        if( documents_.count( document_id ) )
+        documents_.Add(
+                document_id,
+                source.documents_.GetRating( source_ordinal ),
+                source.documents_.GetStatus( source_ordinal ) );
+
+        OnIndexChanged();
+    }
+
+void
+SearchServer::AddDocuments( std::istream & input )
+    {
+        AddDocuments(
+                std::istream_iterator< DocumentRecord >( input ),
+                std::istream_iterator< DocumentRecord >() );
+
+        if(
+                input.fail()
+                &&
+                !input.eof() )
             {
                 using namespace std::string_literals;
 
-                throw std::invalid_argument(
-                        "Попытка добавить документ c id ранее добавленного документа."s );
+                throw std::invalid_argument( "Неверный формат записи документа."s );
+            }
+    }
+
+void
+SearchServer::SaveSnapshot( const std::string & path ) const
+    {
+        // Слова нумеруются заново: сначала стоп-слова, затем слова, встречающиеся
+        // хотя бы в одном документе, каждая группа по алфавиту. Так в снимке
+        // слово ищется двоичным поиском, а стоп-слова по-прежнему имеют id [0; stop_term_count).
+        const auto by_word = [this]( const TermId lhs, const TermId rhs )
+            {
+                return terms_.GetWord( lhs ) < terms_.GetWord( rhs );
+            };
+
+        std::vector< TermId > terms( stop_term_count_ );
+        std::iota( terms.begin(), terms.end(), 0 );
+        std::sort( terms.begin(), terms.end(), by_word );
+
+        for( TermId term = stop_term_count_; term < terms_.size(); ++term )
+            {
+                if( index_.GetDocumentFreq( term ) > 0 )
+                    {
+                        terms.push_back( term );
+                    }
             }
 
-        const std::vector< std::string > document_words = SplitIntoWordsNoStop( document );
+        std::sort( std::next( terms.begin(), stop_term_count_ ), terms.end(), by_word );
 
-        const double inv_word_count = 1.0 / document_words.size();
+        std::vector< std::uint64_t > word_offsets = { 0 };
+        std::vector< std::uint64_t > posting_offsets = { 0 };
+        std::string word_chars;
+        std::vector< int > posting_document_ids;
+        std::vector< double > posting_term_freqs;
 
-        for( const std::string & word : document_words )
+        for( const TermId term : terms )
             {
-                word_to_document_freqs_[ word ][ document_id ] += inv_word_count;
+                word_chars += terms_.GetWord( term );
+                word_offsets.push_back( word_chars.size() );
+
+                index_.ForEachPosting(
+                        term,
+                        [&posting_document_ids, &posting_term_freqs]( const int document_id, const double term_freq )
+                            {
+                                posting_document_ids.push_back( document_id );
+                                posting_term_freqs.push_back( term_freq );
+                            } );
+
+                posting_offsets.push_back( posting_document_ids.size() );
             }
 
-        documents_.emplace(
-                document_id,
-                DocumentData
-                    {
-                        ComputeAverageRating( ratings ),
+        // Отмеченные удалёнными документы в снимок не попадают.
+        DocumentStore documents = documents_;
+        documents.Compact();
+
+        IndexSnapshotWriter writer( path );
+
+        WriteSnapshotSection( writer, SnapshotSection::WORD_OFFSETS, word_offsets );
+
+        writer.BeginSection( SnapshotSection::WORD_CHARS );
+        writer.Write( word_chars.data(), word_chars.size() );
+        writer.EndSection();
+
+        WriteSnapshotSection( writer, SnapshotSection::POSTING_OFFSETS, posting_offsets );
+        WriteSnapshotSection( writer, SnapshotSection::POSTING_DOCUMENT_IDS, posting_document_ids );
+        WriteSnapshotSection( writer, SnapshotSection::POSTING_TERM_FREQS, posting_term_freqs );
+
+        writer.BeginSection( SnapshotSection::DOCUMENT_IDS );
+        writer.Write( documents.GetIds(), documents.size() );
+        writer.EndSection();
+
+        writer.BeginSection( SnapshotSection::DOCUMENT_RATINGS );
+        writer.Write( documents.GetRatings(), documents.size() );
+        writer.EndSection();
+
+        writer.BeginSection( SnapshotSection::DOCUMENT_STATUSES );
+        writer.Write( documents.GetStatuses(), documents.size() );
+        writer.EndSection();
+
+        writer.Finish(
+                {
+                    terms.size(),
+                    stop_term_count_,
+                    posting_document_ids.size(),
+                    documents.size()
+                } );
+    }
+
+SearchServer
+SearchServer::LoadSnapshot( const std::string & path )
+    {
+        return SearchServer( std::make_shared< const IndexSnapshot >( path ) );
+    }
+
+std::vector< Document >
+SearchServer::FindTopDocuments(
+        const std::string_view raw_query,
+        const DocumentStatus status,
+        const std::size_t max_result_count ) const
+    {
+        return FindTopDocuments( std::execution::seq, raw_query, status, max_result_count );
+    }
+
+std::size_t
+SearchServer::FindTopDocumentsInto(
+        const std::string_view raw_query,
+        const DocumentStatus status,
+        const std::size_t max_result_count,
+        Document * const output ) const
+    {
+        return
+                FindTopDocumentsCached(
+                        std::execution::seq,
+                        raw_query,
                         status,
-                    } );
+                        max_result_count,
+                        [output]( const auto first, const auto last )
+                            {
+                                return static_cast< std::size_t >( std::copy( first, last, output ) - output );
+                            } );
     }
 
 std::vector< Document >
 SearchServer::FindTopDocuments(
-        const std::string & raw_query,
-        const DocumentStatus status ) const
+        const QueryMode mode,
+        const std::string_view raw_query,
+        const DocumentStatus status,
+        const std::size_t max_result_count ) const
     {
+        if( mode == QueryMode::EXHAUSTIVE )
+            {
+                return FindTopDocuments( raw_query, status, max_result_count );
+            }
+
         return
                 FindTopDocuments(
+                        mode,
                         raw_query,
-                        [status](
-                                const int document_id,
-                                const DocumentStatus document_status,
-                                const int rating )
+                        MakeStatusPredicate( status ),
+                        max_result_count );
+    }
+
+void
+SearchServer::SetQueryCacheCapacity( const std::size_t capacity )
+    {
+        query_cache_.SetCapacity( capacity );
+    }
+
+QueryResultCache::Stats
+SearchServer::GetQueryCacheStats() const
+    {
+        return query_cache_.GetStats();
+    }
+
+void
+SearchServer::SetMetricsEnabled( const bool is_enabled )
+    {
+        metrics_.SetEnabled( is_enabled );
+    }
+
+SearchMetrics::Snapshot
+SearchServer::GetMetrics() const
+    {
+        return metrics_.GetSnapshot();
+    }
+
+void
+SearchServer::ResetMetrics()
+    {
+        metrics_.Reset();
+    }
+
+void
+SearchServer::RemoveDocument( const int document_id )
+    {
+        RemoveDocument( std::execution::seq, document_id );
+    }
+
+void
+SearchServer::RemoveDocuments( std::vector< int > document_ids )
+    {
+        ThrowIfSnapshot();
+
+        std::sort( document_ids.begin(), document_ids.end() );
+        document_ids.erase( std::unique( document_ids.begin(), document_ids.end() ), document_ids.end() );
+
+        document_ids.erase(
+                std::remove_if(
+                        document_ids.begin(),
+                        document_ids.end(),
+                        [this]( const int document_id )
                             {
-                                return document_status == status;
-                            } );
+                                return document_to_word_freqs_.count( document_id ) == 0;
+                            } ),
+                document_ids.end() );
+
+        if( document_ids.empty() )
+            {
+                return;
+            }
+
+        // Документы обходятся по возрастанию id, поэтому id у каждого слова упорядочены.
+        std::unordered_map< TermId, std::vector< int > > term_to_document_ids;
+
+        for( const int document_id : document_ids )
+            {
+                const auto it = document_to_word_freqs_.find( document_id );
+
+                for( const auto & [ word, _ ] : it->second )
+                    {
+                        term_to_document_ids[ terms_.Find( word ) ].push_back( document_id );
+                    }
+
+                document_to_word_freqs_.erase( it );
+            }
+
+        index_.RemoveDocuments(
+                InvertedIndex::TermDocuments(
+                        std::make_move_iterator( term_to_document_ids.begin() ),
+                        std::make_move_iterator( term_to_document_ids.end() ) ) );
+
+        documents_.Remove( document_ids );
+
+        OnIndexChanged();
+    }
+
+const std::map< std::string_view, double > &
+SearchServer::GetWordFrequencies( const int document_id ) const
+    {
+        // Снимок не хранит слова документов, а собирать их обходом всех
+        // постингов - дольше, чем загрузка снимка.
+        ThrowIfSnapshot();
+
+        static const std::map< std::string_view, double > empty_word_freqs;
+
+        const auto it = document_to_word_freqs_.find( document_id );
+
+        if( it == document_to_word_freqs_.cend() )
+            {
+                return empty_word_freqs;
+            }
+
+        return it->second;
+    }
+
+std::size_t
+SearchServer::GetDocumentFreq( const std::string_view word ) const
+    {
+        const TermId term = terms_.Find( word );
+
+        if( term == TermDictionary::NO_TERM )
+            {
+                return 0;
+            }
+
+        return index_.GetDocumentFreq( term );
+    }
+
+bool
+SearchServer::ContainsDocument( const int document_id ) const
+    {
+        return documents_.Contains( document_id );
     }
 
 int
@@ -76,6 +502,18 @@ SearchServer::GetDocumentCount() const
         return documents_.size();
     }
 
+DocumentStore::Iterator
+SearchServer::begin() const
+    {
+        return documents_.begin();
+    }
+
+DocumentStore::Iterator
+SearchServer::end() const
+    {
+        return documents_.end();
+    }
+
 int
 SearchServer::GetDocumentId( const int index ) const
     {
@@ -92,74 +530,420 @@ SearchServer::GetDocumentId( const int index ) const
                         " допустимого диапазона (0; количество документов)."s );
             }
 
-        return std::next( documents_.cbegin(), index )->first;
+        return documents_.GetNthId( index );
     }
 
-std::tuple< std::vector< std::string >, DocumentStatus >
+std::tuple< std::vector< std::string_view >, DocumentStatus >
 SearchServer::MatchDocument(
-        const std::string & raw_query,
+        const std::string_view raw_query,
         const int document_id ) const
     {
-        const Query query = ParseQuery( raw_query );
+        const QueryArena arena;
+
+        const Query query = ParseQuery( raw_query, arena.GetResource() );
 
-        std::vector< std::string > matched_words;
-        matched_words.reserve( query.plus_words.size() );
+        const DocumentStatus status = documents_.GetStatus( GetDocumentOrdinal( document_id ) );
 
-        for( const std::string & word : query.plus_words )
+        for( const TermId term : query.minus_terms )
             {
-                if( word_to_document_freqs_.count( word ) == 0)
+                if( index_.ContainsDocument( term, document_id ) )
                     {
-                        continue;
+                        return { std::vector< std::string_view >(), status };
+                    }
+            }
+
+        std::pmr::vector< TermId > matched_terms( arena.GetResource() );
+        matched_terms.reserve( query.plus_terms.size() );
+
+        for( const TermId term : query.plus_terms )
+            {
+                if( index_.ContainsDocument( term, document_id ) )
+                    {
+                        matched_terms.push_back( term );
                     }
-                if( word_to_document_freqs_.at( word ).count( document_id ) )
+            }
+
+        return { GetWords( matched_terms ), status };
+    }
+
+void
+SearchServer::ThrowIfSnapshot() const
+    {
+        if( snapshot_ )
+            {
+                throw std::logic_error( "Сервер, загруженный из снимка, доступен только для чтения." );
+            }
+    }
+
+void
+SearchServer::OnIndexChanged()
+    {
+        ++index_generation_;
+
+        inverse_document_freqs_.Resize( terms_.size() );
+    }
+
+void
+SearchServer::ValidateDocumentId(
+        const int document_id,
+        const bool is_pending ) const
+    {
+        if( document_id < 0 )
+            {
+                using namespace std::string_literals;
+
+                throw std::invalid_argument(
+                        "Попытка добавить документ с отрицательным id."s );
+            }
+
+        if(
+                is_pending
+                ||
+                documents_.Contains( document_id ) )
+            {
+                using namespace std::string_literals;
+
+                throw std::invalid_argument(
+                        "Попытка добавить документ c id ранее добавленного документа."s );
+            }
+    }
+
+void
+SearchServer::AddDocumentBatch( const std::vector< DocumentRecord > & records )
+    {
+        ThrowIfSnapshot();
+
+        if( records.empty() )
+            {
+                return;
+            }
+
+        // Записи делятся на непрерывные диапазоны по числу потоков;
+        // каждый поток разбирает свой диапазон в частичный индекс.
+        const std::size_t partial_count = std::min< std::size_t >(
+                records.size(),
+                std::max( 1u, std::thread::hardware_concurrency() ) );
+
+        std::vector< IngestPartial > partials( partial_count );
+
+        for( std::size_t i = 0; i < partial_count; ++i )
+            {
+                partials[ i ].first_record = records.size() * i / partial_count;
+                partials[ i ].last_record = records.size() * ( i + 1 ) / partial_count;
+                partials[ i ].failed_record = partials[ i ].last_record;
+            }
+
+        std::for_each(
+                std::execution::par,
+                partials.begin(),
+                partials.end(),
+                [this, &records]( IngestPartial & partial )
+                    {
+                        TokenizeRecords( records, partial );
+                    } );
+
+        // Принимаются записи до первой ошибки - разбора или проверки id,
+        // как если бы документы добавлялись по одному.
+        std::size_t accepted_count = records.size();
+        std::exception_ptr error;
+
+        for( const IngestPartial & partial : partials )
+            {
+                if( partial.error )
                     {
-                        matched_words.push_back( word );
+                        accepted_count = partial.failed_record;
+                        error = partial.error;
+
+                        break;
                     }
             }
-        for( const std::string & word : query.minus_words )
+
+        std::unordered_set< int > pending_ids;
+
+        for( std::size_t i = 0; i < records.size() && i <= accepted_count; ++i )
             {
-                if( word_to_document_freqs_.count( word ) == 0 )
+                try
                     {
-                        continue;
+                        ValidateDocumentId( records[ i ].id, pending_ids.count( records[ i ].id ) > 0 );
                     }
-                if( word_to_document_freqs_.at( word ).count( document_id ) )
+                catch( ... )
                     {
-                        matched_words.clear();
+                        accepted_count = i;
+                        error = std::current_exception();
+
                         break;
                     }
+
+                pending_ids.insert( records[ i ].id );
             }
 
-        return
-                {
-                    matched_words,
-                    documents_.at( document_id ).status
-                };
+        // Слова частичных индексов добавляются в общий словарь; слово, первая запись
+        // которого не принята, в индекс не попадает и не добавляется.
+        std::vector< std::vector< TermId > > local_to_global( partial_count );
+
+        std::unordered_map< TermId, std::size_t > term_to_slot;
+        std::vector< InvertedIndex::TermPostings > term_postings;
+        std::vector< std::vector< std::pair< std::size_t, TermId > > > slot_sources;
+
+        for( std::size_t i = 0; i < partial_count; ++i )
+            {
+                const IngestPartial & partial = partials[ i ];
+
+                local_to_global[ i ].resize( partial.words.size(), TermDictionary::NO_TERM );
+
+                for( TermId local_term = 0; local_term < partial.words.size(); ++local_term )
+                    {
+                        if( partial.postings[ local_term ].front().first >= accepted_count )
+                            {
+                                continue;
+                            }
+
+                        const TermId term = terms_.Intern( partial.words[ local_term ] );
+
+                        local_to_global[ i ][ local_term ] = term;
+
+                        const auto [ it, inserted ] = term_to_slot.emplace( term, term_postings.size() );
+
+                        if( inserted )
+                            {
+                                term_postings.emplace_back( term, InvertedIndex::Postings() );
+                                slot_sources.emplace_back();
+                            }
+
+                        slot_sources[ it->second ].emplace_back( i, local_term );
+                    }
+            }
+
+        // Постинги одного слова собираются из всех частичных индексов; разные слова независимы.
+        std::for_each(
+                std::execution::par,
+                term_postings.begin(),
+                term_postings.end(),
+                [&]( InvertedIndex::TermPostings & postings )
+                    {
+                        const std::size_t slot = &postings - term_postings.data();
+
+                        for( const auto & [ partial_index, local_term ] : slot_sources[ slot ] )
+                            {
+                                for( const auto & [ record, term_freq ] : partials[ partial_index ].postings[ local_term ] )
+                                    {
+                                        if( record >= accepted_count )
+                                            {
+                                                break;
+                                            }
+
+                                        postings.second.emplace_back( records[ record ].id, term_freq );
+                                    }
+                            }
+
+                        if( !std::is_sorted( postings.second.cbegin(), postings.second.cend() ) )
+                            {
+                                std::sort( postings.second.begin(), postings.second.end() );
+                            }
+                    } );
+
+        index_.AddPostings( std::execution::par, term_postings );
+
+        std::vector< std::map< std::string_view, double > > word_freqs( accepted_count );
+
+        std::for_each(
+                std::execution::par,
+                partials.cbegin(),
+                partials.cend(),
+                [&]( const IngestPartial & partial )
+                    {
+                        const std::size_t partial_index = &partial - partials.data();
+
+                        for( std::size_t record = partial.first_record; record < std::min( partial.last_record, accepted_count ); ++record )
+                            {
+                                for( const auto & [ local_term, term_freq ] : partial.document_term_freqs[ record - partial.first_record ] )
+                                    {
+                                        word_freqs[ record ].emplace(
+                                                terms_.GetWord( local_to_global[ partial_index ][ local_term ] ),
+                                                term_freq );
+                                    }
+                            }
+                    } );
+
+        for( std::size_t i = 0; i < accepted_count; ++i )
+            {
+                const DocumentRecord & record = records[ i ];
+
+                document_to_word_freqs_.emplace_hint(
+                        document_to_word_freqs_.cend(),
+                        record.id,
+                        std::move( word_freqs[ i ] ) );
+
+                documents_.Add( record.id, ComputeAverageRating( record.ratings ), record.status );
+            }
+
+        OnIndexChanged();
+
+        if( error )
+            {
+                std::rethrow_exception( error );
+            }
+    }
+
+void
+SearchServer::TokenizeRecords(
+        const std::vector< DocumentRecord > & records,
+        IngestPartial & partial ) const
+    {
+        for( std::size_t record = partial.first_record; record < partial.last_record; ++record )
+            {
+                // Исключение не должно покинуть параллельный алгоритм:
+                // оно сохраняется и пробрасывается после слияния.
+                try
+                    {
+                        const std::vector< std::string_view > words = SplitIntoWords( records[ record ].text );
+
+                        std::vector< TermId > document_terms;
+                        document_terms.reserve( words.size() );
+
+                        for( const std::string_view word : words )
+                            {
+                                const auto [ it, inserted ] = partial.local_terms.emplace(
+                                        word,
+                                        static_cast< TermId >( partial.words.size() ) );
+
+                                if( inserted )
+                                    {
+                                        const TermId term = terms_.Find( word );
+
+                                        if(
+                                                term != TermDictionary::NO_TERM
+                                                &&
+                                                IsStopTerm( term ) )
+                                            {
+                                                it->second = TermDictionary::NO_TERM;
+                                            }
+                                        else
+                                            {
+                                                partial.words.push_back( word );
+                                                partial.postings.emplace_back();
+                                            }
+                                    }
+
+                                if( it->second != TermDictionary::NO_TERM )
+                                    {
+                                        document_terms.push_back( it->second );
+                                    }
+                            }
+
+                        InvertedIndex::TermFreqs term_freqs = InvertedIndex::ComputeTermFreqs( std::move( document_terms ) );
+
+                        for( const auto & [ term, term_freq ] : term_freqs )
+                            {
+                                partial.postings[ term ].emplace_back( record, term_freq );
+                            }
+
+                        partial.document_term_freqs.push_back( std::move( term_freqs ) );
+                    }
+                catch( ... )
+                    {
+                        partial.failed_record = record;
+                        partial.error = std::current_exception();
+
+                        return;
+                    }
+            }
+    }
+
+std::size_t
+SearchServer::GetDocumentOrdinal( const int document_id ) const
+    {
+        const std::size_t ordinal = documents_.FindOrdinal( document_id );
+
+        if( ordinal == DocumentStore::NO_ORDINAL )
+            {
+                using namespace std::string_literals;
+
+                throw std::out_of_range( "Документ с id "s + std::to_string( document_id ) + " не найден."s );
+            }
+
+        return ordinal;
+    }
+
+std::vector< std::string_view >
+SearchServer::GetWords( const std::pmr::vector< TermId > & terms ) const
+    {
+        std::vector< std::string_view > words;
+        words.reserve( terms.size() );
+
+        for( const TermId term : terms )
+            {
+                words.push_back( terms_.GetWord( term ) );
+            }
+
+        return words;
     }
 
 bool
-SearchServer::IsStopWord( const std::string & word ) const
+SearchServer::IsStopTerm( const TermId term ) const
     {
-        return stop_words_.count( word ) > 0;
+        return term < stop_term_count_;
     }
 
-std::vector< std::string >
-SearchServer::SplitIntoWordsNoStop( const std::string & text ) const
+std::vector< TermId >
+SearchServer::SplitIntoTermsNoStop( const std::string_view text )
     {
-        std::vector< std::string > all_words = SplitIntoWords( text );
+        std::vector< TermId > terms;
 
-        std::vector< std::string > result;
-        result.reserve( all_words.size() );
+        for( const std::string_view word : SplitIntoWords( text ) )
+            {
+                const TermId term = terms_.Intern( word );
 
-        std::copy_if(
-                std::make_move_iterator( all_words.begin() ),
-                std::make_move_iterator( all_words.end() ),
-                std::back_inserter( result ),
-                [this]( const std::string & word )
+                if( !IsStopTerm( term ) )
                     {
-                        return !IsStopWord( word );
-                    } );
+                        terms.push_back( term );
+                    }
+            }
 
-        return result;
+        return terms;
+    }
+
+InvertedIndex::TermFreqs
+SearchServer::GetTermFreqs( const std::map< std::string_view, double > & word_freqs ) const
+    {
+        InvertedIndex::TermFreqs term_freqs;
+        term_freqs.reserve( word_freqs.size() );
+
+        for( const auto & [ word, term_freq ] : word_freqs )
+            {
+                term_freqs.emplace_back( terms_.Find( word ), term_freq );
+            }
+
+        return term_freqs;
+    }
+
+bool
+SearchServer::IsMoreRelevant(
+        const Document & lhs,
+        const Document & rhs )
+    {
+        if( std::abs( lhs.relevance - rhs.relevance ) >= relevance_tolerance_ )
+            {
+                return lhs.relevance > rhs.relevance;
+            }
+        else if( lhs.rating != rhs.rating )
+            {
+                return lhs.rating > rhs.rating;
+            }
+        else
+            {
+                return lhs.id < rhs.id;
+            }
+    }
+
+void
+SearchServer::SelectTopDocumentsMeasured(
+        std::pmr::vector< Document > & matched_documents,
+        const std::size_t max_result_count ) const
+    {
+        const SearchMetrics::StageTimer timer( metrics_, SearchMetrics::Stage::SELECT_TOP_DOCUMENTS );
+
+        SelectTopDocuments( matched_documents, max_result_count );
     }
 
 int
@@ -178,40 +962,72 @@ SearchServer::ComputeAverageRating( const std::vector< int > & ratings )
     }
 
 SearchServer::QueryWord
-SearchServer::ParseQueryWord( std::string text ) const
+SearchServer::ParseQueryWord( std::string_view text ) const
     {
         bool is_minus = false;
 
         if( text.at( 0 ) == '-' )
             {
                 is_minus = true;
-                text = text.substr( 1 );
+                text.remove_prefix( 1 );
             }
 
+        const TermId term = terms_.Find( text );
+
         return
-                { text, is_minus, IsStopWord( text ) };
+                {
+                    term,
+                    is_minus,
+                    term != TermDictionary::NO_TERM && IsStopTerm( term )
+                };
     }
 
 SearchServer::Query
-SearchServer::ParseQuery( const std::string & text ) const
+SearchServer::ParseQuery(
+        const std::string_view text,
+        std::pmr::memory_resource * const resource ) const
     {
-        SearchServer::Query result;
+        const SearchMetrics::StageTimer timer( metrics_, SearchMetrics::Stage::PARSE_QUERY );
 
-        for( const std::string & word : SplitIntoWords( text ) )
+        SearchServer::Query result{ std::pmr::vector< TermId >( resource ), std::pmr::vector< TermId >( resource ) };
+
+        for( const std::string_view word : SplitIntoWords( text, resource ) )
             {
                 const SearchServer::QueryWord query_word = ParseQueryWord( word );
 
-                if( !query_word.is_stop )
+                // Слова, которых нет в словаре, не встречаются ни в одном документе
+                // и не влияют на результат.
+                if(
+                        query_word.is_stop
+                        ||
+                        query_word.term == TermDictionary::NO_TERM )
                     {
-                        if( query_word.is_minus )
-                            {
-                                result.minus_words.insert( query_word.data );
-                            }
-                        else
-                            {
-                                result.plus_words.insert( query_word.data );
-                            }
+                        continue;
                     }
+
+                if( query_word.is_minus )
+                    {
+                        result.minus_terms.push_back( query_word.term );
+                    }
+                else
+                    {
+                        result.plus_terms.push_back( query_word.term );
+                    }
+            }
+
+        // Слова упорядочиваются по алфавиту, а не по id: так порядок суммирования
+        // релевантности и порядок слов в MatchDocument не зависят от истории словаря.
+        for( std::pmr::vector< TermId > * terms : { &result.plus_terms, &result.minus_terms } )
+            {
+                std::sort(
+                        terms->begin(),
+                        terms->end(),
+                        [this]( const TermId lhs, const TermId rhs )
+                            {
+                                return terms_.GetWord( lhs ) < terms_.GetWord( rhs );
+                            } );
+
+                terms->erase( std::unique( terms->begin(), terms->end() ), terms->end() );
             }
 
         return result;
@@ -219,7 +1035,7 @@ SearchServer::ParseQuery( const std::string & text ) const
 
 double
 SearchServer::ComputeWordInverseDocumentFreq(
-        const std::string & word ) const
+        const std::size_t document_freq ) const
     {
         return
                 std::log(
@@ -227,6 +1043,52 @@ SearchServer::ComputeWordInverseDocumentFreq(
                             *
                             GetDocumentCount()
                             /
-                            word_to_document_freqs_.at( word ).size() );
+                            document_freq );
     }
 
+double
+SearchServer::GetInverseDocumentFreq(
+        const TermId term,
+        const std::size_t document_freq ) const
+    {
+        return
+                inverse_document_freqs_.Get(
+                        term,
+                        index_generation_,
+                        [this, document_freq]()
+                            {
+                                return ComputeWordInverseDocumentFreq( document_freq );
+                            } );
+    }
+
+DocumentBitmap
+SearchServer::CollectMinusDocuments(
+        const Query & query,
+        std::pmr::memory_resource * const resource ) const
+    {
+        if( query.minus_terms.empty() )
+            {
+                return DocumentBitmap();
+            }
+
+        DocumentBitmap minus_documents( documents_.GetOrdinalCount(), resource );
+
+        for( const TermId term : query.minus_terms )
+            {
+                metrics_.Add( SearchMetrics::Counter::POSTINGS_SCANNED, index_.GetDocumentFreq( term ) );
+
+                index_.ForEachPosting(
+                        term,
+                        [this, &minus_documents]( const int document_id, const double )
+                            {
+                                minus_documents.Insert( documents_.FindOrdinal( document_id ) );
+                            } );
+            }
+
+        if( metrics_.IsEnabled() )
+            {
+                metrics_.Add( SearchMetrics::Counter::DOCUMENTS_EXCLUDED, minus_documents.GetCount() );
+            }
+
+        return minus_documents;
+    }
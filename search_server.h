@@ -2,16 +2,64 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <exception>
+#include <execution>
+#include <istream>
+#include <iterator>
 #include <map>
-#include <set>
+#include <memory>
+#include <memory_resource>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <queue>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "document.h"
+#include "document_bitmap.h"
+#include "document_store.h"
+#include "index_snapshot.h"
+#include "inverse_document_freq_cache.h"
+#include "inverted_index.h"
+#include "query_arena.h"
+#include "query_result_cache.h"
+#include "read_input_functions.h"
+#include "search_metrics.h"
 #include "string_processing.h"
+#include "term_dictionary.h"
 
 constexpr int MAX_RESULT_DOCUMENT_COUNT = 5;
 
+// Предикат FindTopDocuments, отбирающий документы с заданным статусом.
+inline auto
+MakeStatusPredicate( const DocumentStatus status )
+    {
+        return [status]( int, const DocumentStatus document_status, int )
+            {
+                return document_status == status;
+            };
+    }
+
+// Способ отбора лучших документов запроса.
+enum class QueryMode
+    {
+        // Оцениваются все документы, содержащие плюс-слова.
+        EXHAUSTIVE,
+
+        // WAND: документ оценивается, только если сумма верхних границ вклада его
+        // слов может превысить релевантность уже найденных лучших документов.
+        // Выигрывает на запросах из частых слов с небольшим max_result_count.
+        WAND,
+    };
+
 class SearchServer
     {
 
@@ -19,185 +67,1081 @@ class SearchServer
 
             SearchServer() = delete;
 
-            explicit SearchServer( const std::string & stop_words_text );
+            explicit SearchServer(
+                    const std::string & stop_words_text,
+                    const PostingsFormat postings_format = PostingsFormat::PLAIN );
+
+            explicit SearchServer(
+                    const std::string_view stop_words_text,
+                    const PostingsFormat postings_format = PostingsFormat::PLAIN );
 
             template < typename StopWordsCollection >
-            explicit SearchServer( const StopWordsCollection & stop_words )
+            explicit SearchServer(
+                    const StopWordsCollection & stop_words,
+                    const PostingsFormat postings_format = PostingsFormat::PLAIN )
                 :
-                    stop_words_( ParseStopWords( stop_words ) )
+                      stop_term_count_( InternStopWords( stop_words ) )
+                    , index_( postings_format )
                 {}
 
+            // Ключи прямого индекса ссылаются на слова словаря, поэтому копия переводит их
+            // на свой словарь. При перемещении слова остаются на месте.
+            SearchServer( const SearchServer & other );
+
+            // Перемещённый сервер остаётся пустым, с теми же стоп-словами и форматом
+            // постингов, и пригоден для дальнейшей работы.
+            SearchServer( SearchServer && other );
+
+            // Сохраняет стоп-слова, словарь, постинги и метаданные документов в бинарный снимок.
+            void
+            SaveSnapshot( const std::string & path ) const;
+
+            // Открывает снимок через mmap: запросы выполняются прямо по отображённым страницам,
+            // время запуска не зависит от размера индекса. Загруженный сервер доступен
+            // только для чтения; GetWordFrequencies, AddDocumentFrom с ним в качестве
+            // источника и RemoveDuplicates для него бросают std::logic_error.
+            static SearchServer
+            LoadSnapshot( const std::string & path );
+
             void
             AddDocument(
                     const int document_id,
-                    const std::string & document,
+                    const std::string_view document,
                     const DocumentStatus status,
                     const std::vector< int > & ratings );
 
+            // Пакетная загрузка: записи читаются пакетами по ingest_batch_size_,
+            // слова каждого пакета разбираются параллельно в частичные индексы потоков,
+            // которые затем вливаются в общий индекс. Результат тот же, что у вызовов
+            // AddDocument по порядку: при ошибке записи предшествующие ей документы
+            // уже добавлены, а исключение пробрасывается вызывающему.
+            template < typename InputIt >
+            void
+            AddDocuments(
+                    InputIt first,
+                    const InputIt last )
+                {
+                    std::vector< DocumentRecord > batch;
+                    batch.reserve( ingest_batch_size_ );
+
+                    for( ; first != last; ++first )
+                        {
+                            batch.push_back( *first );
+
+                            if( batch.size() == ingest_batch_size_ )
+                                {
+                                    AddDocumentBatch( batch );
+                                    batch.clear();
+                                }
+                        }
+
+                    AddDocumentBatch( batch );
+                }
+
+            // Читает записи в формате operator>>( std::istream &, DocumentRecord & ) до конца потока.
+            void
+            AddDocuments( std::istream & input );
+
+            // Переносит документ другого сервера с теми же частотами слов, рейтингом и статусом,
+            // не разбирая текст заново; релевантность документа не меняется.
+            // Стоп-слова серверов должны совпадать.
+            void
+            AddDocumentFrom(
+                    const SearchServer & source,
+                    const int document_id );
+
             template < typename DocumentPredicate >
             std::vector< Document >
             FindTopDocuments(
-                    const std::string & raw_query,
-                    const DocumentPredicate document_predicate ) const
+                    const std::string_view raw_query,
+                    const DocumentPredicate document_predicate,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const
+                {
+                    const QueryArena arena;
+
+                    const Query query = ParseQuery( raw_query, arena.GetResource() );
+
+                    auto matched_documents = FindAllDocuments( query, document_predicate, arena.GetResource() );
+
+                    SelectTopDocumentsMeasured( matched_documents, max_result_count );
+
+                    return std::vector< Document >( matched_documents.begin(), matched_documents.end() );
+                }
+
+            std::vector< Document >
+            FindTopDocuments(
+                    const std::string_view raw_query,
+                    const DocumentStatus status = DocumentStatus::ACTUAL,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const;
+
+            // Режим задаётся для каждого запроса. Результат WAND совпадает с полным
+            // перебором, включая выбор среди равных документов на границе отбора.
+            template < typename DocumentPredicate >
+            std::vector< Document >
+            FindTopDocuments(
+                    const QueryMode mode,
+                    const std::string_view raw_query,
+                    const DocumentPredicate document_predicate,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const
+                {
+                    if( mode == QueryMode::EXHAUSTIVE )
+                        {
+                            return FindTopDocuments( raw_query, document_predicate, max_result_count );
+                        }
+
+                    const QueryArena arena;
+
+                    return
+                            FindTopDocumentsPruned(
+                                    ParseQuery( raw_query, arena.GetResource() ),
+                                    document_predicate,
+                                    max_result_count,
+                                    arena.GetResource() );
+                }
+
+            // В режиме WAND кэш результатов не используется.
+            std::vector< Document >
+            FindTopDocuments(
+                    const QueryMode mode,
+                    const std::string_view raw_query,
+                    const DocumentStatus status = DocumentStatus::ACTUAL,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const;
+
+            // Все подходящие под запрос документы, без отбора лучших; IDF слова возвращает
+            // inverse_document_freq( word ). Так несколько серверов - частей одного корпуса -
+            // считают релевантность по общей статистике, и результат совпадает с поиском
+            // по единому серверу.
+            template < typename DocumentPredicate, typename InverseDocumentFreq >
+            std::vector< Document >
+            FindAllDocuments(
+                    const std::string_view raw_query,
+                    const DocumentPredicate document_predicate,
+                    const InverseDocumentFreq inverse_document_freq ) const
                 {
-                    const Query query = ParseQuery( raw_query );
+                    const QueryArena arena;
+
+                    const auto matched_documents =
+                            FindAllDocuments(
+                                    ParseQuery( raw_query, arena.GetResource() ),
+                                    document_predicate,
+                                    [this, &inverse_document_freq]( const TermId term, const std::size_t )
+                                        {
+                                            return inverse_document_freq( terms_.GetWord( term ) );
+                                        },
+                                    arena.GetResource() );
 
-                    auto matched_documents = FindAllDocuments( query, document_predicate );
+                    return std::vector< Document >( matched_documents.begin(), matched_documents.end() );
+                }
+
+            // Упорядочивает документы по убыванию релевантности и оставляет первые max_result_count.
+            template < typename Allocator >
+            static void
+            SelectTopDocuments(
+                    std::vector< Document, Allocator > & matched_documents,
+                    const std::size_t max_result_count )
+                {
+                    // Упорядочиваются только первые max_result_count документов:
+                    // O(n log k) вместо полной сортировки всех найденных документов.
+                    const std::size_t result_count = std::min( max_result_count, matched_documents.size() );
 
-                    std::sort(
+                    std::partial_sort(
                             matched_documents.begin(),
+                            std::next( matched_documents.begin(), result_count ),
                             matched_documents.end(),
-                            []( const Document & lhs, const Document & rhs )
-                                {
-                                    if( std::abs( lhs.relevance - rhs.relevance ) < 1e-6 )
-                                        {
-                                            return lhs.rating > rhs.rating;
-                                        }
-                                    else
-                                        {
-                                            return lhs.relevance > rhs.relevance;
-                                        }
-                                } );
+                            IsMoreRelevant );
 
-                    if( matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT )
+                    matched_documents.resize( result_count );
+                }
+
+            template < typename ExecutionPolicy, typename DocumentPredicate >
+            std::vector< Document >
+            FindTopDocuments(
+                    ExecutionPolicy && policy,
+                    const std::string_view raw_query,
+                    const DocumentPredicate document_predicate,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const
+                {
+                    if constexpr( IsSequencedPolicy< ExecutionPolicy >() )
                         {
-                            matched_documents.resize( MAX_RESULT_DOCUMENT_COUNT );
+                            return FindTopDocuments( raw_query, document_predicate, max_result_count );
                         }
+                    else
+                        {
+                            const QueryArena arena;
 
-                    return matched_documents;
+                            const Query query = ParseQuery( raw_query, arena.GetResource() );
+
+                            auto matched_documents = FindAllDocuments( policy, query, document_predicate, arena.GetResource() );
+
+                            SelectTopDocumentsMeasured( matched_documents, max_result_count );
+
+                            return std::vector< Document >( matched_documents.begin(), matched_documents.end() );
+                        }
                 }
 
+            // Результаты поиска с фильтром по статусу кэшируются, если кэш включён:
+            // см. SetQueryCacheCapacity.
+            template < typename ExecutionPolicy >
             std::vector< Document >
             FindTopDocuments(
-                    const std::string & raw_query,
-                    const DocumentStatus status = DocumentStatus::ACTUAL ) const;
+                    ExecutionPolicy && policy,
+                    const std::string_view raw_query,
+                    const DocumentStatus status = DocumentStatus::ACTUAL,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const
+                {
+                    return
+                            FindTopDocumentsCached(
+                                    policy,
+                                    raw_query,
+                                    status,
+                                    max_result_count,
+                                    []( const auto first, const auto last )
+                                        {
+                                            return std::vector< Document >( first, last );
+                                        } );
+                }
+
+            // Как FindTopDocuments с фильтром по статусу, но записывает документы в output,
+            // где должно быть место на max_result_count документов, и возвращает их число.
+            // Под результат не выделяется отдельный вектор.
+            std::size_t
+            FindTopDocumentsInto(
+                    const std::string_view raw_query,
+                    const DocumentStatus status,
+                    const std::size_t max_result_count,
+                    Document * const output ) const;
+
+            // Ёмкость кэша результатов FindTopDocuments с фильтром по статусу, в запросах.
+            // Любое изменение индекса делает кэш недействительным; 0 отключает кэш.
+            // По умолчанию кэш выключен: он окупается, только когда запросы повторяются.
+            void
+            SetQueryCacheCapacity( const std::size_t capacity );
+
+            QueryResultCache::Stats
+            GetQueryCacheStats() const;
+
+            // Время этапов поиска и счётчики работы; по умолчанию учёт выключен.
+            void
+            SetMetricsEnabled( const bool is_enabled );
+
+            SearchMetrics::Snapshot
+            GetMetrics() const;
+
+            void
+            ResetMetrics();
+
+            // Стоимость - O( число слов документа ) в среднем: документ и его постинги
+            // в простых списках только отмечаются удалёнными и вычищаются, когда
+            // отмеченных становится больше половины; сжатый список перекодирует
+            // один блок.
+            void
+            RemoveDocument( const int document_id );
+
+            template < typename ExecutionPolicy >
+            void
+            RemoveDocument(
+                    ExecutionPolicy && policy,
+                    const int document_id )
+                {
+                    ThrowIfSnapshot();
+
+                    const auto it = document_to_word_freqs_.find( document_id );
+
+                    if( it == document_to_word_freqs_.end() )
+                        {
+                            return;
+                        }
+
+                    index_.RemoveDocument( policy, document_id, GetTermFreqs( it->second ) );
+
+                    document_to_word_freqs_.erase( it );
+                    documents_.Remove( document_id );
+
+                    OnIndexChanged();
+                }
+
+            // Удаляет документы пакетом: сжатый список постингов каждого затронутого
+            // слова перекодируется один раз, а не по блоку на документ; поколение
+            // индекса сменяется один раз. Отсутствующие id пропускаются.
+            void
+            RemoveDocuments( std::vector< int > document_ids );
+
+            // Для сервера, загруженного из снимка, бросает std::logic_error.
+            const std::map< std::string_view, double > &
+            GetWordFrequencies( const int document_id ) const;
+
+            // Число документов, содержащих слово.
+            std::size_t
+            GetDocumentFreq( const std::string_view word ) const;
+
+            bool
+            ContainsDocument( const int document_id ) const;
 
             int
             GetDocumentCount() const;
 
+            DocumentStore::Iterator
+            begin() const;
+
+            DocumentStore::Iterator
+            end() const;
+
+            // O( 1 ), пока в хранилище нет отмеченных удалёнными документов.
             int
             GetDocumentId( const int index ) const;
 
-            std::tuple< std::vector< std::string >, DocumentStatus >
+            std::tuple< std::vector< std::string_view >, DocumentStatus >
             MatchDocument(
-                    const std::string & raw_query,
+                    const std::string_view raw_query,
                     const int document_id ) const;
 
+            template < typename ExecutionPolicy >
+            std::tuple< std::vector< std::string_view >, DocumentStatus >
+            MatchDocument(
+                    ExecutionPolicy && policy,
+                    const std::string_view raw_query,
+                    const int document_id ) const
+                {
+                    if constexpr( IsSequencedPolicy< ExecutionPolicy >() )
+                        {
+                            return MatchDocument( raw_query, document_id );
+                        }
+                    else
+                        {
+                            const QueryArena arena;
+
+                            const Query query = ParseQuery( raw_query, arena.GetResource() );
+
+                            const DocumentStatus status = documents_.GetStatus( GetDocumentOrdinal( document_id ) );
+
+                            const bool has_minus_word = std::any_of(
+                                    policy,
+                                    query.minus_terms.cbegin(),
+                                    query.minus_terms.cend(),
+                                    [this, document_id]( const TermId term )
+                                        {
+                                            return index_.ContainsDocument( term, document_id );
+                                        } );
+
+                            if( has_minus_word )
+                                {
+                                    return { std::vector< std::string_view >(), status };
+                                }
+
+                            std::pmr::vector< TermId > matched_terms( query.plus_terms.size(), arena.GetResource() );
+
+                            const auto matched_terms_end = std::copy_if(
+                                    policy,
+                                    query.plus_terms.cbegin(),
+                                    query.plus_terms.cend(),
+                                    matched_terms.begin(),
+                                    [this, document_id]( const TermId term )
+                                        {
+                                            return index_.ContainsDocument( term, document_id );
+                                        } );
+
+                            matched_terms.erase( matched_terms_end, matched_terms.end() );
+
+                            return { GetWords( matched_terms ), status };
+                        }
+                }
+
         private:
 
-            struct DocumentData
+            // Параллельный поиск делит порядковые номера документов не более чем
+            // на столько диапазонов и не дробит их мельче min_relevance_partition_size_.
+            static constexpr std::size_t relevance_partition_count_ = 16;
+
+            static constexpr std::size_t min_relevance_partition_size_ = 1024;
+
+            // Документы с меньшей разницей релевантности упорядочиваются по рейтингу.
+            static constexpr double relevance_tolerance_ = 1e-6;
+
+            // Число записей, разбираемых за один проход пакетной загрузки.
+            static constexpr std::size_t ingest_batch_size_ = 16384;
+
+            TermDictionary terms_;
+
+            // Стоп-слова добавляются в словарь первыми и получают id [0; stop_term_count_).
+            const TermId stop_term_count_;
+
+            InvertedIndex index_;
+
+            std::map< int, std::map< std::string_view, double > > document_to_word_freqs_;
+
+            DocumentStore documents_;
+
+            // Снимок, по страницам которого работает сервер, загруженный через LoadSnapshot.
+            std::shared_ptr< const IndexSnapshot > snapshot_;
+
+            // Поколение индекса увеличивается при каждом изменении документов;
+            // записи кэша прежних поколений недействительны.
+            std::uint64_t index_generation_ = 0;
+
+            mutable QueryResultCache query_cache_;
+
+            InverseDocumentFreqCache inverse_document_freqs_;
+
+            SearchMetrics metrics_;
+
+            explicit SearchServer( std::shared_ptr< const IndexSnapshot > snapshot );
+
+            void
+            ThrowIfSnapshot() const;
+
+            // Начинает новое поколение индекса: кэшированные результаты и IDF
+            // прежних поколений больше не используются.
+            void
+            OnIndexChanged();
+
+            // is_pending - id уже встречался в загружаемом пакете.
+            void
+            ValidateDocumentId(
+                    const int document_id,
+                    const bool is_pending = false ) const;
+
+            // Частичный индекс, который поток пакетной загрузки строит по записям
+            // [ first_record; last_record ). Слова нумеруются локально и ссылаются
+            // на текст записей; стоп-слова получают id TermDictionary::NO_TERM.
+            struct IngestPartial
                 {
-                    int rating;
-                    DocumentStatus status;
+                    std::size_t first_record = 0;
+                    std::size_t last_record = 0;
+
+                    std::unordered_map< std::string_view, TermId > local_terms;
+                    std::vector< std::string_view > words;
+
+                    // Постинги локальных слов: ( номер записи, частота ) по возрастанию номера.
+                    std::vector< std::vector< std::pair< std::size_t, double > > > postings;
+
+                    // Частоты локальных слов каждой записи, по порядку записей.
+                    std::vector< InvertedIndex::TermFreqs > document_term_freqs;
+
+                    // Первая запись, которую не удалось разобрать, и её исключение.
+                    std::size_t failed_record = 0;
+                    std::exception_ptr error;
                 };
 
-            const std::set< std::string > stop_words_;
+            void
+            AddDocumentBatch( const std::vector< DocumentRecord > & records );
 
-            std::map< std::string, std::map< int, double > > word_to_document_freqs_;
+            void
+            TokenizeRecords(
+                    const std::vector< DocumentRecord > & records,
+                    IngestPartial & partial ) const;
 
-            std::map< int, DocumentData > documents_;
+            // Бросает out_of_range, если документа с таким id нет.
+            std::size_t
+            GetDocumentOrdinal( const int document_id ) const;
 
             template < typename StopWordsCollection >
-            std::set< std::string >
-            ParseStopWords( const StopWordsCollection & stop_words ) const
+            TermId
+            InternStopWords( const StopWordsCollection & stop_words )
                 {
                     ValidateRawWordsCollection( stop_words );
 
+                    for( const std::string_view stop_word : stop_words )
+                        {
+                            terms_.Intern( stop_word );
+                        }
+
+                    return static_cast< TermId >( terms_.size() );
+                }
+
+            template < typename ExecutionPolicy >
+            static constexpr bool
+            IsSequencedPolicy()
+                {
                     return
-                            {
-                                stop_words.cbegin(),
-                                stop_words.cend()
-                            };
+                            std::is_same_v<
+                                    std::decay_t< ExecutionPolicy >,
+                                    std::execution::sequenced_policy >;
                 }
 
+            std::vector< std::string_view >
+            GetWords( const std::pmr::vector< TermId > & terms ) const;
+
             bool
-            IsStopWord( const std::string & word ) const;
+            IsStopTerm( const TermId term ) const;
+
+            std::vector< TermId >
+            SplitIntoTermsNoStop( const std::string_view text );
 
-            std::vector< std::string >
-            SplitIntoWordsNoStop( const std::string & text ) const;
+            InvertedIndex::TermFreqs
+            GetTermFreqs( const std::map< std::string_view, double > & word_freqs ) const;
+
+            // Релевантность по убыванию, при равенстве в пределах relevance_tolerance_ -
+            // рейтинг по убыванию, затем id по возрастанию. Порядок не зависит от
+            // порядка кандидатов, поэтому шарды, сегменты, WAND и параллельный обход
+            // отбирают одни и те же документы.
+            static bool
+            IsMoreRelevant(
+                    const Document & lhs,
+                    const Document & rhs );
+
+            // SelectTopDocuments с учётом времени отбора в метриках.
+            void
+            SelectTopDocumentsMeasured(
+                    std::pmr::vector< Document > & matched_documents,
+                    const std::size_t max_result_count ) const;
 
             static int
             ComputeAverageRating( const std::vector< int > & ratings );
 
+            // Слово, отсутствующее в словаре, получает term = TermDictionary::NO_TERM.
             struct QueryWord
                 {
-                    std::string data;
+                    TermId term;
                     bool is_minus;
                     bool is_stop;
                 };
 
             QueryWord
-            ParseQueryWord( std::string text ) const;
+            ParseQueryWord( std::string_view text ) const;
 
+            // Запрос хранит только слова, известные словарю;
+            // они упорядочены по алфавиту и не повторяются.
             struct Query
                 {
-                    std::set< std::string > plus_words;
-                    std::set< std::string > minus_words;
+                    std::pmr::vector< TermId > plus_terms;
+                    std::pmr::vector< TermId > minus_terms;
                 };
 
+            // Слова запроса размещаются в resource, обычно в арене запроса.
             Query
-            ParseQuery( const std::string & text ) const;
+            ParseQuery(
+                    const std::string_view text,
+                    std::pmr::memory_resource * const resource ) const;
+
+            template < typename DocumentToRelevance >
+            std::pmr::vector< Document >
+            CollectDocuments(
+                    const DocumentToRelevance & document_to_relevance,
+                    std::pmr::memory_resource * const resource ) const
+                {
+                    const SearchMetrics::StageTimer timer( metrics_, SearchMetrics::Stage::COLLECT_DOCUMENTS );
+
+                    metrics_.Add( SearchMetrics::Counter::DOCUMENTS_SCORED, document_to_relevance.size() );
+
+                    std::pmr::vector< Document > result( resource );
+                    result.reserve( document_to_relevance.size() );
+
+                    for( const auto & [ document_id, relevance ] : document_to_relevance )
+                        {
+                            result.push_back(
+                                    {
+                                        document_id,
+                                        relevance,
+                                        documents_.GetRating( documents_.FindOrdinal( document_id ) )
+                                    } );
+                        }
+
+                    return result;
+                }
 
+            // Документы, содержащие минус-слова запроса; оценка их пропускает.
+            DocumentBitmap
+            CollectMinusDocuments(
+                    const Query & query,
+                    std::pmr::memory_resource * const resource ) const;
+
+            double
+            ComputeWordInverseDocumentFreq( const std::size_t document_freq ) const;
+
+            // IDF слова из кэша; std::log вычисляется один раз за поколение индекса.
             double
-            ComputeWordInverseDocumentFreq( const std::string & word ) const;
+            GetInverseDocumentFreq(
+                    const TermId term,
+                    const std::size_t document_freq ) const;
+
+            // Поиск с фильтром по статусу через кэш результатов; write_result( first, last )
+            // получает отобранные документы и возвращает результат поиска.
+            template < typename ExecutionPolicy, typename ResultWriter >
+            auto
+            FindTopDocumentsCached(
+                    ExecutionPolicy && policy,
+                    const std::string_view raw_query,
+                    const DocumentStatus status,
+                    const std::size_t max_result_count,
+                    const ResultWriter write_result ) const
+                {
+                    const QueryArena arena;
+
+                    std::pmr::memory_resource * const resource = arena.GetResource();
+
+                    const Query query = ParseQuery( raw_query, resource );
+
+                    // Ключ собирается, только если кэш включён.
+                    std::optional< QueryResultCache::Key > key;
+
+                    if( query_cache_.IsEnabled() )
+                        {
+                            key.emplace(
+                                    QueryResultCache::Key{
+                                            { query.plus_terms, resource },
+                                            { query.minus_terms, resource },
+                                            status,
+                                            max_result_count } );
+
+                            if( const auto cached_documents = query_cache_.Find( *key, index_generation_ ) )
+                                {
+                                    return write_result( cached_documents->cbegin(), cached_documents->cend() );
+                                }
+                        }
+
+                    const auto document_predicate = MakeStatusPredicate( status );
+
+                    std::pmr::vector< Document > matched_documents( resource );
+
+                    if constexpr( IsSequencedPolicy< ExecutionPolicy >() )
+                        {
+                            matched_documents = FindAllDocuments( query, document_predicate, resource );
+                        }
+                    else
+                        {
+                            matched_documents = FindAllDocuments( policy, query, document_predicate, resource );
+                        }
 
+                    SelectTopDocumentsMeasured( matched_documents, max_result_count );
+
+                    if( key )
+                        {
+                            query_cache_.Insert( *key, matched_documents, index_generation_ );
+                        }
+
+                    return write_result( matched_documents.cbegin(), matched_documents.cend() );
+                }
+
+            // Отбор лучших документов по WAND. Курсоры плюс-слов упорядочены по текущему
+            // документу; опорный документ - первый, на котором сумма верхних границ
+            // вклада слов достигает порога, релевантности max_result_count-го лучшего
+            // из оценённых. Документы до опорного не могут превысить порог и
+            // пропускаются через Seek.
+            //
+            // Порог берётся с запасом в две погрешности сравнения: документ в пределах
+            // relevance_tolerance_ от лучших упорядочивается по рейтингу и может их
+            // оттеснить, а сумма границ считается в другом порядке, чем релевантность.
+            // Оценённые документы выше порога с тем же запасом отбираются
+            // SelectTopDocuments, как при полном переборе; релевантность каждого
+            // складывается в порядке слов запроса и совпадает побитово.
+            //
+            // Временные данные обхода размещаются в resource; буферы распаковки
+            // курсоров сжатых постингов остаются в обычной памяти.
             template < typename DocumentPredicate >
             std::vector< Document >
-            FindAllDocuments(
+            FindTopDocumentsPruned(
                     const Query & query,
-                    const DocumentPredicate document_predicate ) const
+                    const DocumentPredicate document_predicate,
+                    const std::size_t max_result_count,
+                    std::pmr::memory_resource * const resource ) const
                 {
-                    std::map< int, double > document_to_relevance;
+                    if( max_result_count == 0 )
+                        {
+                            return {};
+                        }
 
-                    for( const std::string & word : query.plus_words )
+                    struct TermCursor
                         {
-                            if( word_to_document_freqs_.count( word ) == 0 )
+                            std::size_t query_position;
+                            double inverse_document_freq;
+                            double max_relevance;
+                            InvertedIndex::PostingCursor postings;
+                        };
+
+                    SearchMetrics::StageTimer score_timer( metrics_, SearchMetrics::Stage::SCORE_DOCUMENTS );
+
+                    std::pmr::vector< TermCursor > term_cursors( resource );
+                    term_cursors.reserve( query.plus_terms.size() );
+
+                    for( std::size_t i = 0; i < query.plus_terms.size(); ++i )
+                        {
+                            const TermId term = query.plus_terms[ i ];
+                            const std::size_t document_freq = index_.GetDocumentFreq( term );
+
+                            if( document_freq == 0 )
                                 {
                                     continue;
                                 }
 
-                            const double inverse_document_freq = ComputeWordInverseDocumentFreq( word );
+                            const double inverse_document_freq = GetInverseDocumentFreq( term, document_freq );
+
+                            term_cursors.push_back(
+                                    {
+                                          i
+                                        , inverse_document_freq
+                                        , inverse_document_freq * index_.GetMaxTermFreq( term )
+                                        , index_.GetPostingCursor( term )
+                                    } );
+                        }
+
+                    std::pmr::vector< InvertedIndex::PostingCursor > minus_cursors( resource );
+                    minus_cursors.reserve( query.minus_terms.size() );
+
+                    for( const TermId term : query.minus_terms )
+                        {
+                            minus_cursors.push_back( index_.GetPostingCursor( term ) );
+                        }
+
+                    std::pmr::vector< TermCursor * > cursors( resource );
+                    cursors.reserve( term_cursors.size() );
 
-                            for( const auto & [ document_id, term_freq ] : word_to_document_freqs_.at( word ) )
+                    for( TermCursor & term_cursor : term_cursors )
+                        {
+                            cursors.push_back( &term_cursor );
+                        }
+
+                    const double margin = 2 * relevance_tolerance_;
+
+                    // Релевантности max_result_count лучших оценённых документов.
+                    std::priority_queue< double, std::pmr::vector< double >, std::greater< double > > top_relevances( resource );
+
+                    const auto get_threshold = [&]()
+                        {
+                            if( top_relevances.size() < max_result_count )
                                 {
-                                    const auto & document_data = documents_.at( document_id );
+                                    return -std::numeric_limits< double >::infinity();
+                                }
+
+                            return top_relevances.top() - margin;
+                        };
+
+                    std::pmr::vector< Document > candidates( resource );
+                    std::pmr::vector< std::pair< std::size_t, double > > contributions( resource );
 
-                                    if( document_predicate(
-                                            document_id,
-                                            document_data.status,
-                                            document_data.rating ) )
+                    std::uint64_t postings_scanned = 0;
+                    std::uint64_t documents_scored = 0;
+
+                    while( true )
+                        {
+                            std::sort(
+                                    cursors.begin(),
+                                    cursors.end(),
+                                    []( const TermCursor * lhs, const TermCursor * rhs )
                                         {
-                                            document_to_relevance[ document_id ]
-                                                    += ( term_freq * inverse_document_freq );
+                                            return lhs->postings.GetDocumentId() < rhs->postings.GetDocumentId();
+                                        } );
+
+                            const double threshold = get_threshold();
+
+                            double max_relevance = 0.0;
+                            std::size_t pivot = cursors.size();
+
+                            for( std::size_t i = 0; i < cursors.size(); ++i )
+                                {
+                                    if( cursors[ i ]->postings.GetDocumentId() == InvertedIndex::PostingCursor::END_DOCUMENT_ID )
+                                        {
+                                            break;
                                         }
+
+                                    max_relevance += cursors[ i ]->max_relevance;
+
+                                    if( max_relevance >= threshold )
+                                        {
+                                            pivot = i;
+                                            break;
+                                        }
+                                }
+
+                            if( pivot == cursors.size() )
+                                {
+                                    break;
+                                }
+
+                            const int pivot_document_id = cursors[ pivot ]->postings.GetDocumentId();
+
+                            if( cursors.front()->postings.GetDocumentId() != pivot_document_id )
+                                {
+                                    for( std::size_t i = 0; i < pivot; ++i )
+                                        {
+                                            cursors[ i ]->postings.Seek( pivot_document_id );
+                                        }
+
+                                    continue;
+                                }
+
+                            contributions.clear();
+
+                            for( TermCursor * cursor : cursors )
+                                {
+                                    if( cursor->postings.GetDocumentId() != pivot_document_id )
+                                        {
+                                            break;
+                                        }
+
+                                    contributions.emplace_back(
+                                            cursor->query_position,
+                                            cursor->postings.GetTermFreq() * cursor->inverse_document_freq );
+
+                                    cursor->postings.Next();
+                                }
+
+                            postings_scanned += contributions.size();
+                            ++documents_scored;
+
+                            std::sort( contributions.begin(), contributions.end() );
+
+                            double relevance = 0.0;
+
+                            for( const auto & [ _, contribution ] : contributions )
+                                {
+                                    relevance += contribution;
+                                }
+
+                            if( relevance < threshold )
+                                {
+                                    continue;
+                                }
+
+                            const std::size_t ordinal = documents_.FindOrdinal( pivot_document_id );
+                            const int rating = documents_.GetRating( ordinal );
+
+                            if( !document_predicate( pivot_document_id, documents_.GetStatus( ordinal ), rating ) )
+                                {
+                                    continue;
+                                }
+
+                            const bool has_minus_word = std::any_of(
+                                    minus_cursors.begin(),
+                                    minus_cursors.end(),
+                                    [pivot_document_id]( InvertedIndex::PostingCursor & minus_cursor )
+                                        {
+                                            minus_cursor.Seek( pivot_document_id );
+
+                                            return minus_cursor.GetDocumentId() == pivot_document_id;
+                                        } );
+
+                            if( has_minus_word )
+                                {
+                                    continue;
+                                }
+
+                            candidates.push_back( { pivot_document_id, relevance, rating } );
+
+                            top_relevances.push( relevance );
+
+                            if( top_relevances.size() > max_result_count )
+                                {
+                                    top_relevances.pop();
                                 }
                         }
 
-                    for( const std::string & word : query.minus_words )
+                    // Порог рос по ходу обхода: ранние кандидаты могли оказаться ниже него.
+                    const double threshold = get_threshold();
+
+                    candidates.erase(
+                            std::remove_if(
+                                    candidates.begin(),
+                                    candidates.end(),
+                                    [threshold]( const Document & document )
+                                        {
+                                            return document.relevance < threshold;
+                                        } ),
+                            candidates.end() );
+
+                    score_timer.Stop();
+
+                    metrics_.Add( SearchMetrics::Counter::POSTINGS_SCANNED, postings_scanned );
+                    metrics_.Add( SearchMetrics::Counter::DOCUMENTS_SCORED, documents_scored );
+
+                    SelectTopDocumentsMeasured( candidates, max_result_count );
+
+                    return std::vector< Document >( candidates.begin(), candidates.end() );
+                }
+
+            template < typename DocumentPredicate >
+            std::pmr::vector< Document >
+            FindAllDocuments(
+                    const Query & query,
+                    const DocumentPredicate document_predicate,
+                    std::pmr::memory_resource * const resource ) const
+                {
+                    return
+                            FindAllDocuments(
+                                    query,
+                                    document_predicate,
+                                    [this]( const TermId term, const std::size_t document_freq )
+                                        {
+                                            return GetInverseDocumentFreq( term, document_freq );
+                                        },
+                                    resource );
+                }
+
+            // term_inverse_document_freq( term, document_freq ) возвращает IDF слова;
+            // document_freq - число документов этого сервера, содержащих слово.
+            // Накопитель релевантности и результат размещаются в resource.
+            template < typename DocumentPredicate, typename TermInverseDocumentFreq >
+            std::pmr::vector< Document >
+            FindAllDocuments(
+                    const Query & query,
+                    const DocumentPredicate document_predicate,
+                    const TermInverseDocumentFreq term_inverse_document_freq,
+                    std::pmr::memory_resource * const resource ) const
+                {
+                    SearchMetrics::StageTimer score_timer( metrics_, SearchMetrics::Stage::SCORE_DOCUMENTS );
+
+                    const DocumentBitmap minus_documents = CollectMinusDocuments( query, resource );
+
+                    std::pmr::map< int, double > document_to_relevance( resource );
+
+                    for( const TermId term : query.plus_terms )
                         {
-                            if( word_to_document_freqs_.count( word ) == 0 )
+                            const std::size_t document_freq = index_.GetDocumentFreq( term );
+
+                            if( document_freq == 0 )
                                 {
                                     continue;
                                 }
 
-                            for( const auto & [ document_id, _ ] : word_to_document_freqs_.at( word ) )
+                            const double inverse_document_freq = term_inverse_document_freq( term, document_freq );
+
+                            metrics_.Add( SearchMetrics::Counter::POSTINGS_SCANNED, document_freq );
+
+                            index_.ForEachPosting(
+                                    term,
+                                    [&]( const int document_id, const double term_freq )
+                                        {
+                                            const std::size_t ordinal = documents_.FindOrdinal( document_id );
+
+                                            if(
+                                                    !minus_documents.Contains( ordinal )
+                                                    &&
+                                                    document_predicate(
+                                                            document_id,
+                                                            documents_.GetStatus( ordinal ),
+                                                            documents_.GetRating( ordinal ) ) )
+                                                {
+                                                    document_to_relevance[ document_id ]
+                                                            += ( term_freq * inverse_document_freq );
+                                                }
+                                        } );
+                        }
+
+                    score_timer.Stop();
+
+                    return CollectDocuments( document_to_relevance, resource );
+                }
+
+            // Порядковые номера документов делятся на диапазоны, которые оцениваются
+            // параллельно. id растут вместе с номерами, поэтому диапазону соответствует
+            // непрерывный отрезок каждого списка постингов. Накопитель плотный, по
+            // номеру документа: каждый поток пишет только в свой диапазон, без
+            // блокировок, а результат собирается одним проходом. Слова внутри
+            // диапазона обходятся в порядке запроса, поэтому релевантность совпадает
+            // с последовательным поиском побитово.
+            template < typename ExecutionPolicy, typename DocumentPredicate >
+            std::pmr::vector< Document >
+            FindAllDocuments(
+                    ExecutionPolicy && policy,
+                    const Query & query,
+                    const DocumentPredicate document_predicate,
+                    std::pmr::memory_resource * const resource ) const
+                {
+                    SearchMetrics::StageTimer score_timer( metrics_, SearchMetrics::Stage::SCORE_DOCUMENTS );
+
+                    const DocumentBitmap minus_documents = CollectMinusDocuments( query, resource );
+
+                    std::pmr::vector< std::pair< TermId, double > > term_inverse_document_freqs( resource );
+
+                    for( const TermId term : query.plus_terms )
+                        {
+                            const std::size_t document_freq = index_.GetDocumentFreq( term );
+
+                            if( document_freq == 0 )
                                 {
-                                    document_to_relevance.erase( document_id );
+                                    continue;
                                 }
+
+                            term_inverse_document_freqs.emplace_back( term, GetInverseDocumentFreq( term, document_freq ) );
+
+                            metrics_.Add( SearchMetrics::Counter::POSTINGS_SCANNED, document_freq );
                         }
 
-                    std::vector< Document > result;
-                    for( const auto & [ document_id, relevance ] : document_to_relevance )
+                    const std::size_t ordinal_count = documents_.GetOrdinalCount();
+
+                    std::pmr::vector< double > relevances( resource );
+
+                    // Байт, а не бит на документ: соседние диапазоны пишут в разные байты.
+                    std::pmr::vector< std::uint8_t > is_matched( resource );
+
+                    if( !term_inverse_document_freqs.empty() )
                         {
-                            result.push_back(
-                                    {
-                                        document_id,
-                                        relevance,
-                                        documents_.at( document_id ).rating
-                                    } );
+                            relevances.assign( ordinal_count, 0.0 );
+                            is_matched.assign( ordinal_count, 0 );
+
+                            const std::size_t partition_count = std::clamp(
+                                    ordinal_count / min_relevance_partition_size_,
+                                    std::size_t{ 1 },
+                                    relevance_partition_count_ );
+
+                            std::pmr::vector< std::size_t > partitions( partition_count, resource );
+                            std::iota( partitions.begin(), partitions.end(), std::size_t{ 0 } );
+
+                            std::for_each(
+                                    policy,
+                                    partitions.cbegin(),
+                                    partitions.cend(),
+                                    [&]( const std::size_t partition )
+                                        {
+                                            const std::size_t first_ordinal = ordinal_count * partition / partition_count;
+                                            const std::size_t last_ordinal = ordinal_count * ( partition + 1 ) / partition_count;
+
+                                            if( first_ordinal == last_ordinal )
+                                                {
+                                                    return;
+                                                }
+
+                                            const int first_document_id = documents_.GetId( first_ordinal );
+                                            const int last_document_id = documents_.GetId( last_ordinal - 1 );
+
+                                            for( const auto & [ term, inverse_document_freq ] : term_inverse_document_freqs )
+                                                {
+                                                    index_.ForEachPosting(
+                                                            term,
+                                                            first_document_id,
+                                                            last_document_id,
+                                                            [&, inverse_document_freq = inverse_document_freq](
+                                                                    const int document_id,
+                                                                    const double term_freq )
+                                                                {
+                                                                    const std::size_t ordinal = documents_.FindOrdinal( document_id );
+
+                                                                    if(
+                                                                            !minus_documents.Contains( ordinal )
+                                                                            &&
+                                                                            document_predicate(
+                                                                                    document_id,
+                                                                                    documents_.GetStatus( ordinal ),
+                                                                                    documents_.GetRating( ordinal ) ) )
+                                                                        {
+                                                                            relevances[ ordinal ] += ( term_freq * inverse_document_freq );
+                                                                            is_matched[ ordinal ] = 1;
+                                                                        }
+                                                                } );
+                                                }
+                                        } );
                         }
 
+                    score_timer.Stop();
+
+                    const SearchMetrics::StageTimer collect_timer( metrics_, SearchMetrics::Stage::COLLECT_DOCUMENTS );
+
+                    std::pmr::vector< Document > result( resource );
+
+                    for( std::size_t ordinal = 0; ordinal < is_matched.size(); ++ordinal )
+                        {
+                            if( is_matched[ ordinal ] != 0 )
+                                {
+                                    result.push_back(
+                                            {
+                                                documents_.GetId( ordinal ),
+                                                relevances[ ordinal ],
+                                                documents_.GetRating( ordinal )
+                                            } );
+                                }
+                        }
+
+                    metrics_.Add( SearchMetrics::Counter::DOCUMENTS_SCORED, result.size() );
+
                     return result;
                 }
     };
-
@@ -0,0 +1,182 @@
+#include <limits>
+#include <stdexcept>
+
+#include "sharded_search_server.h"
+
+ShardedSearchServer::ShardedSearchServer(
+        const std::string & stop_words_text,
+        const std::size_t shard_count )
+    {
+        if( shard_count == 0 )
+            {
+                using namespace std::string_literals;
+
+                throw std::invalid_argument( "Число шардов должно быть положительным."s );
+            }
+
+        shards_.reserve( shard_count );
+
+        for( std::size_t i = 0; i < shard_count; ++i )
+            {
+                shards_.emplace_back( stop_words_text );
+            }
+    }
+
+void
+ShardedSearchServer::AddDocument(
+        const int document_id,
+        const std::string_view document,
+        const DocumentStatus status,
+        const std::vector< int > & ratings )
+    {
+        shards_[ GetShardIndex( document_id ) ].AddDocument( document_id, document, status, ratings );
+    }
+
+void
+ShardedSearchServer::RemoveDocument( const int document_id )
+    {
+        shards_[ GetShardIndex( document_id ) ].RemoveDocument( document_id );
+    }
+
+std::vector< Document >
+ShardedSearchServer::FindTopDocuments(
+        const std::string_view raw_query,
+        const DocumentStatus status,
+        const std::size_t max_result_count ) const
+    {
+        return
+                FindTopDocuments(
+                        raw_query,
+                        MakeStatusPredicate( status ),
+                        max_result_count );
+    }
+
+std::tuple< std::vector< std::string_view >, DocumentStatus >
+ShardedSearchServer::MatchDocument(
+        const std::string_view raw_query,
+        const int document_id ) const
+    {
+        return shards_[ GetShardIndex( document_id ) ].MatchDocument( raw_query, document_id );
+    }
+
+std::size_t
+ShardedSearchServer::GetDocumentFreq( const std::string_view word ) const
+    {
+        std::size_t document_freq = 0;
+
+        for( const SearchServer & shard : shards_ )
+            {
+                document_freq += shard.GetDocumentFreq( word );
+            }
+
+        return document_freq;
+    }
+
+int
+ShardedSearchServer::GetDocumentCount() const
+    {
+        int document_count = 0;
+
+        for( const SearchServer & shard : shards_ )
+            {
+                document_count += shard.GetDocumentCount();
+            }
+
+        return document_count;
+    }
+
+std::size_t
+ShardedSearchServer::GetShardCount() const
+    {
+        return shards_.size();
+    }
+
+std::size_t
+ShardedSearchServer::GetShardIndex( const int document_id ) const
+    {
+        if( document_id < 0 )
+            {
+                return 0;
+            }
+
+        return static_cast< std::size_t >( document_id ) % shards_.size();
+    }
+
+void
+ShardedSearchServer::RethrowFirstError( const std::vector< std::exception_ptr > & errors )
+    {
+        for( const std::exception_ptr & error : errors )
+            {
+                if( error )
+                    {
+                        std::rethrow_exception( error );
+                    }
+            }
+    }
+
+void
+ShardedSearchServer::AddShardRecords(
+        const std::vector< std::vector< DocumentRecord > > & shard_records,
+        const std::vector< std::vector< std::size_t > > & shard_positions )
+    {
+        std::vector< std::size_t > added_counts( shards_.size() );
+
+        const std::vector< std::exception_ptr > errors = ForEachShard(
+                shards_,
+                [&shard_records, &added_counts](
+                        SearchServer & shard,
+                        const std::size_t shard_index )
+                    {
+                        const std::vector< DocumentRecord > & records = shard_records[ shard_index ];
+
+                        const int document_count = shard.GetDocumentCount();
+
+                        try
+                            {
+                                shard.AddDocuments( records.cbegin(), records.cend() );
+                            }
+                        catch( ... )
+                            {
+                                added_counts[ shard_index ] = shard.GetDocumentCount() - document_count;
+
+                                throw;
+                            }
+
+                        added_counts[ shard_index ] = records.size();
+                    } );
+
+        // Шард принимает записи до своей первой ошибки. Выбрасывается ошибка самой ранней
+        // записи, а документы других шардов, стоящие после неё, удаляются.
+        std::size_t error_position = std::numeric_limits< std::size_t >::max();
+        std::exception_ptr error;
+
+        for( std::size_t i = 0; i < shards_.size(); ++i )
+            {
+                if(
+                        errors[ i ]
+                        &&
+                        shard_positions[ i ][ added_counts[ i ] ] < error_position )
+                    {
+                        error_position = shard_positions[ i ][ added_counts[ i ] ];
+                        error = errors[ i ];
+                    }
+            }
+
+        if( !error )
+            {
+                return;
+            }
+
+        for( std::size_t i = 0; i < shards_.size(); ++i )
+            {
+                for( std::size_t j = 0; j < added_counts[ i ]; ++j )
+                    {
+                        if( shard_positions[ i ][ j ] > error_position )
+                            {
+                                shards_[ i ].RemoveDocument( shard_records[ i ][ j ].id );
+                            }
+                    }
+            }
+
+        std::rethrow_exception( error );
+    }
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <execution>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+
+// Корпус, разделённый по id документов между несколькими серверами-шардами.
+//
+// Документ с id попадает в шард id % shard_count. Запрос рассылается всем
+// шардам параллельно; каждый шард отбирает свои лучшие документы, а затем
+// их списки объединяются. IDF считается по всему корпусу: число документов
+// и документная частота слова суммируются по шардам, поэтому релевантность
+// совпадает с релевантностью единого сервера бит в бит, а с ней и результаты.
+class ShardedSearchServer
+    {
+
+        public:
+
+            explicit ShardedSearchServer(
+                    const std::string & stop_words_text,
+                    const std::size_t shard_count );
+
+            void
+            AddDocument(
+                    const int document_id,
+                    const std::string_view document,
+                    const DocumentStatus status,
+                    const std::vector< int > & ratings );
+
+            // Записи раскладываются по шардам и загружаются шардами параллельно.
+            // Результат тот же, что у SearchServer::AddDocuments: при ошибке записи
+            // предшествующие ей документы уже добавлены, последующие - нет.
+            template < typename InputIt >
+            void
+            AddDocuments(
+                    InputIt first,
+                    const InputIt last )
+                {
+                    std::vector< std::vector< DocumentRecord > > shard_records( shards_.size() );
+
+                    // Номера записей каждого шарда в исходной последовательности.
+                    std::vector< std::vector< std::size_t > > shard_positions( shards_.size() );
+
+                    for( std::size_t position = 0; first != last; ++first, ++position )
+                        {
+                            DocumentRecord record = *first;
+
+                            const std::size_t shard_index = GetShardIndex( record.id );
+
+                            shard_records[ shard_index ].push_back( std::move( record ) );
+                            shard_positions[ shard_index ].push_back( position );
+                        }
+
+                    AddShardRecords( shard_records, shard_positions );
+                }
+
+            void
+            RemoveDocument( const int document_id );
+
+            template < typename DocumentPredicate >
+            std::vector< Document >
+            FindTopDocuments(
+                    const std::string_view raw_query,
+                    const DocumentPredicate document_predicate,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const
+                {
+                    const int document_count = GetDocumentCount();
+
+                    const auto inverse_document_freq = [this, document_count]( const std::string_view word )
+                        {
+                            return
+                                    std::log(
+                                                1.0
+                                                *
+                                                document_count
+                                                /
+                                                GetDocumentFreq( word ) );
+                        };
+
+                    std::vector< std::vector< Document > > shard_documents( shards_.size() );
+
+                    RethrowFirstError(
+                            ForEachShard(
+                                    shards_,
+                                    [&](
+                                            const SearchServer & shard,
+                                            const std::size_t shard_index )
+                                        {
+                                            std::vector< Document > & documents = shard_documents[ shard_index ];
+
+                                            documents = shard.FindAllDocuments(
+                                                    raw_query,
+                                                    document_predicate,
+                                                    inverse_document_freq );
+
+                                            SearchServer::SelectTopDocuments( documents, max_result_count );
+                                        } ) );
+
+                    std::vector< Document > matched_documents;
+
+                    for( const std::vector< Document > & documents : shard_documents )
+                        {
+                            matched_documents.insert( matched_documents.end(), documents.cbegin(), documents.cend() );
+                        }
+
+                    SearchServer::SelectTopDocuments( matched_documents, max_result_count );
+
+                    return matched_documents;
+                }
+
+            std::vector< Document >
+            FindTopDocuments(
+                    const std::string_view raw_query,
+                    const DocumentStatus status = DocumentStatus::ACTUAL,
+                    const std::size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT ) const;
+
+            std::tuple< std::vector< std::string_view >, DocumentStatus >
+            MatchDocument(
+                    const std::string_view raw_query,
+                    const int document_id ) const;
+
+            // Число документов, содержащих слово, во всех шардах.
+            std::size_t
+            GetDocumentFreq( const std::string_view word ) const;
+
+            int
+            GetDocumentCount() const;
+
+            std::size_t
+            GetShardCount() const;
+
+        private:
+
+            std::vector< SearchServer > shards_;
+
+            // Отрицательный id направляется в первый шард: тот отвергнет его
+            // с тем же сообщением, что и единый сервер.
+            std::size_t
+            GetShardIndex( const int document_id ) const;
+
+            // Выполняет function( shard, shard_index ) для всех шардов параллельно.
+            // Исключение из параллельного алгоритма завершило бы программу, поэтому
+            // исключения шардов перехватываются и возвращаются по номерам шардов.
+            template < typename Shards, typename Function >
+            static std::vector< std::exception_ptr >
+            ForEachShard(
+                    Shards & shards,
+                    const Function & function )
+                {
+                    std::vector< std::exception_ptr > errors( shards.size() );
+
+                    std::vector< std::size_t > shard_indices( shards.size() );
+                    std::iota( shard_indices.begin(), shard_indices.end(), 0 );
+
+                    std::for_each(
+                            std::execution::par,
+                            shard_indices.cbegin(),
+                            shard_indices.cend(),
+                            [&shards, &function, &errors]( const std::size_t shard_index )
+                                {
+                                    try
+                                        {
+                                            function( shards[ shard_index ], shard_index );
+                                        }
+                                    catch( ... )
+                                        {
+                                            errors[ shard_index ] = std::current_exception();
+                                        }
+                                } );
+
+                    return errors;
+                }
+
+            static void
+            RethrowFirstError( const std::vector< std::exception_ptr > & errors );
+
+            void
+            AddShardRecords(
+                    const std::vector< std::vector< DocumentRecord > > & shard_records,
+                    const std::vector< std::vector< std::size_t > > & shard_positions );
+    };
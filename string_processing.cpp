@@ -1,26 +1,92 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include "byte_scan.h"
 #include "string_processing.h"
 
-bool
-IsValidWord( const std::string & raw_word )
+namespace
     {
-        return
-                std::none_of(
-                        raw_word.cbegin(),
-                        raw_word.cend(),
-                        []( const char c )
+        void
+        ThrowInvalidCharacters()
+            {
+                using namespace std::string_literals;
+
+                throw std::invalid_argument(
+                        "В словах поискового запроса есть"s
+                        +
+                        " недопустимые символы с кодами от 0 до 31."s );
+            }
+
+        void
+        ValidateRawWordHyphens( const std::string_view raw_word )
+            {
+                if( !IsValidSingleHyphenWord( raw_word ) )
+                    {
+                        using namespace std::string_literals;
+
+                        throw std::invalid_argument(
+                                "Отсутствие текста после символа 'минус'."s );
+                    }
+
+                if( !IsValidMultiHyphenWord( raw_word ) )
+                    {
+                        using namespace std::string_literals;
+
+                        throw std::invalid_argument(
+                                "Наличие более чем одного минуса перед словами,"s
+                                +
+                                " которых не должно быть в искомых документах."s );
+                    }
+            }
+
+        // Добавляет слова текста в words.
+        template < typename Words >
+        void
+        AppendWords(
+                const std::string_view raw_text,
+                Words & words )
+            {
+                const char * const text_end = raw_text.data() + raw_text.size();
+
+                // Один проход по тексту: FindByteAtMost( ..., ' ' ) останавливается
+                // и на пробеле, и на недопустимом символе внутри слова.
+                for( const char * word_begin = raw_text.data(); ; )
+                    {
+                        const char * const word_end = FindByteAtMost( word_begin, text_end, ' ' );
+
+                        if(
+                                word_end != text_end
+                                &&
+                                *word_end != ' ' )
                             {
-                                return
-                                        ( c >= '\0' )
-                                        &&
-                                        ( c < ' ' );
-                            } );
+                                ThrowInvalidCharacters();
+                            }
+
+                        const std::string_view raw_word( word_begin, word_end - word_begin );
+
+                        ValidateRawWordHyphens( raw_word );
+                        words.push_back( raw_word );
+
+                        if( word_end == text_end )
+                            {
+                                break;
+                            }
+
+                        word_begin = word_end + 1;
+                    }
+            }
     }
 
 bool
-IsValidMultiHyphenWord( const std::string & raw_word )
+IsValidWord( const std::string_view raw_word )
+    {
+        const char * end = raw_word.data() + raw_word.size();
+
+        return FindByteAtMost( raw_word.data(), end, ' ' - 1 ) == end;
+    }
+
+bool
+IsValidMultiHyphenWord( const std::string_view raw_word )
     {
         return
                 !(
@@ -33,7 +99,7 @@ IsValidMultiHyphenWord( const std::string & raw_word )
     }
 
 bool
-IsValidSingleHyphenWord( const std::string & raw_word )
+IsValidSingleHyphenWord( const std::string_view raw_word )
     {
         return
                 !(
@@ -44,61 +110,34 @@ IsValidSingleHyphenWord( const std::string & raw_word )
     }
 
 void
-ValidateRawWord( const std::string & raw_word )
+ValidateRawWord( const std::string_view raw_word )
     {
         if( !IsValidWord( raw_word ) )
             {
-                using namespace std::string_literals;
-
-                throw std::invalid_argument(
-                        "В словах поискового запроса есть"s
-                        +
-                        " недопустимые символы с кодами от 0 до 31."s );
+                ThrowInvalidCharacters();
             }
 
-        if( !IsValidSingleHyphenWord( raw_word ) )
-            {
-                using namespace std::string_literals;
+        ValidateRawWordHyphens( raw_word );
+    }
 
-                throw std::invalid_argument(
-                        "Отсутствие текста после символа 'минус'."s );
-            }
+std::vector< std::string_view >
+SplitIntoWords( const std::string_view raw_text )
+    {
+        std::vector< std::string_view > words;
 
-        if( !IsValidMultiHyphenWord( raw_word ) )
-            {
-                using namespace std::string_literals;
+        AppendWords( raw_text, words );
 
-                throw std::invalid_argument(
-                        "Наличие более чем одного минуса перед словами,"s
-                        +
-                        " которых не должно быть в искомых документах."s );
-            }
+        return words;
     }
 
-std::vector< std::string >
-SplitIntoWords( const std::string & raw_text )
+std::pmr::vector< std::string_view >
+SplitIntoWords(
+        const std::string_view raw_text,
+        std::pmr::memory_resource * const resource )
     {
-        std::vector< std::string > words;
-
-        std::string raw_word;
-
-        for( const char c : raw_text )
-            {
-                if( c == ' ' )
-                    {
-                        ValidateRawWord( raw_word );
-                        words.push_back( raw_word );
-                        raw_word.clear();
-                    }
-                else
-                    {
-                        raw_word += c;
-                    }
-            }
+        std::pmr::vector< std::string_view > words( resource );
 
-        ValidateRawWord( raw_word );
-        words.push_back( raw_word );
+        AppendWords( raw_text, words );
 
         return words;
     }
-
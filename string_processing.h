@@ -1,31 +1,40 @@
 #pragma once
 
 #include <algorithm>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 bool
-IsValidWord( const std::string & raw_word );
+IsValidWord( const std::string_view raw_word );
 
 bool
-IsValidMultiHyphenWord( const std::string & raw_word );
+IsValidMultiHyphenWord( const std::string_view raw_word );
 
 bool
-IsValidSingleHyphenWord( const std::string & raw_word );
+IsValidSingleHyphenWord( const std::string_view raw_word );
 
 void
-ValidateRawWord( const std::string & raw_word );
+ValidateRawWord( const std::string_view raw_word );
 
 template < typename StopWordsCollection >
 void
 ValidateRawWordsCollection( const StopWordsCollection & raw_stop_words )
     {
-        for( const std::string & raw_word : raw_stop_words )
+        for( const std::string_view raw_word : raw_stop_words )
             {
                 ValidateRawWord( raw_word );
             }
     }
 
-std::vector< std::string >
-SplitIntoWords( const std::string & raw_text );
+// Возвращает слова текста как срезы исходной строки, без копирования.
+// Срезы действительны, пока жива строка, на которую ссылается raw_text.
+std::vector< std::string_view >
+SplitIntoWords( const std::string_view raw_text );
 
+// То же, но вектор срезов размещается в resource.
+std::pmr::vector< std::string_view >
+SplitIntoWords(
+        const std::string_view raw_text,
+        std::pmr::memory_resource * const resource );
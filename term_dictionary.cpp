@@ -0,0 +1,158 @@
+#include <stdexcept>
+#include <utility>
+
+#include "term_dictionary.h"
+
+TermDictionary::TermDictionary(
+        const std::uint64_t * word_offsets,
+        const char * word_chars,
+        const TermId term_count,
+        const TermId sorted_prefix_size )
+    :
+          word_offsets_( word_offsets )
+        , word_chars_( word_chars )
+        , mapped_term_count_( term_count )
+        , sorted_prefix_size_( sorted_prefix_size )
+    {}
+
+TermDictionary::TermDictionary( const TermDictionary & other )
+    :
+          words_( other.words_ )
+        , word_offsets_( other.word_offsets_ )
+        , word_chars_( other.word_chars_ )
+        , mapped_term_count_( other.mapped_term_count_ )
+        , sorted_prefix_size_( other.sorted_prefix_size_ )
+    {
+        term_ids_.reserve( words_.size() );
+
+        for( TermId term = 0; term < words_.size(); ++term )
+            {
+                term_ids_.emplace( words_[ term ], term );
+            }
+    }
+
+TermDictionary::TermDictionary( TermDictionary && other )
+    {
+        *this = std::move( other );
+    }
+
+TermDictionary &
+TermDictionary::operator=( TermDictionary && other )
+    {
+        words_ = std::exchange( other.words_, {} );
+        term_ids_ = std::exchange( other.term_ids_, {} );
+        word_offsets_ = std::exchange( other.word_offsets_, nullptr );
+        word_chars_ = std::exchange( other.word_chars_, nullptr );
+        mapped_term_count_ = std::exchange( other.mapped_term_count_, 0 );
+        sorted_prefix_size_ = std::exchange( other.sorted_prefix_size_, 0 );
+
+        return *this;
+    }
+
+TermId
+TermDictionary::Intern( const std::string_view word )
+    {
+        if( word_offsets_ != nullptr )
+            {
+                throw std::logic_error( "Словарь, загруженный из снимка, доступен только для чтения." );
+            }
+
+        const auto it = term_ids_.find( word );
+
+        if( it != term_ids_.cend() )
+            {
+                return it->second;
+            }
+
+        const TermId term = static_cast< TermId >( words_.size() );
+
+        words_.emplace_back( word );
+        term_ids_.emplace( words_.back(), term );
+
+        return term;
+    }
+
+TermId
+TermDictionary::Find( const std::string_view word ) const
+    {
+        if( word_offsets_ != nullptr )
+            {
+                const TermId term = FindMapped( word, 0, sorted_prefix_size_ );
+
+                return
+                        term != NO_TERM
+                        ?
+                        term
+                        :
+                        FindMapped( word, sorted_prefix_size_, mapped_term_count_ );
+            }
+
+        const auto it = term_ids_.find( word );
+
+        if( it == term_ids_.cend() )
+            {
+                return NO_TERM;
+            }
+
+        return it->second;
+    }
+
+std::string_view
+TermDictionary::GetWord( const TermId term ) const
+    {
+        if( word_offsets_ != nullptr )
+            {
+                return
+                        std::string_view(
+                                word_chars_ + word_offsets_[ term ],
+                                word_offsets_[ term + 1 ] - word_offsets_[ term ] );
+            }
+
+        return words_[ term ];
+    }
+
+std::size_t
+TermDictionary::size() const
+    {
+        if( word_offsets_ != nullptr )
+            {
+                return mapped_term_count_;
+            }
+
+        return words_.size();
+    }
+
+TermId
+TermDictionary::FindMapped(
+        const std::string_view word,
+        TermId first,
+        const TermId last ) const
+    {
+        TermId count = last - first;
+
+        while( count > 0 )
+            {
+                const TermId step = count / 2;
+                const TermId middle = first + step;
+
+                if( GetWord( middle ) < word )
+                    {
+                        first = middle + 1;
+                        count -= step + 1;
+                    }
+                else
+                    {
+                        count = step;
+                    }
+            }
+
+        if(
+                first < last
+                &&
+                GetWord( first ) == word )
+            {
+                return first;
+            }
+
+        return NO_TERM;
+    }
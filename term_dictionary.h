@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using TermId = std::uint32_t;
+
+// Словарь, сопоставляющий каждому слову плотный целочисленный id.
+// Id назначаются по порядку добавления и не переиспользуются,
+// поэтому их можно использовать как индексы массивов.
+//
+// Словарь может ссылаться на слова снимка индекса: тогда он доступен только для чтения,
+// а слова с id [0; sorted_prefix_size) и [sorted_prefix_size; size) упорядочены по алфавиту
+// и ищутся двоичным поиском.
+class TermDictionary
+    {
+
+        public:
+
+            static constexpr TermId NO_TERM = UINT32_MAX;
+
+            TermDictionary() = default;
+
+            // Копия строит собственную таблицу поиска по своим словам.
+            TermDictionary( const TermDictionary & other );
+
+            // Слова не перемещаются, и ключи таблицы поиска остаются действительными.
+            // Источник становится пустым собственным словарём.
+            TermDictionary( TermDictionary && other );
+
+            TermDictionary &
+            operator=( const TermDictionary & other ) = delete;
+
+            TermDictionary &
+            operator=( TermDictionary && other );
+
+            TermDictionary(
+                    const std::uint64_t * word_offsets,
+                    const char * word_chars,
+                    const TermId term_count,
+                    const TermId sorted_prefix_size );
+
+            TermId
+            Intern( const std::string_view word );
+
+            TermId
+            Find( const std::string_view word ) const;
+
+            std::string_view
+            GetWord( const TermId term ) const;
+
+            std::size_t
+            size() const;
+
+        private:
+
+            // deque не перемещает элементы при добавлении,
+            // поэтому ключи term_ids_ остаются действительными.
+            std::deque< std::string > words_;
+
+            std::unordered_map< std::string_view, TermId > term_ids_;
+
+            // Слово id лежит в word_chars_[ word_offsets_[ id ]; word_offsets_[ id + 1 ] ).
+            const std::uint64_t * word_offsets_ = nullptr;
+
+            const char * word_chars_ = nullptr;
+
+            TermId mapped_term_count_ = 0;
+
+            TermId sorted_prefix_size_ = 0;
+
+            TermId
+            FindMapped(
+                    const std::string_view word,
+                    TermId first,
+                    const TermId last ) const;
+    };
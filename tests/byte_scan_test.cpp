@@ -0,0 +1,123 @@
+// Тесты FindByteAtMost: все реализации совпадают с побайтовым поиском.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh byte_scan_test
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "byte_scan.h"
+#include "test_framework.h"
+
+namespace
+    {
+        const char *
+        FindByteAtMostReference(
+                const char * begin,
+                const char * end,
+                const unsigned char limit )
+            {
+                return std::find_if(
+                        begin,
+                        end,
+                        [limit]( const char byte )
+                            {
+                                return static_cast< unsigned char >( byte ) <= limit;
+                            } );
+            }
+
+        void
+        AssertSameAsReference(
+                const std::vector< char > & bytes,
+                const std::size_t offset,
+                const std::size_t size,
+                const unsigned char limit )
+            {
+                const char * const begin = bytes.data() + offset;
+                const char * const end = begin + size;
+
+                const char * const expected = FindByteAtMostReference( begin, end, limit );
+
+                ASSERT( FindByteAtMost( begin, end, limit ) == expected );
+                ASSERT( FindByteAtMostScalar( begin, end, limit ) == expected );
+
+#if defined( BYTE_SCAN_HAS_SSE2 )
+                ASSERT( FindByteAtMostSse2( begin, end, limit ) == expected );
+#endif
+
+#if defined( BYTE_SCAN_HAS_AVX2 )
+                if( IsAvx2Supported() )
+                    {
+                        ASSERT( FindByteAtMostAvx2( begin, end, limit ) == expected );
+                    }
+#endif
+            }
+
+        void
+        TestImplementationsMatchReference()
+            {
+                std::mt19937 generator( 19 );
+
+                std::vector< char > bytes( 512 );
+
+                for( int round = 0; round < 2000; ++round )
+                    {
+                        // Редкие искомые байты среди байтов выше предела, в том числе
+                        // с кодами от 128: сравнение должно быть беззнаковым.
+                        const unsigned char limit = round % 4 == 0 ? ' ' : round % 4 == 1 ? 31 : static_cast< unsigned char >( generator() );
+
+                        // Выше предела 255 байтов нет; этот случай - в TestLimitBounds.
+                        if( limit == 255 )
+                            {
+                                continue;
+                            }
+
+                        for( char & byte : bytes )
+                            {
+                                byte = static_cast< char >( generator() % 64 == 0 ? generator() % ( limit + 1 ) : limit + 1 + generator() % ( 255 - limit ) );
+                            }
+
+                        // Все выравнивания начала и длины по обе стороны ширины векторов.
+                        const std::size_t offset = generator() % 64;
+                        const std::size_t size = generator() % ( bytes.size() - offset + 1 );
+
+                        AssertSameAsReference( bytes, offset, size, limit );
+                    }
+
+                for( std::size_t offset = 0; offset < 64; ++offset )
+                    {
+                        for( std::size_t size = 0; offset + size <= 160; ++size )
+                            {
+                                std::vector< char > words( 160, 'a' );
+
+                                if( size > 0 )
+                                    {
+                                        words[ offset + size - 1 ] = ' ';
+                                    }
+
+                                AssertSameAsReference( words, offset, size, ' ' );
+                            }
+                    }
+            }
+
+        void
+        TestLimitBounds()
+            {
+                const std::vector< char > bytes = { 'a', static_cast< char >( 0xFF ), '\0', static_cast< char >( 0x80 ) };
+
+                AssertSameAsReference( bytes, 0, bytes.size(), 0 );
+                AssertSameAsReference( bytes, 0, bytes.size(), 0x7F );
+                AssertSameAsReference( bytes, 0, bytes.size(), 0xFE );
+                AssertSameAsReference( bytes, 0, bytes.size(), 0xFF );
+                AssertSameAsReference( bytes, 3, 1, 0x7F );
+                AssertSameAsReference( bytes, 3, 1, 0x80 );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestImplementationsMatchReference );
+        RUN_TEST( TestLimitBounds );
+    }
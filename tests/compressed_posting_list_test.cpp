@@ -0,0 +1,180 @@
+// Тесты CompressedPostingList.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh compressed_posting_list_test
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "compressed_posting_list.h"
+#include "test_framework.h"
+
+namespace
+    {
+        std::vector< std::pair< int, std::uint32_t > >
+        ToPairs( const CompressedPostingList & postings )
+            {
+                std::vector< std::pair< int, std::uint32_t > > pairs;
+
+                postings.ForEach(
+                        [&pairs]( const int document_id, const std::uint32_t term_freq_code )
+                            {
+                                pairs.emplace_back( document_id, term_freq_code );
+                            } );
+
+                return pairs;
+            }
+
+        std::vector< std::pair< int, std::uint32_t > >
+        ToPairs( const std::map< int, std::uint32_t > & reference )
+            {
+                return { reference.cbegin(), reference.cend() };
+            }
+
+        void
+        AssertSamePostings(
+                const CompressedPostingList & postings,
+                const std::map< int, std::uint32_t > & reference )
+            {
+                ASSERT_EQUAL( postings.size(), reference.size() );
+                ASSERT( ToPairs( postings ) == ToPairs( reference ) );
+
+                CompressedPostingList::Cursor cursor( postings );
+
+                for( const auto & [ document_id, term_freq_code ] : reference )
+                    {
+                        ASSERT( !cursor.IsEnd() );
+                        ASSERT_EQUAL( cursor.GetDocumentId(), document_id );
+                        ASSERT_EQUAL( cursor.GetTermFreqCode(), term_freq_code );
+
+                        cursor.Next();
+                    }
+
+                ASSERT( cursor.IsEnd() );
+
+                // Обход отрезка id: границы внутри блоков, между ними и за краями списка.
+                if( reference.empty() )
+                    {
+                        return;
+                    }
+
+                const int first_document_id = reference.cbegin()->first;
+                const int last_document_id = reference.crbegin()->first;
+
+                for( const auto & [ range_first, range_last ] : {
+                        std::pair{ first_document_id - 1, last_document_id + 1 },
+                        std::pair{ first_document_id + 1, ( first_document_id + last_document_id ) / 2 },
+                        std::pair{ ( first_document_id + last_document_id ) / 3, last_document_id - 1 },
+                        std::pair{ last_document_id, first_document_id } } )
+                    {
+                        std::vector< std::pair< int, std::uint32_t > > range_pairs;
+
+                        postings.ForEach(
+                                range_first,
+                                range_last,
+                                [&range_pairs]( const int document_id, const std::uint32_t term_freq_code )
+                                    {
+                                        range_pairs.emplace_back( document_id, term_freq_code );
+                                    } );
+
+                        const auto range_begin = reference.lower_bound( range_first );
+                        const auto range_end = range_first <= range_last ? reference.upper_bound( range_last ) : range_begin;
+
+                        ASSERT( range_pairs == ToPairs( std::map< int, std::uint32_t >( range_begin, range_end ) ) );
+                    }
+            }
+
+        void
+        TestEraseKeepsOtherPostings()
+            {
+                std::mt19937 generator( 11 );
+
+                CompressedPostingList postings;
+                std::map< int, std::uint32_t > reference;
+
+                // Большие разности id дают многобайтовые varint.
+                for( int document_id = 0; document_id < 100000; document_id += 1 + static_cast< int >( generator() % 300 ) )
+                    {
+                        const std::uint32_t term_freq_code = static_cast< std::uint32_t >( generator() % 100000 );
+
+                        postings.Insert( document_id, term_freq_code );
+                        reference[ document_id ] = term_freq_code;
+                    }
+
+                while( !reference.empty() )
+                    {
+                        auto it = reference.begin();
+                        std::advance( it, generator() % reference.size() );
+
+                        postings.Erase( it->first );
+                        reference.erase( it );
+
+                        // Отсутствующий id ничего не меняет.
+                        postings.Erase( -1 - static_cast< int >( generator() % 10 ) );
+
+                        AssertSamePostings( postings, reference );
+                    }
+            }
+
+        void
+        TestAppendAfterErase()
+            {
+                std::mt19937 generator( 5 );
+
+                CompressedPostingList postings;
+                std::map< int, std::uint32_t > reference;
+
+                int next_document_id = 0;
+
+                for( int step = 0; step < 5000; ++step )
+                    {
+                        if(
+                                reference.empty()
+                                ||
+                                generator() % 3 != 0 )
+                            {
+                                // После удаления хвоста последнего блока новые постинги
+                                // должны дописываться сразу за ним.
+                                next_document_id += 1 + static_cast< int >( generator() % 500 );
+
+                                postings.Insert( next_document_id, step );
+                                reference[ next_document_id ] = step;
+                            }
+                        else
+                            {
+                                const int document_id = generator() % 2 == 0 ? reference.rbegin()->first : reference.begin()->first;
+
+                                postings.Erase( document_id );
+                                reference.erase( document_id );
+                            }
+
+                        ASSERT_EQUAL( postings.Contains( next_document_id ), reference.count( next_document_id ) == 1 );
+                    }
+
+                AssertSamePostings( postings, reference );
+
+                CompressedPostingList::Cursor cursor( postings );
+                cursor.Seek( next_document_id / 2 );
+
+                const auto expected = reference.lower_bound( next_document_id / 2 );
+
+                ASSERT_EQUAL( cursor.IsEnd(), expected == reference.cend() );
+
+                if( !cursor.IsEnd() )
+                    {
+                        ASSERT_EQUAL( cursor.GetDocumentId(), expected->first );
+                    }
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestEraseKeepsOtherPostings );
+        RUN_TEST( TestAppendAfterErase );
+    }
@@ -0,0 +1,352 @@
+// Тесты ConcurrentSearchServer: результаты совпадают с SearchServer,
+// запросы выполняются во время изменения индекса.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh concurrent_search_server_test
+// Параллельные читатели стоит проверять и под санитайзерами:
+//     SANITIZE=thread tests/run_tests.sh concurrent_search_server_test
+//     SANITIZE=address tests/run_tests.sh concurrent_search_server_test
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "concurrent_search_server.h"
+#include "search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        // Текст исключения или "ok".
+        template < typename Function >
+        std::string
+        GetError( const Function & function )
+            {
+                try
+                    {
+                        function();
+                    }
+                catch( const std::exception & e )
+                    {
+                        return e.what();
+                    }
+
+                return "ok"s;
+            }
+
+        void
+        AssertSameMatches(
+                const SearchServer & server,
+                const ConcurrentSearchServer & concurrent_server,
+                const std::string & query )
+            {
+                for( int document_id = -1; document_id < 320; document_id += 7 )
+                    {
+                        std::vector< std::string_view > words;
+                        std::vector< std::string > concurrent_words;
+                        DocumentStatus status = DocumentStatus::ACTUAL;
+                        DocumentStatus concurrent_status = DocumentStatus::ACTUAL;
+
+                        const std::string error = GetError(
+                                [&]()
+                                    {
+                                        std::tie( words, status ) = server.MatchDocument( query, document_id );
+                                    } );
+
+                        const std::string concurrent_error = GetError(
+                                [&]()
+                                    {
+                                        std::tie( concurrent_words, concurrent_status ) = concurrent_server.MatchDocument( query, document_id );
+                                    } );
+
+                        ASSERT_EQUAL( error, concurrent_error );
+                        ASSERT( std::vector< std::string >( words.cbegin(), words.cend() ) == concurrent_words );
+                        ASSERT( status == concurrent_status );
+                    }
+            }
+
+        void
+        AssertSameState(
+                const SearchServer & server,
+                const ConcurrentSearchServer & concurrent_server,
+                const std::string & query,
+                const std::size_t max_result_count )
+            {
+                ASSERT_EQUAL( server.GetDocumentCount(), concurrent_server.GetDocumentCount() );
+
+                AssertSameDocuments(
+                        server.FindTopDocuments( query, DocumentStatus::ACTUAL, max_result_count ),
+                        concurrent_server.FindTopDocuments( query, DocumentStatus::ACTUAL, max_result_count ) );
+
+                const auto document_predicate = []( const int document_id, DocumentStatus, const int rating )
+                    {
+                        return document_id % 3 == 0 || rating > 2;
+                    };
+
+                AssertSameDocuments(
+                        server.FindTopDocuments( query, document_predicate, max_result_count ),
+                        concurrent_server.FindTopDocuments( query, document_predicate, max_result_count ) );
+
+                AssertSameMatches( server, concurrent_server, query );
+            }
+
+        void
+        TestMatchesSearchServer()
+            {
+                for( std::size_t segment_capacity = 1; segment_capacity <= 6; ++segment_capacity )
+                    {
+                        std::mt19937 generator( static_cast< unsigned >( segment_capacity ) );
+
+                        SearchServer server( "w0 w1"s );
+                        ConcurrentSearchServer concurrent_server( "w0 w1"s, segment_capacity );
+
+                        for( int step = 0; step < 1500; ++step )
+                            {
+                                const unsigned operation = generator() % 10;
+
+                                if( operation < 4 )
+                                    {
+                                        // Повторные и отрицательные id проверяют и тексты ошибок.
+                                        const int document_id = static_cast< int >( generator() % 310 ) - 5;
+                                        const DocumentRecord record = GenerateRecords( generator, 1, 40 ).front();
+
+                                        ASSERT_EQUAL(
+                                                GetError(
+                                                        [&]()
+                                                            {
+                                                                server.AddDocument( document_id, record.text, record.status, record.ratings );
+                                                            } ),
+                                                GetError(
+                                                        [&]()
+                                                            {
+                                                                concurrent_server.AddDocument( document_id, record.text, record.status, record.ratings );
+                                                            } ) );
+                                    }
+                                else if( operation < 5 )
+                                    {
+                                        std::vector< DocumentRecord > records = GenerateRecords( generator, static_cast< int >( generator() % 20 ), 40 );
+
+                                        for( DocumentRecord & record : records )
+                                            {
+                                                record.id = static_cast< int >( generator() % 310 ) - 2;
+                                            }
+
+                                        ASSERT_EQUAL(
+                                                GetError(
+                                                        [&]()
+                                                            {
+                                                                server.AddDocuments( records.cbegin(), records.cend() );
+                                                            } ),
+                                                GetError(
+                                                        [&]()
+                                                            {
+                                                                concurrent_server.AddDocuments( records.cbegin(), records.cend() );
+                                                            } ) );
+                                    }
+                                else if( operation < 7 )
+                                    {
+                                        const int document_id = static_cast< int >( generator() % 310 );
+
+                                        server.RemoveDocument( document_id );
+                                        concurrent_server.RemoveDocument( document_id );
+                                    }
+                                else
+                                    {
+                                        AssertSameState( server, concurrent_server, GenerateQuery( generator, 40 ), 1 + generator() % 8 );
+                                    }
+                            }
+                    }
+            }
+
+        void
+        TestQueriesDuringModification()
+            {
+                ConcurrentSearchServer concurrent_server( "w0"s, 8 );
+
+                constexpr int document_count = 3000;
+
+                std::atomic< bool > is_stopping{ false };
+                std::atomic< long > query_count{ 0 };
+
+                std::vector< std::thread > readers;
+
+                for( unsigned seed = 0; seed < 4; ++seed )
+                    {
+                        readers.emplace_back(
+                                [&concurrent_server, &is_stopping, &query_count, seed]()
+                                    {
+                                        std::mt19937 generator( seed );
+
+                                        while( !is_stopping )
+                                            {
+                                                const std::string query = GenerateQuery( generator, 50 );
+
+                                                const std::vector< Document > documents = concurrent_server.FindTopDocuments( query );
+
+                                                for( std::size_t i = 0; i < documents.size(); ++i )
+                                                    {
+                                                        ASSERT( documents[ i ].id >= 0 && documents[ i ].id < document_count );
+                                                        ASSERT( std::isfinite( documents[ i ].relevance ) );
+                                                        ASSERT( i == 0 || documents[ i ].relevance <= documents[ i - 1 ].relevance + 1e-6 );
+                                                    }
+
+                                                const int document_id = static_cast< int >( generator() % document_count );
+
+                                                // Документ мог быть удалён или ещё не добавлен.
+                                                try
+                                                    {
+                                                        concurrent_server.MatchDocument( query, document_id );
+                                                    }
+                                                catch( const std::out_of_range & )
+                                                    {
+                                                    }
+
+                                                ASSERT( concurrent_server.GetDocumentCount() >= 0 );
+
+                                                ++query_count;
+                                            }
+                                    } );
+                    }
+
+                SearchServer server( "w0"s );
+                std::mt19937 generator( 99 );
+
+                for( int document_id = 0; document_id < document_count; ++document_id )
+                    {
+                        const DocumentRecord record = GenerateRecords( generator, 1, 50 ).front();
+
+                        server.AddDocument( document_id, record.text, DocumentStatus::ACTUAL, record.ratings );
+                        concurrent_server.AddDocument( document_id, record.text, DocumentStatus::ACTUAL, record.ratings );
+
+                        if( document_id % 5 == 0 )
+                            {
+                                const int removed_id = static_cast< int >( generator() % ( document_id + 1 ) );
+
+                                server.RemoveDocument( removed_id );
+                                concurrent_server.RemoveDocument( removed_id );
+                            }
+                    }
+
+                is_stopping = true;
+
+                for( std::thread & reader : readers )
+                    {
+                        reader.join();
+                    }
+
+                ASSERT( query_count > 0 );
+
+                for( int i = 0; i < 100; ++i )
+                    {
+                        AssertSameState( server, concurrent_server, GenerateQuery( generator, 50 ), 5 );
+                    }
+            }
+
+        void
+        TestMergesKeepResults()
+            {
+                std::mt19937 generator( 41 );
+
+                SearchServer server( "w0"s );
+                ConcurrentSearchServer concurrent_server( "w0"s, 2 );
+
+                const std::vector< DocumentRecord > records = GenerateRecords( generator, 600, 40 );
+
+                for( const DocumentRecord & record : records )
+                    {
+                        server.AddDocument( record.id, record.text, record.status, record.ratings );
+                        concurrent_server.AddDocument( record.id, record.text, record.status, record.ratings );
+                    }
+
+                concurrent_server.WaitForMerges();
+
+                // 300 замороженных сегментов по 2 документа сливаются по ярусам:
+                // в каждом ярусе остаётся меньше MERGE_FACTOR сегментов.
+                const std::size_t merged_segment_count = concurrent_server.GetSegmentCount();
+
+                ASSERT( merged_segment_count < 5 * ConcurrentSearchServer::MERGE_FACTOR );
+
+                for( int i = 0; i < 50; ++i )
+                    {
+                        AssertSameState( server, concurrent_server, GenerateQuery( generator, 40 ), 5 );
+                    }
+
+                // Сегменты, где удалена большая часть документов, переписываются
+                // без отмеченных документов; результаты не меняются.
+                for( std::size_t i = 0; i < records.size(); ++i )
+                    {
+                        if( i % 4 != 0 )
+                            {
+                                server.RemoveDocument( records[ i ].id );
+                                concurrent_server.RemoveDocument( records[ i ].id );
+                            }
+                    }
+
+                concurrent_server.WaitForMerges();
+
+                ASSERT( concurrent_server.GetSegmentCount() <= merged_segment_count );
+
+                for( int i = 0; i < 50; ++i )
+                    {
+                        AssertSameState( server, concurrent_server, GenerateQuery( generator, 40 ), 5 );
+                    }
+            }
+
+        void
+        TestManyRemovalsFromOneSegment()
+            {
+                std::mt19937 generator( 47 );
+
+                SearchServer server( "w0"s );
+                ConcurrentSearchServer concurrent_server( "w0"s, 2000 );
+
+                std::vector< DocumentRecord > records = GenerateRecords( generator, 2000, 40 );
+
+                // Один замороженный сегмент: отметки копятся в нём уровнями,
+                // а после удаления половины сегмент переписывается во время удалений.
+                concurrent_server.AddDocuments( records.cbegin(), records.cend() );
+                server.AddDocuments( records.cbegin(), records.cend() );
+
+                ASSERT_EQUAL( concurrent_server.GetSegmentCount(), 1u );
+
+                std::shuffle( records.begin(), records.end(), generator );
+
+                for( std::size_t i = 0; i < 1500; ++i )
+                    {
+                        server.RemoveDocument( records[ i ].id );
+                        concurrent_server.RemoveDocument( records[ i ].id );
+
+                        if( i % 100 == 0 )
+                            {
+                                AssertSameState( server, concurrent_server, GenerateQuery( generator, 40 ), 5 );
+                            }
+                    }
+
+                concurrent_server.WaitForMerges();
+
+                for( int i = 0; i < 50; ++i )
+                    {
+                        AssertSameState( server, concurrent_server, GenerateQuery( generator, 40 ), 5 );
+                    }
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestMatchesSearchServer );
+        RUN_TEST( TestQueriesDuringModification );
+        RUN_TEST( TestMergesKeepResults );
+        RUN_TEST( TestManyRemovalsFromOneSegment );
+    }
@@ -0,0 +1,59 @@
+// Тесты DocumentBitmap.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh document_bitmap_test
+
+#include <cstddef>
+#include <random>
+#include <set>
+
+#include "document_bitmap.h"
+#include "test_framework.h"
+
+namespace
+    {
+        void
+        TestContainsInsertedOrdinals()
+            {
+                std::mt19937 generator( 59 );
+
+                for( const std::size_t document_count : { 1u, 63u, 64u, 65u, 1000u } )
+                    {
+                        DocumentBitmap bitmap( document_count );
+
+                        std::set< std::size_t > ordinals = { 0, document_count - 1 };
+
+                        for( int i = 0; i < 20; ++i )
+                            {
+                                ordinals.insert( generator() % document_count );
+                            }
+
+                        for( const std::size_t ordinal : ordinals )
+                            {
+                                bitmap.Insert( ordinal );
+                            }
+
+                        // Номера за пределами множества тоже проверяются.
+                        for( std::size_t ordinal = 0; ordinal < document_count + 130; ++ordinal )
+                            {
+                                ASSERT_EQUAL( bitmap.Contains( ordinal ), ordinals.count( ordinal ) > 0 );
+                            }
+                    }
+            }
+
+        void
+        TestEmptyBitmap()
+            {
+                const DocumentBitmap bitmap;
+
+                ASSERT( !bitmap.Contains( 0 ) );
+                ASSERT( !bitmap.Contains( 1000 ) );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestContainsInsertedOrdinals );
+        RUN_TEST( TestEmptyBitmap );
+    }
@@ -0,0 +1,253 @@
+// Тесты DocumentStore: поиск номеров документов по таблице и двоичным поиском.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh document_store_test
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "document_store.h"
+#include "search_server.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        using Reference = std::map< int, std::pair< int, DocumentStatus > >;
+
+        void
+        AssertSameAsReference(
+                const DocumentStore & store,
+                const Reference & reference,
+                const std::vector< int > & absent_ids )
+            {
+                ASSERT_EQUAL( store.size(), reference.size() );
+                ASSERT( store.GetOrdinalCount() >= store.size() );
+
+                const std::vector< int > ids( store.begin(), store.end() );
+
+                ASSERT_EQUAL( ids.size(), reference.size() );
+
+                // Номера возрастают вместе с id; до уплотнения среди них есть пропуски
+                // на месте удалённых документов.
+                std::size_t index = 0;
+                std::size_t previous_ordinal = 0;
+
+                for( const auto & [ document_id, metadata ] : reference )
+                    {
+                        const std::size_t ordinal = store.FindOrdinal( document_id );
+
+                        ASSERT( ordinal < store.GetOrdinalCount() );
+                        ASSERT( index == 0 || ordinal > previous_ordinal );
+
+                        ASSERT_EQUAL( ids[ index ], document_id );
+                        ASSERT_EQUAL( store.GetNthId( index ), document_id );
+                        ASSERT_EQUAL( store.GetId( ordinal ), document_id );
+                        ASSERT_EQUAL( store.GetRating( ordinal ), metadata.first );
+                        ASSERT( store.GetStatus( ordinal ) == metadata.second );
+                        ASSERT( store.Contains( document_id ) );
+
+                        previous_ordinal = ordinal;
+                        ++index;
+                    }
+
+                for( const int document_id : absent_ids )
+                    {
+                        if( reference.count( document_id ) == 0 )
+                            {
+                                ASSERT_EQUAL( store.FindOrdinal( document_id ), DocumentStore::NO_ORDINAL );
+                                ASSERT( !store.Contains( document_id ) );
+                            }
+                    }
+            }
+
+        // Плотные id читаются из таблицы; разреженные и отрицательные id
+        // переводят хранилище на двоичный поиск и обратно.
+        void
+        TestLookupsMatchReference()
+            {
+                std::mt19937 generator( 61 );
+
+                DocumentStore store;
+                Reference reference;
+
+                const std::vector< int > absent_ids = { -100000, -1, 0, 1, 5, 1023, 1024, 2047, 2048, 5000, 100000, 1 << 30 };
+
+                for( int step = 0; step < 6000; ++step )
+                    {
+                        const unsigned operation = generator() % 10;
+
+                        if( operation < 6 )
+                            {
+                                // Разреженные и отрицательные id появляются только в середине прогона.
+                                const bool is_sparse = step > 2000 && step < 4000 && generator() % 20 == 0;
+
+                                const int document_id = is_sparse
+                                        ? static_cast< int >( generator() % 2000000 ) - 1000000
+                                        : static_cast< int >( generator() % ( 2 * reference.size() + 16 ) );
+
+                                if( reference.count( document_id ) == 0 )
+                                    {
+                                        const int rating = static_cast< int >( generator() % 11 ) - 5;
+                                        const DocumentStatus status = static_cast< DocumentStatus >( generator() % 4 );
+
+                                        store.Add( document_id, rating, status );
+                                        reference[ document_id ] = { rating, status };
+                                    }
+                            }
+                        else if( !reference.empty() )
+                            {
+                                const auto it = std::next( reference.begin(), generator() % reference.size() );
+
+                                store.Remove( it->first );
+                                reference.erase( it );
+                            }
+
+                        if( step == 4000 )
+                            {
+                                // Без разреженных id хранилище снова может читать таблицу.
+                                for( auto it = reference.begin(); it != reference.end(); )
+                                    {
+                                        if( it->first < 0 || it->first > 100000 )
+                                            {
+                                                store.Remove( it->first );
+                                                it = reference.erase( it );
+                                            }
+                                        else
+                                            {
+                                                ++it;
+                                            }
+                                    }
+                            }
+
+                        // Удаление отсутствующего документа ничего не меняет.
+                        const int absent_id = absent_ids[ generator() % absent_ids.size() ];
+
+                        if( reference.count( absent_id ) == 0 )
+                            {
+                                store.Remove( absent_id );
+                            }
+
+                        if( step % 50 == 0 )
+                            {
+                                AssertSameAsReference( store, reference, absent_ids );
+                            }
+                    }
+
+                AssertSameAsReference( store, reference, absent_ids );
+
+                // Копия не зависит от источника.
+                const DocumentStore copy = store;
+
+                store.Add( 1 << 20, 1, DocumentStatus::ACTUAL );
+
+                AssertSameAsReference( copy, reference, absent_ids );
+            }
+
+        void
+        TestMappedStoreIsReadOnly()
+            {
+                const std::vector< int > ids = { -5, 2, 7, 100000 };
+                const std::vector< int > ratings = { 1, 2, 3, 4 };
+                const std::vector< DocumentStatus > statuses( ids.size(), DocumentStatus::BANNED );
+
+                DocumentStore store( ids.data(), ratings.data(), statuses.data(), ids.size() );
+
+                Reference reference;
+
+                for( std::size_t i = 0; i < ids.size(); ++i )
+                    {
+                        reference[ ids[ i ] ] = { ratings[ i ], statuses[ i ] };
+                    }
+
+                AssertSameAsReference( store, reference, { -6, 0, 3, 99999, 100001 } );
+
+                ASSERT_THROWS( store.Add( 3, 1, DocumentStatus::ACTUAL ), std::logic_error );
+                ASSERT_THROWS( store.Remove( 2 ), std::logic_error );
+            }
+
+        void
+        TestServerDocumentIds()
+            {
+                SearchServer server( "и"s );
+
+                const std::vector< int > ids = { 5, 0, 100000, 3, 70 };
+
+                for( const int document_id : ids )
+                    {
+                        server.AddDocument( document_id, "кот и пёс"s, DocumentStatus::ACTUAL, { 1 } );
+                    }
+
+                server.RemoveDocument( 3 );
+
+                const std::vector< int > expected_ids = { 0, 5, 70, 100000 };
+
+                ASSERT_EQUAL( std::vector< int >( server.begin(), server.end() ), expected_ids );
+
+                for( std::size_t i = 0; i < expected_ids.size(); ++i )
+                    {
+                        ASSERT_EQUAL( server.GetDocumentId( static_cast< int >( i ) ), expected_ids[ i ] );
+                    }
+
+                ASSERT_THROWS( server.GetDocumentId( -1 ), std::out_of_range );
+                ASSERT_THROWS( server.GetDocumentId( 4 ), std::out_of_range );
+            }
+
+        void
+        TestRemovalMarksAndCompacts()
+            {
+                DocumentStore store;
+
+                for( int document_id = 0; document_id < 100; ++document_id )
+                    {
+                        store.Add( document_id, document_id, DocumentStatus::ACTUAL );
+                    }
+
+                for( int document_id = 0; document_id < 50; ++document_id )
+                    {
+                        store.Remove( document_id );
+                    }
+
+                // Удалённые документы только отмечены: номера остальных не сдвинулись.
+                ASSERT_EQUAL( store.size(), 50u );
+                ASSERT_EQUAL( store.GetOrdinalCount(), 100u );
+                ASSERT_EQUAL( store.FindOrdinal( 70 ), 70u );
+                ASSERT_EQUAL( store.FindOrdinal( 10 ), DocumentStore::NO_ORDINAL );
+                ASSERT_EQUAL( *store.begin(), 50 );
+
+                // Документ с id отмеченного занимает его место.
+                store.Add( 10, -3, DocumentStatus::BANNED );
+
+                ASSERT_EQUAL( store.GetOrdinalCount(), 100u );
+                ASSERT_EQUAL( store.FindOrdinal( 10 ), 10u );
+                ASSERT_EQUAL( store.GetRating( 10 ), -3 );
+                ASSERT( store.GetStatus( 10 ) == DocumentStatus::BANNED );
+                ASSERT_EQUAL( *store.begin(), 10 );
+                ASSERT_EQUAL( store.GetNthId( 1 ), 50 );
+
+                // Когда отмеченных больше половины, массивы уплотняются.
+                store.Remove( std::vector< int >( { 50, 51 } ) );
+
+                ASSERT_EQUAL( store.size(), 49u );
+                ASSERT_EQUAL( store.GetOrdinalCount(), 49u );
+                ASSERT_EQUAL( store.FindOrdinal( 10 ), 0u );
+                ASSERT_EQUAL( store.FindOrdinal( 52 ), 1u );
+                ASSERT_EQUAL( store.GetId( 48 ), 99 );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestLookupsMatchReference );
+        RUN_TEST( TestMappedStoreIsReadOnly );
+        RUN_TEST( TestServerDocumentIds );
+        RUN_TEST( TestRemovalMarksAndCompacts );
+    }
@@ -0,0 +1,125 @@
+// Тесты EpochManager.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh epoch_manager_test
+// Освобождение данных, которые ещё читают, видно под AddressSanitizer,
+// гонки - под ThreadSanitizer:
+//     SANITIZE=address tests/run_tests.sh epoch_manager_test
+//     SANITIZE=thread tests/run_tests.sh epoch_manager_test
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "epoch_manager.h"
+#include "test_framework.h"
+
+namespace
+    {
+        void
+        TestRetiredEpochWaitsForActiveReaders()
+            {
+                EpochManager epochs;
+
+                ASSERT( epochs.IsQuiescent( epochs.Advance() ) );
+
+                std::uint64_t retire_epoch = 0;
+
+                    {
+                        const EpochManager::Guard guard( epochs );
+
+                        retire_epoch = epochs.Advance();
+
+                        // Читатель вошёл до замены и мог видеть заменённый объект.
+                        ASSERT( !epochs.IsQuiescent( retire_epoch ) );
+
+                        const EpochManager::Guard nested_guard( epochs );
+
+                        ASSERT( !epochs.IsQuiescent( retire_epoch ) );
+                    }
+
+                ASSERT( epochs.IsQuiescent( retire_epoch ) );
+
+                // Читатель, вошедший после замены, видит только новый объект.
+                const EpochManager::Guard late_guard( epochs );
+
+                ASSERT( epochs.IsQuiescent( retire_epoch ) );
+                ASSERT( !epochs.IsQuiescent( epochs.Advance() ) );
+            }
+
+        void
+        TestReadersNeverSeeFreedValues()
+            {
+                using Values = std::array< int, 64 >;
+
+                EpochManager epochs;
+
+                std::atomic< const Values * > published( new Values() );
+                std::atomic< bool > is_stopping{ false };
+
+                std::vector< std::thread > readers;
+
+                for( int i = 0; i < 4; ++i )
+                    {
+                        readers.emplace_back(
+                                [&epochs, &published, &is_stopping]()
+                                    {
+                                        while( !is_stopping )
+                                            {
+                                                const EpochManager::Guard guard( epochs );
+
+                                                const Values & values = *published.load();
+
+                                                // Писатель заполняет объект до публикации и не меняет после.
+                                                for( const int value : values )
+                                                    {
+                                                        ASSERT_EQUAL( value, values.front() );
+                                                    }
+                                            }
+                                    } );
+                    }
+
+                std::vector< std::pair< std::uint64_t, std::unique_ptr< const Values > > > retired;
+
+                for( int version = 1; version <= 20000; ++version )
+                    {
+                        auto values = std::make_unique< Values >();
+                        values->fill( version );
+
+                        retired.emplace_back( 0, published.exchange( values.release() ) );
+                        retired.back().first = epochs.Advance();
+
+                        std::vector< std::pair< std::uint64_t, std::unique_ptr< const Values > > > still_retired;
+
+                        for( auto & [ retire_epoch, old_values ] : retired )
+                            {
+                                if( !epochs.IsQuiescent( retire_epoch ) )
+                                    {
+                                        still_retired.emplace_back( retire_epoch, std::move( old_values ) );
+                                    }
+                            }
+
+                        retired = std::move( still_retired );
+                    }
+
+                is_stopping = true;
+
+                for( std::thread & reader : readers )
+                    {
+                        reader.join();
+                    }
+
+                delete published.load();
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestRetiredEpochWaitsForActiveReaders );
+        RUN_TEST( TestReadersNeverSeeFreedValues );
+    }
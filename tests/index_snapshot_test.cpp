@@ -0,0 +1,263 @@
+// Тесты снимка индекса: сохранение, загрузка и проверка повреждённых файлов.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh index_snapshot_test
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "index_snapshot.h"
+#include "remove_duplicates.h"
+#include "search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        std::string
+        GetSnapshotPath( const std::string & name )
+            {
+                return ( std::filesystem::temp_directory_path() / ( "index_snapshot_test_"s + name + ".bin"s ) ).string();
+            }
+
+        std::vector< char >
+        ReadFile( const std::string & path )
+            {
+                std::ifstream input( path, std::ios::binary );
+
+                return { std::istreambuf_iterator< char >( input ), std::istreambuf_iterator< char >() };
+            }
+
+        void
+        WriteFile(
+                const std::string & path,
+                const std::vector< char > & bytes )
+            {
+                std::ofstream output( path, std::ios::binary | std::ios::trunc );
+                output.write( bytes.data(), static_cast< std::streamsize >( bytes.size() ) );
+            }
+
+        // Указатель на элемент index секции section в байтах снимка.
+        template < typename T >
+        T *
+        GetElement(
+                std::vector< char > & bytes,
+                const SnapshotSection section,
+                const std::size_t index )
+            {
+                const auto * header = reinterpret_cast< const SnapshotHeader * >( bytes.data() );
+                const std::uint64_t section_offset = header->sections[ static_cast< std::size_t >( section ) ].offset;
+
+                return reinterpret_cast< T * >( bytes.data() + section_offset ) + index;
+            }
+
+        void
+        TestLoadedServerMatchesSource()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 29 );
+
+                        SearchServer server( "w0"s, format );
+
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 400, 30 );
+
+                        for( const DocumentRecord & record : records )
+                            {
+                                server.AddDocument( record.id, record.text, record.status, record.ratings );
+                            }
+
+                        for( int i = 0; i < 50; ++i )
+                            {
+                                server.RemoveDocument( records[ generator() % records.size() ].id );
+                            }
+
+                        const std::string path = GetSnapshotPath( "source"s );
+                        server.SaveSnapshot( path );
+
+                        const SearchServer loaded_server = SearchServer::LoadSnapshot( path );
+
+                        ASSERT_EQUAL( loaded_server.GetDocumentCount(), server.GetDocumentCount() );
+                        ASSERT( std::equal( loaded_server.begin(), loaded_server.end(), server.begin(), server.end() ) );
+
+                        for( int i = 0; i < 200; ++i )
+                            {
+                                const std::string query = GenerateQuery( generator, 30 );
+
+                                for( const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED } )
+                                    {
+                                        AssertSameDocuments( loaded_server.FindTopDocuments( query, status ), server.FindTopDocuments( query, status ) );
+                                    }
+
+                                const int document_id = *std::next( server.begin(), generator() % server.GetDocumentCount() );
+
+                                ASSERT( loaded_server.MatchDocument( query, document_id ) == server.MatchDocument( query, document_id ) );
+                            }
+
+                        std::filesystem::remove( path );
+                    }
+            }
+
+        void
+        TestLoadedServerIsReadOnly()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "кот в городе"s, DocumentStatus::ACTUAL, { 1 } );
+
+                const std::string path = GetSnapshotPath( "read_only"s );
+                server.SaveSnapshot( path );
+
+                SearchServer loaded_server = SearchServer::LoadSnapshot( path );
+
+                ASSERT_THROWS( loaded_server.AddDocument( 2, "пёс"s, DocumentStatus::ACTUAL, { 1 } ), std::logic_error );
+                ASSERT_THROWS( loaded_server.RemoveDocument( 1 ), std::logic_error );
+                ASSERT_EQUAL( loaded_server.GetDocumentCount(), 1 );
+                ASSERT( loaded_server.FindTopDocuments( "в"s ).empty() );
+
+                std::filesystem::remove( path );
+
+                ASSERT_THROWS( SearchServer::LoadSnapshot( path ), std::runtime_error );
+            }
+
+        void
+        TestLoadedServerRejectsWordFrequencies()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "кот в городе"s, DocumentStatus::ACTUAL, { 1 } );
+                server.AddDocument( 2, "кот в городе"s, DocumentStatus::ACTUAL, { 2 } );
+                server.AddDocument( 3, "пёс в парке"s, DocumentStatus::ACTUAL, { 3 } );
+
+                const std::string path = GetSnapshotPath( "duplicates"s );
+                server.SaveSnapshot( path );
+
+                SearchServer loaded_server = SearchServer::LoadSnapshot( path );
+
+                // Снимок не хранит слова документов: пустой словарь выдал бы все
+                // документы за дубликаты друг друга.
+                ASSERT_THROWS( loaded_server.GetWordFrequencies( 1 ), std::logic_error );
+                ASSERT_THROWS( RemoveDuplicates( loaded_server ), std::logic_error );
+                ASSERT_EQUAL( loaded_server.GetDocumentCount(), 3 );
+
+                SearchServer target( "и в на"s );
+
+                ASSERT_THROWS( target.AddDocumentFrom( loaded_server, 1 ), std::logic_error );
+                ASSERT_EQUAL( target.GetDocumentCount(), 0 );
+
+                std::filesystem::remove( path );
+            }
+
+        void
+        TestRejectsCorruptedOffsets()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "кот в городе"s, DocumentStatus::ACTUAL, { 1 } );
+                server.AddDocument( 2, "пёс в парке у дома"s, DocumentStatus::ACTUAL, { 2 } );
+
+                const std::string path = GetSnapshotPath( "corrupted"s );
+                server.SaveSnapshot( path );
+
+                const std::vector< char > bytes = ReadFile( path );
+
+                for( const SnapshotSection section : { SnapshotSection::WORD_OFFSETS, SnapshotSection::POSTING_OFFSETS } )
+                    {
+                        // Смещение в середине выходит за конец секции; последнее смещение верно.
+                        std::vector< char > corrupted = bytes;
+                        *GetElement< std::uint64_t >( corrupted, section, 4 ) = 1u << 30;
+
+                        WriteFile( path, corrupted );
+
+                        ASSERT_THROWS( SearchServer::LoadSnapshot( path ), std::runtime_error );
+
+                        corrupted = bytes;
+                        *GetElement< std::uint64_t >( corrupted, section, 0 ) = 1;
+
+                        WriteFile( path, corrupted );
+
+                        ASSERT_THROWS( SearchServer::LoadSnapshot( path ), std::runtime_error );
+                    }
+
+                WriteFile( path, bytes );
+
+                ASSERT_EQUAL( SearchServer::LoadSnapshot( path ).FindTopDocuments( "кот"s ).size(), 1u );
+
+                std::filesystem::remove( path );
+            }
+
+        void
+        TestRejectsInvalidPostingIds()
+            {
+                // Оба слова есть в обоих документах: постинги каждого слова - { 1, 2 }.
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "кот пёс"s, DocumentStatus::ACTUAL, { 1 } );
+                server.AddDocument( 2, "кот пёс"s, DocumentStatus::ACTUAL, { 2 } );
+
+                const std::string path = GetSnapshotPath( "posting_ids"s );
+                server.SaveSnapshot( path );
+
+                const std::vector< char > bytes = ReadFile( path );
+
+                const auto assert_rejected = [&path]( const std::vector< char > & corrupted )
+                    {
+                        WriteFile( path, corrupted );
+
+                        ASSERT_THROWS( SearchServer::LoadSnapshot( path ), std::runtime_error );
+                    };
+
+                // Постинги слова не возрастают.
+                std::vector< char > corrupted = bytes;
+                *GetElement< int >( corrupted, SnapshotSection::POSTING_DOCUMENT_IDS, 1 ) = 1;
+                assert_rejected( corrupted );
+
+                // Постинг ссылается на документ, которого нет в таблице.
+                corrupted = bytes;
+                *GetElement< int >( corrupted, SnapshotSection::POSTING_DOCUMENT_IDS, 1 ) = 7;
+                assert_rejected( corrupted );
+
+                // Таблица документов не упорядочена.
+                corrupted = bytes;
+                *GetElement< int >( corrupted, SnapshotSection::DOCUMENT_IDS, 0 ) = 3;
+                assert_rejected( corrupted );
+
+                WriteFile( path, bytes );
+
+                ASSERT_EQUAL( SearchServer::LoadSnapshot( path ).FindTopDocuments( "кот"s ).size(), 2u );
+
+                std::filesystem::remove( path );
+            }
+
+        void
+        TestFailedSaveRemovesTemporaryFile()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "кот в городе"s, DocumentStatus::ACTUAL, { 1 } );
+
+                // Снимок нельзя переименовать в каталог: Finish завершается ошибкой.
+                const std::string path = GetSnapshotPath( "directory"s );
+                std::filesystem::create_directory( path );
+
+                ASSERT_THROWS( server.SaveSnapshot( path ), std::runtime_error );
+                ASSERT( !std::filesystem::exists( path + ".tmp"s ) );
+
+                std::filesystem::remove( path );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestLoadedServerMatchesSource );
+        RUN_TEST( TestLoadedServerIsReadOnly );
+        RUN_TEST( TestLoadedServerRejectsWordFrequencies );
+        RUN_TEST( TestRejectsCorruptedOffsets );
+        RUN_TEST( TestRejectsInvalidPostingIds );
+        RUN_TEST( TestFailedSaveRemovesTemporaryFile );
+    }
@@ -0,0 +1,132 @@
+// Тесты кэша IDF: значения действительны только для своего поколения индекса.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh inverse_document_freq_cache_test
+
+#include <execution>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "inverse_document_freq_cache.h"
+#include "search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        void
+        TestValuesBelongToGeneration()
+            {
+                InverseDocumentFreqCache cache;
+                cache.Resize( 4 );
+
+                int compute_count = 0;
+
+                const auto compute = [&compute_count]( const double value )
+                    {
+                        return [&compute_count, value]()
+                            {
+                                ++compute_count;
+
+                                return value;
+                            };
+                    };
+
+                ASSERT_EQUAL( cache.Get( 1, 0, compute( 1.5 ) ), 1.5 );
+                ASSERT_EQUAL( cache.Get( 1, 0, compute( 2.5 ) ), 1.5 );
+                ASSERT_EQUAL( compute_count, 1 );
+
+                // Новое поколение делает недействительными все значения.
+                ASSERT_EQUAL( cache.Get( 1, 1, compute( 2.5 ) ), 2.5 );
+                ASSERT_EQUAL( cache.Get( 2, 1, compute( 0.5 ) ), 0.5 );
+                ASSERT_EQUAL( compute_count, 3 );
+
+                // Рост словаря сохраняет значения текущего поколения.
+                cache.Resize( 1000 );
+
+                ASSERT_EQUAL( cache.Get( 1, 1, compute( 3.5 ) ), 2.5 );
+                ASSERT_EQUAL( compute_count, 3 );
+
+                // Слово за пределами кэша вычисляется при каждом запросе.
+                ASSERT_EQUAL( cache.Get( 5000, 1, compute( 4.5 ) ), 4.5 );
+                ASSERT_EQUAL( cache.Get( 5000, 1, compute( 4.5 ) ), 4.5 );
+                ASSERT_EQUAL( compute_count, 5 );
+
+                // Копия принадлежит другому серверу и начинает без значений.
+                const InverseDocumentFreqCache copy( cache );
+
+                ASSERT_EQUAL( copy.Get( 1, 1, compute( 5.5 ) ), 5.5 );
+                ASSERT_EQUAL( compute_count, 6 );
+            }
+
+        SearchServer
+        MakeServer( const std::vector< DocumentRecord > & records )
+            {
+                SearchServer server( "w0"s );
+
+                for( const DocumentRecord & record : records )
+                    {
+                        server.AddDocument( record.id, record.text, record.status, record.ratings );
+                    }
+
+                return server;
+            }
+
+        void
+        TestIndexChangesInvalidateValues()
+            {
+                std::mt19937 generator( 47 );
+
+                std::vector< DocumentRecord > records = GenerateRecords( generator, 300, 20 );
+
+                SearchServer server = MakeServer( records );
+
+                std::vector< std::string > queries;
+
+                for( int i = 0; i < 50; ++i )
+                    {
+                        queries.push_back( GenerateQuery( generator, 20 ) );
+                    }
+
+                // После каждого изменения IDF всех слов должны совпасть с сервером,
+                // который видит эти документы впервые.
+                for( int step = 0; step < 60; ++step )
+                    {
+                        if( step % 3 == 0 )
+                            {
+                                const std::size_t index = generator() % records.size();
+
+                                server.RemoveDocument( records[ index ].id );
+                                records.erase( records.begin() + index );
+                            }
+                        else
+                            {
+                                DocumentRecord record = GenerateRecords( generator, 1, 20 ).front();
+                                record.id = 1000 + step;
+
+                                server.AddDocument( record.id, record.text, record.status, record.ratings );
+                                records.push_back( record );
+                            }
+
+                        const SearchServer fresh_server = MakeServer( records );
+
+                        for( const std::string & query : queries )
+                            {
+                                AssertSameDocuments( server.FindTopDocuments( query ), fresh_server.FindTopDocuments( query ) );
+                                AssertSameDocuments(
+                                        server.FindTopDocuments( std::execution::par, query ),
+                                        fresh_server.FindTopDocuments( query ) );
+                            }
+                    }
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestValuesBelongToGeneration );
+        RUN_TEST( TestIndexChangesInvalidateValues );
+    }
@@ -0,0 +1,229 @@
+// Тесты Paginator.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh paginator_test
+
+#include <cstddef>
+#include <forward_list>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "paginator.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        template < typename Iterator >
+        std::vector< int >
+        ToVector( const IteratorRange< Iterator > & page )
+            {
+                return { page.begin(), page.end() };
+            }
+
+        // Страницы, которые должны получиться из значений 0, 1, ..., item_count - 1.
+        std::vector< std::vector< int > >
+        GetExpectedPages(
+                const int item_count,
+                const int page_size )
+            {
+                std::vector< std::vector< int > > pages;
+
+                for( int value = 0; value < item_count; ++value )
+                    {
+                        if( value % page_size == 0 )
+                            {
+                                pages.emplace_back();
+                            }
+
+                        pages.back().push_back( value );
+                    }
+
+                return pages;
+            }
+
+        template < typename Container >
+        void
+        AssertPages(
+                const Container & items,
+                const int page_size )
+            {
+                const std::vector< std::vector< int > > expected_pages = GetExpectedPages( static_cast< int >( std::distance( items.begin(), items.end() ) ), page_size );
+
+                const auto pages = Paginate( items, page_size );
+
+                ASSERT_EQUAL( pages.size(), expected_pages.size() );
+
+                std::size_t page_index = 0;
+
+                for( const auto page : pages )
+                    {
+                        ASSERT( page_index < expected_pages.size() );
+                        ASSERT_EQUAL( ToVector( page ), expected_pages[ page_index ] );
+                        ASSERT_EQUAL( page.size(), expected_pages[ page_index ].size() );
+
+                        ++page_index;
+                    }
+
+                ASSERT_EQUAL( page_index, expected_pages.size() );
+            }
+
+        void
+        TestSplitsIntoPages()
+            {
+                for( int item_count = 0; item_count <= 12; ++item_count )
+                    {
+                        std::vector< int > values( item_count );
+                        std::iota( values.begin(), values.end(), 0 );
+
+                        const std::list< int > list( values.cbegin(), values.cend() );
+                        const std::forward_list< int > forward_list( values.cbegin(), values.cend() );
+
+                        for( int page_size = 1; page_size <= 5; ++page_size )
+                            {
+                                AssertPages( values, page_size );
+                                AssertPages( list, page_size );
+                                AssertPages( forward_list, page_size );
+                            }
+                    }
+            }
+
+        void
+        TestPageByNumber()
+            {
+                std::vector< int > values( 11 );
+                std::iota( values.begin(), values.end(), 0 );
+
+                const auto pages = Paginate( values, 4 );
+                const std::vector< std::vector< int > > expected_pages = GetExpectedPages( 11, 4 );
+
+                ASSERT_EQUAL( pages.size(), 3u );
+
+                for( std::size_t page = 0; page < expected_pages.size(); ++page )
+                    {
+                        ASSERT_EQUAL( ToVector( pages[ page ] ), expected_pages[ page ] );
+                    }
+
+                // За последней страницей - пустой диапазон.
+                ASSERT_EQUAL( pages[ 3 ].size(), 0u );
+                ASSERT_EQUAL( pages[ 100 ].size(), 0u );
+
+                std::ostringstream output;
+                output << pages[ 1 ];
+
+                ASSERT_EQUAL( output.str(), "4567"s );
+            }
+
+        // Однонаправленный итератор, считающий свои продвижения.
+        class CountingIterator
+            {
+
+                public:
+
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = int;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const int *;
+                    using reference = const int &;
+
+                    CountingIterator() = default;
+
+                    CountingIterator(
+                            const std::forward_list< int >::const_iterator it,
+                            int * increment_count )
+                        :
+                              it_( it )
+                            , increment_count_( increment_count )
+                        {}
+
+                    reference
+                    operator*() const
+                        {
+                            return *it_;
+                        }
+
+                    CountingIterator &
+                    operator++()
+                        {
+                            ++it_;
+                            ++*increment_count_;
+
+                            return *this;
+                        }
+
+                    CountingIterator
+                    operator++( int )
+                        {
+                            CountingIterator previous = *this;
+
+                            ++*this;
+
+                            return previous;
+                        }
+
+                    bool
+                    operator==( const CountingIterator & other ) const
+                        {
+                            return it_ == other.it_;
+                        }
+
+                    bool
+                    operator!=( const CountingIterator & other ) const
+                        {
+                            return it_ != other.it_;
+                        }
+
+                private:
+
+                    std::forward_list< int >::const_iterator it_;
+
+                    int * increment_count_ = nullptr;
+            };
+
+        void
+        TestWalksOnlyVisitedPages()
+            {
+                std::forward_list< int > values( 1000 );
+                std::iota( values.begin(), values.end(), 0 );
+
+                int increment_count = 0;
+
+                const Paginator pages(
+                        CountingIterator( values.cbegin(), &increment_count ),
+                        CountingIterator( values.cend(), &increment_count ),
+                        10 );
+
+                ASSERT_EQUAL( increment_count, 0 );
+
+                auto page = pages.begin();
+
+                ASSERT_EQUAL( *( *page ).begin(), 0 );
+                ASSERT_EQUAL( *( *++page ).begin(), 10 );
+
+                // Пройдены только две первые страницы.
+                ASSERT_EQUAL( increment_count, 20 );
+            }
+
+        void
+        TestRejectsZeroPageSize()
+            {
+                const std::vector< int > values = { 1, 2, 3 };
+
+                ASSERT_THROWS( Paginate( values, 0 ), std::invalid_argument );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestSplitsIntoPages );
+        RUN_TEST( TestPageByNumber );
+        RUN_TEST( TestWalksOnlyVisitedPages );
+        RUN_TEST( TestRejectsZeroPageSize );
+    }
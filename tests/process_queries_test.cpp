@@ -0,0 +1,117 @@
+// Тесты ProcessQueries, ProcessQueriesJoined и SearchServer::FindTopDocumentsInto.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh process_queries_test
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "process_queries.h"
+#include "search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        SearchServer
+        MakeServer( std::mt19937 & generator )
+            {
+                SearchServer server( "w0"s );
+
+                for( const DocumentRecord & record : GenerateRecords( generator, 1000, 50 ) )
+                    {
+                        server.AddDocument( record.id, record.text, record.status, record.ratings );
+                    }
+
+                return server;
+            }
+
+        void
+        TestResultsMatchFindTopDocuments()
+            {
+                std::mt19937 generator( 17 );
+
+                const SearchServer server = MakeServer( generator );
+
+                std::vector< std::string > queries;
+
+                for( int i = 0; i < 500; ++i )
+                    {
+                        // Часть запросов не находит ничего.
+                        queries.push_back( i % 5 == 0 ? "w60 w61"s : GenerateQuery( generator, 50 ) );
+                    }
+
+                const std::vector< std::vector< Document > > documents_lists = ProcessQueries( server, queries );
+                const std::vector< Document > joined_documents = ProcessQueriesJoined( server, queries );
+
+                ASSERT_EQUAL( documents_lists.size(), queries.size() );
+
+                std::vector< Document > expected_joined_documents;
+
+                for( std::size_t i = 0; i < queries.size(); ++i )
+                    {
+                        const std::vector< Document > documents = server.FindTopDocuments( queries[ i ] );
+
+                        AssertSameDocuments( documents_lists[ i ], documents );
+
+                        expected_joined_documents.insert( expected_joined_documents.end(), documents.cbegin(), documents.cend() );
+                    }
+
+                AssertSameDocuments( joined_documents, expected_joined_documents );
+            }
+
+        void
+        TestEmptyBatch()
+            {
+                std::mt19937 generator( 23 );
+
+                const SearchServer server = MakeServer( generator );
+
+                ASSERT( ProcessQueries( server, {} ).empty() );
+                ASSERT( ProcessQueriesJoined( server, {} ).empty() );
+                ASSERT( ProcessQueriesJoined( server, { "w60"s, "w61"s } ).empty() );
+            }
+
+        void
+        TestTopDocumentsIntoMatchesFindTopDocuments()
+            {
+                std::mt19937 generator( 29 );
+
+                SearchServer server = MakeServer( generator );
+
+                // Второй проход по тем же запросам берёт результаты из кэша.
+                server.SetQueryCacheCapacity( 64 );
+
+                const Document sentinel{ -1, -1.0, -1 };
+
+                for( int i = 0; i < 400; ++i )
+                    {
+                        const std::string query = GenerateQuery( generator, 50 );
+                        const DocumentStatus status = static_cast< DocumentStatus >( i % 3 );
+                        const std::size_t max_result_count = i % 8;
+
+                        std::vector< Document > output( max_result_count + 1, sentinel );
+
+                        const std::size_t result_count = server.FindTopDocumentsInto( query, status, max_result_count, output.data() );
+
+                        ASSERT( output.back().id == sentinel.id );
+
+                        output.resize( result_count );
+
+                        AssertSameDocuments( output, server.FindTopDocuments( query, status, max_result_count ) );
+                    }
+
+                ASSERT( server.GetQueryCacheStats().hits > 0 );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestResultsMatchFindTopDocuments );
+        RUN_TEST( TestEmptyBatch );
+        RUN_TEST( TestTopDocumentsIntoMatchesFindTopDocuments );
+    }
@@ -0,0 +1,256 @@
+// Тесты QueryArena и выделений памяти на запрос.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh query_arena_test
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "query_arena.h"
+#include "search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        std::atomic< long > allocation_count{ 0 };
+    }
+
+// Считает выделения памяти в куче во всей программе.
+void *
+operator new( const std::size_t size )
+    {
+        ++allocation_count;
+
+        if( void * const pointer = std::malloc( size == 0 ? 1 : size ) )
+            {
+                return pointer;
+            }
+
+        throw std::bad_alloc();
+    }
+
+void
+operator delete( void * const pointer ) noexcept
+    {
+        std::free( pointer );
+    }
+
+void
+operator delete(
+        void * const pointer,
+        std::size_t ) noexcept
+    {
+        std::free( pointer );
+    }
+
+// Память сверх буфера арены выделяется через выровненный operator new.
+void *
+operator new(
+        const std::size_t size,
+        const std::align_val_t alignment )
+    {
+        ++allocation_count;
+
+        const std::size_t alignment_bytes = std::max( static_cast< std::size_t >( alignment ), sizeof( void * ) );
+        void * pointer = nullptr;
+
+        if( posix_memalign( &pointer, alignment_bytes, size == 0 ? 1 : size ) == 0 )
+            {
+                return pointer;
+            }
+
+        throw std::bad_alloc();
+    }
+
+void
+operator delete(
+        void * const pointer,
+        std::align_val_t ) noexcept
+    {
+        std::free( pointer );
+    }
+
+void
+operator delete(
+        void * const pointer,
+        std::size_t,
+        std::align_val_t ) noexcept
+    {
+        std::free( pointer );
+    }
+
+namespace
+    {
+        void
+        TestNestedArenasShareResource()
+            {
+                const QueryArena arena;
+
+                std::pmr::vector< int > outer_values( arena.GetResource() );
+                outer_values.assign( 100, 1 );
+
+                    {
+                        const QueryArena nested_arena;
+
+                        ASSERT( nested_arena.GetResource() == arena.GetResource() );
+
+                        std::pmr::vector< int > nested_values( nested_arena.GetResource() );
+                        nested_values.assign( 100, 2 );
+                    }
+
+                // Выход из вложенной арены не освобождает память внешней.
+                for( const int value : outer_values )
+                    {
+                        ASSERT_EQUAL( value, 1 );
+                    }
+            }
+
+        void
+        TestBufferGrowsAfterOverflow()
+            {
+                // Больше начального буфера арены: недостающее берётся из кучи.
+                constexpr std::size_t byte_count = 256 * 1024;
+
+                const auto fill = []()
+                    {
+                        const QueryArena arena;
+
+                        std::pmr::vector< std::uint8_t > bytes( byte_count, 7, arena.GetResource() );
+
+                        for( const std::uint8_t byte : bytes )
+                            {
+                                ASSERT_EQUAL( byte, 7 );
+                            }
+                    };
+
+                fill();
+
+                // Буфер потока вырос: тот же запрос больше не обращается к куче.
+                const long before = allocation_count;
+
+                fill();
+
+                ASSERT_EQUAL( allocation_count - before, 0 );
+            }
+
+        void
+        TestBufferIsBounded()
+            {
+                // Запрос крупнее предела не раздувает буфер потока сверх него.
+                const auto fill = []( const std::size_t byte_count )
+                    {
+                        const QueryArena arena;
+
+                        std::pmr::vector< std::uint8_t > bytes( byte_count, 7, arena.GetResource() );
+
+                        ASSERT_EQUAL( bytes.back(), 7 );
+                    };
+
+                fill( 2 * QueryArena::MAX_BUFFER_SIZE );
+
+                // Буфер дорос до предела: запрос в его пределах не обращается к куче,
+                // а запрос крупнее по-прежнему берёт остаток из кучи.
+                long before = allocation_count;
+
+                fill( QueryArena::MAX_BUFFER_SIZE / 2 );
+
+                ASSERT_EQUAL( allocation_count - before, 0 );
+
+                before = allocation_count;
+
+                fill( 2 * QueryArena::MAX_BUFFER_SIZE );
+
+                ASSERT( allocation_count - before > 0 );
+            }
+
+        void
+        TestThreadsUseSeparateArenas()
+            {
+                std::vector< std::thread > threads;
+
+                for( int value = 0; value < 4; ++value )
+                    {
+                        threads.emplace_back(
+                                [value]()
+                                    {
+                                        for( int i = 0; i < 1000; ++i )
+                                            {
+                                                const QueryArena arena;
+
+                                                std::pmr::vector< int > values( 1000, value, arena.GetResource() );
+
+                                                for( const int stored_value : values )
+                                                    {
+                                                        ASSERT_EQUAL( stored_value, value );
+                                                    }
+                                            }
+                                    } );
+                    }
+
+                for( std::thread & thread : threads )
+                    {
+                        thread.join();
+                    }
+            }
+
+        void
+        TestQueryAllocatesOnlyResult()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 31 );
+
+                        SearchServer server( "w0"s, format );
+
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 5000, 300 );
+                        server.AddDocuments( records.cbegin(), records.cend() );
+
+                        std::vector< std::string > queries;
+
+                        for( int i = 0; i < 100; ++i )
+                            {
+                                queries.push_back( GenerateQuery( generator, 300 ) );
+                            }
+
+                        // Первый проход увеличивает буфер арены до нужного размера.
+                        for( const std::string & query : queries )
+                            {
+                                server.FindTopDocuments( query );
+                                server.FindTopDocuments( QueryMode::WAND, query );
+                            }
+
+                        for( const QueryMode mode : { QueryMode::EXHAUSTIVE, QueryMode::WAND } )
+                            {
+                                for( const std::string & query : queries )
+                                    {
+                                        const long before = allocation_count;
+
+                                        const std::vector< Document > documents = server.FindTopDocuments( mode, query, DocumentStatus::ACTUAL );
+
+                                        // Единственное выделение - возвращаемый вектор.
+                                        ASSERT_EQUAL( allocation_count - before, documents.empty() ? 0 : 1 );
+                                    }
+                            }
+                    }
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestNestedArenasShareResource );
+        RUN_TEST( TestBufferGrowsAfterOverflow );
+        RUN_TEST( TestBufferIsBounded );
+        RUN_TEST( TestThreadsUseSeparateArenas );
+        RUN_TEST( TestQueryAllocatesOnlyResult );
+    }
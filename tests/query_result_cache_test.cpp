@@ -0,0 +1,215 @@
+// Тесты кэша результатов поиска SearchServer.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh query_result_cache_test
+// Параллельные запросы стоит проверять и под ThreadSanitizer:
+//     SANITIZE=thread tests/run_tests.sh query_result_cache_test
+
+#include <execution>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "process_queries.h"
+#include "search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        std::vector< std::string >
+        GenerateQueries(
+                std::mt19937 & generator,
+                const int query_count,
+                const int vocabulary_size )
+            {
+                std::vector< std::string > queries;
+
+                for( int i = 0; i < query_count; ++i )
+                    {
+                        queries.push_back( GenerateQuery( generator, vocabulary_size ) );
+                    }
+
+                return queries;
+            }
+
+        void
+        TestCachedResultsMatchUncachedServer()
+            {
+                std::mt19937 generator( 17 );
+
+                SearchServer cached_server( "w0 w1"s );
+                cached_server.SetQueryCacheCapacity( 4 );
+
+                SearchServer uncached_server( "w0 w1"s );
+                uncached_server.SetQueryCacheCapacity( 0 );
+
+                const std::vector< std::string > queries = GenerateQueries( generator, 10, 30 );
+
+                for( int step = 0; step < 4000; ++step )
+                    {
+                        const unsigned operation = generator() % 10;
+
+                        if( operation < 2 )
+                            {
+                                const DocumentRecord record = GenerateRecords( generator, 1, 30 ).front();
+                                const int document_id = static_cast< int >( generator() % 200 );
+
+                                if( !cached_server.ContainsDocument( document_id ) )
+                                    {
+                                        cached_server.AddDocument( document_id, record.text, record.status, record.ratings );
+                                        uncached_server.AddDocument( document_id, record.text, record.status, record.ratings );
+                                    }
+                            }
+                        else if( operation < 3 )
+                            {
+                                const int document_id = static_cast< int >( generator() % 200 );
+
+                                cached_server.RemoveDocument( document_id );
+                                uncached_server.RemoveDocument( document_id );
+                            }
+                        else
+                            {
+                                const std::string & query = queries[ generator() % queries.size() ];
+                                const DocumentStatus status = static_cast< DocumentStatus >( generator() % 3 );
+                                const std::size_t max_result_count = 1 + generator() % 3;
+
+                                const std::vector< Document > expected = uncached_server.FindTopDocuments( query, status, max_result_count );
+
+                                AssertSameDocuments( cached_server.FindTopDocuments( query, status, max_result_count ), expected );
+                                AssertSameDocuments( cached_server.FindTopDocuments( std::execution::par, query, status, max_result_count ), expected );
+                            }
+                    }
+
+                const QueryResultCache::Stats stats = cached_server.GetQueryCacheStats();
+
+                ASSERT( stats.hits > 0 );
+                ASSERT( stats.evictions > 0 );
+                ASSERT( stats.invalidations > 0 );
+
+                const QueryResultCache::Stats uncached_stats = uncached_server.GetQueryCacheStats();
+
+                ASSERT_EQUAL( uncached_stats.hits + uncached_stats.misses, 0u );
+            }
+
+        void
+        TestDisabledByDefault()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "кот в городе"s, DocumentStatus::ACTUAL, { 1 } );
+
+                server.FindTopDocuments( "кот"s );
+                server.FindTopDocuments( std::execution::par, "кот"s );
+
+                ASSERT_EQUAL( server.GetQueryCacheStats().hits, 0u );
+                ASSERT_EQUAL( server.GetQueryCacheStats().misses, 0u );
+
+                server.SetQueryCacheCapacity( 1 );
+
+                server.FindTopDocuments( "кот"s );
+                server.FindTopDocuments( "кот"s );
+
+                ASSERT_EQUAL( server.GetQueryCacheStats().hits, 1u );
+                ASSERT_EQUAL( server.GetQueryCacheStats().misses, 1u );
+            }
+
+        void
+        TestCopyKeepsCapacity()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "кот в городе"s, DocumentStatus::ACTUAL, { 1 } );
+                server.AddDocument( 2, "пёс в парке"s, DocumentStatus::ACTUAL, { 2 } );
+
+                server.SetQueryCacheCapacity( 0 );
+
+                const SearchServer disabled_copy( server );
+
+                disabled_copy.FindTopDocuments( "кот"s );
+                disabled_copy.FindTopDocuments( "кот"s );
+
+                ASSERT_EQUAL( disabled_copy.GetQueryCacheStats().hits, 0u );
+                ASSERT_EQUAL( disabled_copy.GetQueryCacheStats().misses, 0u );
+
+                server.SetQueryCacheCapacity( 1 );
+
+                const SearchServer small_copy( server );
+
+                small_copy.FindTopDocuments( "кот"s );
+                small_copy.FindTopDocuments( "пёс"s );
+                small_copy.FindTopDocuments( "кот"s );
+
+                ASSERT_EQUAL( small_copy.GetQueryCacheStats().hits, 0u );
+                ASSERT_EQUAL( small_copy.GetQueryCacheStats().evictions, 2u );
+            }
+
+        void
+        TestConcurrentQueriesMatchUncachedServer()
+            {
+                std::mt19937 generator( 23 );
+
+                SearchServer cached_server( "w0"s );
+                cached_server.SetQueryCacheCapacity( 8 );
+
+                SearchServer uncached_server( "w0"s );
+                uncached_server.SetQueryCacheCapacity( 0 );
+
+                const std::vector< DocumentRecord > records = GenerateRecords( generator, 500, 30 );
+
+                cached_server.AddDocuments( records.cbegin(), records.cend() );
+                uncached_server.AddDocuments( records.cbegin(), records.cend() );
+
+                // Запросов больше ёмкости кэша: потоки одновременно находят,
+                // добавляют и вытесняют записи.
+                const std::vector< std::string > distinct_queries = GenerateQueries( generator, 20, 30 );
+
+                std::vector< std::string > queries;
+
+                for( int i = 0; i < 2000; ++i )
+                    {
+                        queries.push_back( distinct_queries[ generator() % distinct_queries.size() ] );
+                    }
+
+                const std::vector< std::vector< Document > > expected = ProcessQueries( uncached_server, queries );
+
+                std::vector< std::vector< std::vector< Document > > > thread_results( 4 );
+                std::vector< std::thread > threads;
+
+                for( std::vector< std::vector< Document > > & results : thread_results )
+                    {
+                        threads.emplace_back(
+                                [&cached_server, &queries, &results]()
+                                    {
+                                        results = ProcessQueries( cached_server, queries );
+                                    } );
+                    }
+
+                for( std::thread & thread : threads )
+                    {
+                        thread.join();
+                    }
+
+                for( const std::vector< std::vector< Document > > & results : thread_results )
+                    {
+                        ASSERT_EQUAL( results.size(), expected.size() );
+
+                        for( std::size_t i = 0; i < results.size(); ++i )
+                            {
+                                AssertSameDocuments( results[ i ], expected[ i ] );
+                            }
+                    }
+
+                ASSERT( cached_server.GetQueryCacheStats().hits > 0 );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestCachedResultsMatchUncachedServer );
+        RUN_TEST( TestDisabledByDefault );
+        RUN_TEST( TestCopyKeepsCapacity );
+        RUN_TEST( TestConcurrentQueriesMatchUncachedServer );
+    }
@@ -0,0 +1,85 @@
+// Тесты чтения записей документов из потока.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh read_input_functions_test
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "read_input_functions.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        void
+        TestReadsRecords()
+            {
+                std::istringstream input( "\n3 2 2 5 -1\nпушистый кот\n\n\n7 0 1 4\n\n"s );
+
+                DocumentRecord record;
+
+                ASSERT( input >> record );
+                ASSERT_EQUAL( record.id, 3 );
+                ASSERT( record.status == DocumentStatus::BANNED );
+                ASSERT_EQUAL( record.ratings, std::vector< int >( { 5, -1 } ) );
+                ASSERT_EQUAL( record.text, "пушистый кот"s );
+
+                // Пустой текст документа - тоже текст.
+                ASSERT( input >> record );
+                ASSERT_EQUAL( record.id, 7 );
+                ASSERT( record.status == DocumentStatus::ACTUAL );
+                ASSERT_EQUAL( record.ratings, std::vector< int >( { 4 } ) );
+                ASSERT_EQUAL( record.text, ""s );
+
+                ASSERT( !( input >> record ) );
+                ASSERT( input.eof() );
+            }
+
+        void
+        TestRejectsMalformedHeader()
+            {
+                for( const std::string & text : { "x 0 1 1\nкот\n"s, "1 0\nкот\n"s, "1 0 3 1 2\nкот\n"s } )
+                    {
+                        std::istringstream input( text );
+
+                        DocumentRecord record;
+
+                        // Неверная запись отличается от конца потока.
+                        ASSERT( !( input >> record ) );
+                        ASSERT( !input.eof() );
+                    }
+            }
+
+        void
+        TestRejectsInvalidValues()
+            {
+                for( const std::string & text : { "1 4 1 5\nкот\n"s, "1 -1 1 5\nкот\n"s, "1 0 0\nкот\n"s } )
+                    {
+                        std::istringstream input( text );
+
+                        DocumentRecord record;
+
+                        ASSERT_THROWS( input >> record, std::invalid_argument );
+                    }
+
+                // Удалённый документ - допустимый статус.
+                std::istringstream input( "1 3 1 5\nкот\n"s );
+
+                DocumentRecord record;
+
+                ASSERT( input >> record );
+                ASSERT( record.status == DocumentStatus::REMOVED );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestReadsRecords );
+        RUN_TEST( TestRejectsMalformedHeader );
+        RUN_TEST( TestRejectsInvalidValues );
+    }
@@ -0,0 +1,71 @@
+// Тесты RemoveDuplicates.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh remove_duplicates_test
+
+#include <string>
+#include <vector>
+
+#include "remove_duplicates.h"
+#include "search_server.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        void
+        TestRemovesDocumentsWithSameWordSet()
+            {
+                SearchServer search_server( "and with"s );
+
+                search_server.AddDocument( 1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7, 2, 7 } );
+                search_server.AddDocument( 2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, { 1, 2 } );
+                // Те же слова, что у 2, с другими частотами и стоп-словами.
+                search_server.AddDocument( 3, "funny pet with curly hair hair"s, DocumentStatus::ACTUAL, { 1, 2 } );
+                search_server.AddDocument( 4, "curly hair funny pet"s, DocumentStatus::BANNED, { 1 } );
+                // Подмножество слов 1 - не дубликат.
+                search_server.AddDocument( 5, "funny pet nasty"s, DocumentStatus::ACTUAL, { 1 } );
+                search_server.AddDocument( 6, "rat nasty pet funny"s, DocumentStatus::ACTUAL, { 1 } );
+
+                ASSERT_EQUAL( RemoveDuplicates( search_server ), std::vector< int >( { 3, 4, 6 } ) );
+
+                ASSERT_EQUAL( search_server.GetDocumentCount(), 3 );
+                ASSERT( search_server.ContainsDocument( 1 ) );
+                ASSERT( search_server.ContainsDocument( 2 ) );
+                ASSERT( search_server.ContainsDocument( 5 ) );
+
+                ASSERT_EQUAL( search_server.FindTopDocuments( "curly"s ).size(), 1u );
+                ASSERT( RemoveDuplicates( search_server ).empty() );
+            }
+
+        void
+        TestKeepsLowestIdAmongManyCopies()
+            {
+                SearchServer search_server( ""s, PostingsFormat::COMPRESSED );
+
+                std::vector< int > expected_ids;
+
+                for( int id = 0; id < 3000; ++id )
+                    {
+                        search_server.AddDocument( id, "word"s + std::to_string( id % 1000 ) + " common"s, DocumentStatus::ACTUAL, { 1 } );
+
+                        if( id >= 1000 )
+                            {
+                                expected_ids.push_back( id );
+                            }
+                    }
+
+                ASSERT_EQUAL( RemoveDuplicates( search_server ), expected_ids );
+                ASSERT_EQUAL( search_server.GetDocumentCount(), 1000 );
+                ASSERT_EQUAL( search_server.GetDocumentFreq( "common"s ), 1000u );
+                ASSERT_EQUAL( search_server.FindTopDocuments( "word999"s ).front().id, 999 );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestRemovesDocumentsWithSameWordSet );
+        RUN_TEST( TestKeepsLowestIdAmongManyCopies );
+    }
@@ -0,0 +1,190 @@
+// Тесты RequestQueue: скользящее окно и запросы из нескольких потоков.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh request_queue_test
+// Запись из нескольких потоков стоит проверять и под ThreadSanitizer:
+//     SANITIZE=thread tests/run_tests.sh request_queue_test
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "request_queue.h"
+#include "search_server.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        // Часы, которые тест переводит вручную; по умолчанию интервал окна - минута.
+        class ManualClock
+            {
+
+                public:
+
+                    void
+                    Advance( const std::chrono::minutes duration )
+                        {
+                            minutes_ += duration.count();
+                        }
+
+                    std::int64_t
+                    GetMinutes() const
+                        {
+                            return minutes_;
+                        }
+
+                    std::function< RequestQueue::Clock::time_point() >
+                    GetFunction() const
+                        {
+                            return [this]()
+                                {
+                                    return RequestQueue::Clock::time_point( std::chrono::minutes( minutes_.load() ) );
+                                };
+                        }
+
+                private:
+
+                    std::atomic< std::int64_t > minutes_{ 0 };
+            };
+
+        SearchServer
+        MakeServer()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, { 7, 2, 7 } );
+                server.AddDocument( 2, "пушистый пёс и модный ошейник"s, DocumentStatus::ACTUAL, { 1, 2, 3 } );
+                server.AddDocument( 3, "большой кот модный ошейник"s, DocumentStatus::ACTUAL, { 1, 2, 8 } );
+
+                return server;
+            }
+
+        void
+        TestWindowMatchesRequestLog()
+            {
+                const SearchServer server = MakeServer();
+
+                ManualClock clock;
+                RequestQueue request_queue( server, std::chrono::hours( 24 ), clock.GetFunction() );
+
+                std::mt19937 generator( 13 );
+
+                // Время запроса в минутах и число найденных документов.
+                std::deque< std::pair< std::int64_t, std::size_t > > requests;
+
+                for( int i = 0; i < 20000; ++i )
+                    {
+                        // Обычно запросы идут раз в минуту, изредка - с большими паузами.
+                        const unsigned pause = generator() % 100;
+                        clock.Advance( std::chrono::minutes( pause < 50 ? 0 : pause < 98 ? 1 : 1000 + pause * 10 ) );
+
+                        const std::string query = generator() % 3 == 0 ? "пушистый кот"s : "скворец"s;
+
+                        const std::vector< Document > documents = request_queue.AddFindRequest( query );
+
+                        requests.emplace_back( clock.GetMinutes(), documents.size() );
+
+                        while( requests.front().first <= clock.GetMinutes() - static_cast< std::int64_t >( RequestQueue::SLOT_COUNT ) )
+                            {
+                                requests.pop_front();
+                            }
+
+                        const RequestQueue::Stats stats = request_queue.GetStats();
+
+                        std::uint64_t no_result_request_count = 0;
+                        std::uint64_t result_count = 0;
+
+                        for( const auto & [ _, document_count ] : requests )
+                            {
+                                no_result_request_count += document_count == 0 ? 1 : 0;
+                                result_count += document_count;
+                            }
+
+                        ASSERT_EQUAL( stats.request_count, requests.size() );
+                        ASSERT_EQUAL( stats.no_result_request_count, no_result_request_count );
+                        ASSERT_EQUAL( stats.result_count, result_count );
+                        ASSERT_EQUAL( request_queue.GetNoResultRequests(), static_cast< int >( no_result_request_count ) );
+
+                        const std::uint64_t latency_count = std::accumulate( stats.latency_counts.cbegin(), stats.latency_counts.cend(), std::uint64_t( 0 ) );
+
+                        ASSERT_EQUAL( latency_count, stats.request_count );
+                    }
+
+                // Через сутки без запросов окно пусто.
+                clock.Advance( std::chrono::hours( 24 ) );
+
+                ASSERT_EQUAL( request_queue.GetStats().request_count, 0u );
+                ASSERT_EQUAL( request_queue.GetNoResultRequests(), 0 );
+            }
+
+        void
+        TestConcurrentRequests()
+            {
+                const SearchServer server = MakeServer();
+
+                ManualClock clock;
+                RequestQueue request_queue( server, std::chrono::hours( 24 ), clock.GetFunction() );
+
+                constexpr int thread_count = 8;
+                constexpr int request_count = 500;
+
+                std::vector< std::thread > threads;
+
+                for( int i = 0; i < thread_count; ++i )
+                    {
+                        threads.emplace_back(
+                                [&request_queue]()
+                                    {
+                                        for( int j = 0; j < request_count; ++j )
+                                            {
+                                                request_queue.AddFindRequest( j % 2 == 0 ? "кот"s : "скворец"s );
+                                            }
+                                    } );
+                    }
+
+                // Статистика читается во время записи и не должна мешать ей.
+                for( int i = 0; i < 100; ++i )
+                    {
+                        ASSERT( request_queue.GetStats().request_count <= static_cast< std::uint64_t >( thread_count * request_count ) );
+                    }
+
+                for( std::thread & thread : threads )
+                    {
+                        thread.join();
+                    }
+
+                const RequestQueue::Stats stats = request_queue.GetStats();
+
+                ASSERT_EQUAL( stats.request_count, static_cast< std::uint64_t >( thread_count * request_count ) );
+                ASSERT_EQUAL( stats.no_result_request_count, static_cast< std::uint64_t >( thread_count * request_count / 2 ) );
+                ASSERT_EQUAL( stats.result_count, static_cast< std::uint64_t >( thread_count * request_count / 2 * 2 ) );
+            }
+
+        void
+        TestRejectsTooShortWindow()
+            {
+                const SearchServer server = MakeServer();
+
+                ASSERT_THROWS(
+                        RequestQueue( server, RequestQueue::Clock::duration( RequestQueue::SLOT_COUNT - 1 ) ),
+                        std::invalid_argument );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestWindowMatchesRequestLog );
+        RUN_TEST( TestConcurrentRequests );
+        RUN_TEST( TestRejectsTooShortWindow );
+    }
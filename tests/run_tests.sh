@@ -0,0 +1,41 @@
+#!/bin/sh
+# Собирает и запускает тесты из tests/. Запуск из корня репозитория:
+#     tests/run_tests.sh                      - все тесты;
+#     tests/run_tests.sh search_server_test   - выбранные тесты;
+#     SANITIZE=thread tests/run_tests.sh      - под ThreadSanitizer ( или address ).
+set -e
+
+cd "$( dirname "$0" )/.."
+
+BUILD_DIR=${BUILD_DIR:-_test_build${SANITIZE:+_$SANITIZE}}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O1 -g -Wall}
+
+if [ -n "$SANITIZE" ]; then
+    CXXFLAGS="$CXXFLAGS -fsanitize=$SANITIZE"
+fi
+
+if [ $# -eq 0 ]; then
+    set -- $( cd tests && ls *_test.cpp 2> /dev/null | sed 's/\.cpp$//' )
+fi
+
+mkdir -p "$BUILD_DIR"
+
+# Исходники сервера без main.cpp собираются один раз.
+SOURCES=$( ls *.cpp | grep -v '^main\.cpp$' )
+
+for source in $SOURCES; do
+    object="$BUILD_DIR/${source%.cpp}.o"
+
+    if [ ! -f "$object" ] || [ "$source" -nt "$object" ] || [ -n "$( find . -maxdepth 1 -name '*.h' -newer "$object" )" ]; then
+        g++ $CXXFLAGS -I. -c "$source" -o "$object"
+    fi
+done
+
+for test in "$@"; do
+    g++ $CXXFLAGS -I. "tests/$test.cpp" "$BUILD_DIR"/*.o -ltbb -lpthread -o "$BUILD_DIR/$test"
+
+    echo "== $test"
+    "$BUILD_DIR/$test"
+done
+
+echo "All tests passed."
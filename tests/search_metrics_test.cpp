@@ -0,0 +1,209 @@
+// Тесты SearchMetrics: бакеты гистограммы, перцентили и учёт этапов сервером.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh search_metrics_test
+// Запись из нескольких потоков стоит проверять и под санитайзером:
+//     SANITIZE=thread tests/run_tests.sh search_metrics_test
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "search_metrics.h"
+#include "search_server.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        void
+        TestBucketsBoundValues()
+            {
+                for( std::uint64_t value = 0; value < LatencyHistogram::SUB_BUCKET_COUNT; ++value )
+                    {
+                        ASSERT_EQUAL( LatencyHistogram::GetBucket( value ), static_cast< std::size_t >( value ) );
+                        ASSERT_EQUAL( LatencyHistogram::GetBucketUpperBound( LatencyHistogram::GetBucket( value ) ), value );
+                    }
+
+                std::vector< std::uint64_t > values;
+
+                for( std::uint64_t value = 1; value < 100000; value = value * 3 / 2 + 1 )
+                    {
+                        values.push_back( value );
+                    }
+
+                values.push_back( UINT64_MAX );
+
+                for( const std::uint64_t value : values )
+                    {
+                        const std::size_t bucket = LatencyHistogram::GetBucket( value );
+                        const std::uint64_t upper_bound = LatencyHistogram::GetBucketUpperBound( bucket );
+
+                        // Погрешность значения не больше 1/8.
+                        ASSERT( bucket < LatencyHistogram::BUCKET_COUNT );
+                        ASSERT( upper_bound >= value );
+                        ASSERT( upper_bound - value <= value / 8 );
+                        ASSERT_EQUAL( LatencyHistogram::GetBucket( upper_bound ), bucket );
+
+                        if( upper_bound != UINT64_MAX )
+                            {
+                                ASSERT_EQUAL( LatencyHistogram::GetBucket( upper_bound + 1 ), bucket + 1 );
+                            }
+                    }
+            }
+
+        void
+        TestSnapshotPercentiles()
+            {
+                LatencyHistogram histogram;
+
+                ASSERT_EQUAL( histogram.GetSnapshot().GetPercentile( 0.5 ), std::uint64_t{ 0 } );
+
+                for( std::uint64_t value = 1; value <= 1000; ++value )
+                    {
+                        histogram.Record( value );
+                    }
+
+                const LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+
+                ASSERT_EQUAL( snapshot.count, std::uint64_t{ 1000 } );
+                ASSERT_EQUAL( snapshot.total_nanoseconds, std::uint64_t{ 500500 } );
+                ASSERT_EQUAL( snapshot.max_nanoseconds, std::uint64_t{ 1000 } );
+                ASSERT_EQUAL( snapshot.counts.size(), LatencyHistogram::BUCKET_COUNT );
+
+                for( const double fraction : { 0.01, 0.25, 0.5, 0.9, 0.99 } )
+                    {
+                        const std::uint64_t expected = static_cast< std::uint64_t >( fraction * 1000 + 0.5 );
+                        const std::uint64_t percentile = snapshot.GetPercentile( fraction );
+
+                        ASSERT( percentile >= expected );
+                        ASSERT( percentile - expected <= expected / 8 );
+                    }
+
+                // Верхняя граница бакета не превышает наибольшего значения.
+                ASSERT_EQUAL( snapshot.GetPercentile( 1.0 ), std::uint64_t{ 1000 } );
+                ASSERT_EQUAL( snapshot.GetPercentile( 0.0 ), std::uint64_t{ 1 } );
+
+                histogram.Reset();
+
+                ASSERT_EQUAL( histogram.GetSnapshot().count, std::uint64_t{ 0 } );
+                ASSERT_EQUAL( histogram.GetSnapshot().max_nanoseconds, std::uint64_t{ 0 } );
+            }
+
+        void
+        TestConcurrentRecording()
+            {
+                LatencyHistogram histogram;
+
+                constexpr int thread_count = 4;
+                constexpr std::uint64_t record_count = 20000;
+
+                std::vector< std::thread > threads;
+
+                for( int thread = 0; thread < thread_count; ++thread )
+                    {
+                        threads.emplace_back(
+                                [&histogram, thread]()
+                                    {
+                                        for( std::uint64_t value = 0; value < record_count; ++value )
+                                            {
+                                                histogram.Record( value + thread );
+                                            }
+                                    } );
+                    }
+
+                for( std::thread & thread : threads )
+                    {
+                        thread.join();
+                    }
+
+                const LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+
+                ASSERT_EQUAL( snapshot.count, thread_count * record_count );
+                ASSERT_EQUAL( snapshot.max_nanoseconds, record_count - 1 + ( thread_count - 1 ) );
+                ASSERT_EQUAL(
+                        snapshot.total_nanoseconds,
+                        thread_count * ( record_count * ( record_count - 1 ) / 2 ) + record_count * ( 0 + 1 + 2 + 3 ) );
+            }
+
+        void
+        AssertStageCounts(
+                const SearchMetrics::Snapshot & snapshot,
+                const std::uint64_t count )
+            {
+                for( const SearchMetrics::Stage stage : {
+                        SearchMetrics::Stage::PARSE_QUERY,
+                        SearchMetrics::Stage::SCORE_DOCUMENTS,
+                        SearchMetrics::Stage::COLLECT_DOCUMENTS,
+                        SearchMetrics::Stage::SELECT_TOP_DOCUMENTS } )
+                    {
+                        ASSERT_EQUAL( snapshot.GetStage( stage ).count, count );
+                    }
+            }
+
+        void
+        TestServerRecordsStagesAndCounters()
+            {
+                SearchServer server( "and"s );
+
+                server.AddDocument( 1, "cat and dog"s, DocumentStatus::ACTUAL, { 1 } );
+                server.AddDocument( 2, "cat and bird"s, DocumentStatus::ACTUAL, { 2 } );
+                server.AddDocument( 3, "dog and fish"s, DocumentStatus::ACTUAL, { 3 } );
+                server.AddDocument( 4, "cat and fish"s, DocumentStatus::BANNED, { 4 } );
+
+                const auto any_document = []( int, DocumentStatus, int )
+                    {
+                        return true;
+                    };
+
+                // Выключенные метрики ничего не учитывают.
+                server.FindTopDocuments( "cat -fish"s, any_document );
+
+                AssertStageCounts( server.GetMetrics(), 0 );
+                ASSERT_EQUAL( server.GetMetrics().GetCounter( SearchMetrics::Counter::POSTINGS_SCANNED ), std::uint64_t{ 0 } );
+
+                server.SetMetricsEnabled( true );
+
+                const std::vector< Document > documents = server.FindTopDocuments( "cat -fish"s, any_document );
+
+                ASSERT_EQUAL( documents.size(), std::size_t{ 2 } );
+
+                const SearchMetrics::Snapshot snapshot = server.GetMetrics();
+
+                AssertStageCounts( snapshot, 1 );
+
+                // Постинги слова cat (3) и минус-слова fish (2); fish исключает документы 3 и 4.
+                ASSERT_EQUAL( snapshot.GetCounter( SearchMetrics::Counter::POSTINGS_SCANNED ), std::uint64_t{ 5 } );
+                ASSERT_EQUAL( snapshot.GetCounter( SearchMetrics::Counter::DOCUMENTS_EXCLUDED ), std::uint64_t{ 2 } );
+                ASSERT_EQUAL( snapshot.GetCounter( SearchMetrics::Counter::DOCUMENTS_SCORED ), std::uint64_t{ 2 } );
+
+                const SearchMetrics::Snapshot copied_snapshot = SearchServer( server ).GetMetrics();
+
+                AssertStageCounts( copied_snapshot, 0 );
+
+                // Копия начинает с нуля, но учёт в ней включён.
+                SearchServer copy( server );
+
+                copy.FindTopDocuments( "dog"s, any_document );
+
+                AssertStageCounts( copy.GetMetrics(), 1 );
+                AssertStageCounts( server.GetMetrics(), 1 );
+
+                server.ResetMetrics();
+
+                AssertStageCounts( server.GetMetrics(), 0 );
+                ASSERT_EQUAL( server.GetMetrics().GetCounter( SearchMetrics::Counter::DOCUMENTS_SCORED ), std::uint64_t{ 0 } );
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestBucketsBoundValues );
+        RUN_TEST( TestSnapshotPercentiles );
+        RUN_TEST( TestConcurrentRecording );
+        RUN_TEST( TestServerRecordsStagesAndCounters );
+    }
@@ -0,0 +1,1113 @@
+// Тесты SearchServer.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh search_server_test
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <execution>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "benchmarks/benchmark_corpus.h"
+#include "search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        std::vector< std::string >
+        SplitBySpaces( const std::string & text )
+            {
+                std::istringstream input( text );
+
+                std::vector< std::string > words;
+
+                for( std::string word; input >> word; )
+                    {
+                        words.push_back( word );
+                    }
+
+                return words;
+            }
+
+        // Поиск по определению TF-IDF перебором всех документов, без индекса.
+        class ReferenceServer
+            {
+
+                public:
+
+                    ReferenceServer(
+                            const std::set< std::string > & stop_words,
+                            const std::vector< DocumentRecord > & records )
+                        :
+                            stop_words_( stop_words )
+                        {
+                            for( const DocumentRecord & record : records )
+                                {
+                                    std::vector< std::string > words;
+
+                                    for( const std::string & word : SplitBySpaces( record.text ) )
+                                        {
+                                            if( stop_words_.count( word ) == 0 )
+                                                {
+                                                    words.push_back( word );
+                                                }
+                                        }
+
+                                    Entry & entry = documents_[ record.id ];
+                                    entry.status = record.status;
+                                    entry.rating = record.ratings.front();
+
+                                    for( const std::string & word : words )
+                                        {
+                                            entry.word_freqs[ word ] += 1.0 / words.size();
+                                        }
+                                }
+                        }
+
+                    std::map< int, double >
+                    FindAllDocuments(
+                            const std::string & raw_query,
+                            const DocumentStatus status ) const
+                        {
+                            const auto [ plus_words, minus_words ] = ParseQuery( raw_query );
+
+                            std::map< int, double > document_to_relevance;
+
+                            for( const auto & [ document_id, entry ] : documents_ )
+                                {
+                                    if( entry.status != status || ContainsAny( entry, minus_words ) )
+                                        {
+                                            continue;
+                                        }
+
+                                    double relevance = 0.0;
+                                    bool is_matched = false;
+
+                                    for( const std::string & word : plus_words )
+                                        {
+                                            const auto it = entry.word_freqs.find( word );
+
+                                            if( it != entry.word_freqs.cend() )
+                                                {
+                                                    relevance += it->second * ComputeInverseDocumentFreq( word );
+                                                    is_matched = true;
+                                                }
+                                        }
+
+                                    if( is_matched )
+                                        {
+                                            document_to_relevance[ document_id ] = relevance;
+                                        }
+                                }
+
+                            return document_to_relevance;
+                        }
+
+                    std::vector< std::string >
+                    MatchDocument(
+                            const std::string & raw_query,
+                            const int document_id ) const
+                        {
+                            const auto [ plus_words, minus_words ] = ParseQuery( raw_query );
+
+                            const Entry & entry = documents_.at( document_id );
+
+                            std::vector< std::string > matched_words;
+
+                            if( ContainsAny( entry, minus_words ) )
+                                {
+                                    return matched_words;
+                                }
+
+                            for( const std::string & word : plus_words )
+                                {
+                                    if( entry.word_freqs.count( word ) > 0 )
+                                        {
+                                            matched_words.push_back( word );
+                                        }
+                                }
+
+                            return matched_words;
+                        }
+
+                    int
+                    GetRating( const int document_id ) const
+                        {
+                            return documents_.at( document_id ).rating;
+                        }
+
+                    bool
+                    ContainsWord(
+                            const int document_id,
+                            const std::string & word ) const
+                        {
+                            return documents_.at( document_id ).word_freqs.count( word ) > 0;
+                        }
+
+                private:
+
+                    struct Entry
+                        {
+                            std::map< std::string, double > word_freqs;
+                            DocumentStatus status = DocumentStatus::ACTUAL;
+                            int rating = 0;
+                        };
+
+                    std::set< std::string > stop_words_;
+
+                    std::map< int, Entry > documents_;
+
+                    std::pair< std::set< std::string >, std::set< std::string > >
+                    ParseQuery( const std::string & raw_query ) const
+                        {
+                            std::set< std::string > plus_words;
+                            std::set< std::string > minus_words;
+
+                            for( const std::string & word : SplitBySpaces( raw_query ) )
+                                {
+                                    const bool is_minus = word.front() == '-';
+                                    const std::string data = is_minus ? word.substr( 1 ) : word;
+
+                                    if( stop_words_.count( data ) == 0 )
+                                        {
+                                            ( is_minus ? minus_words : plus_words ).insert( data );
+                                        }
+                                }
+
+                            return { plus_words, minus_words };
+                        }
+
+                    static bool
+                    ContainsAny(
+                            const Entry & entry,
+                            const std::set< std::string > & words )
+                        {
+                            return
+                                    std::any_of(
+                                            words.cbegin(),
+                                            words.cend(),
+                                            [&entry]( const std::string & word )
+                                                {
+                                                    return entry.word_freqs.count( word ) > 0;
+                                                } );
+                        }
+
+                    double
+                    ComputeInverseDocumentFreq( const std::string & word ) const
+                        {
+                            const auto document_freq = std::count_if(
+                                    documents_.cbegin(),
+                                    documents_.cend(),
+                                    [&word]( const auto & document )
+                                        {
+                                            return document.second.word_freqs.count( word ) > 0;
+                                        } );
+
+                            return std::log( 1.0 * documents_.size() / document_freq );
+                        }
+            };
+
+        // Найдены лучшие документы: id могут отличаться только среди равных
+        // по релевантности и рейтингу.
+        void
+        AssertTopDocuments(
+                const std::vector< Document > & documents,
+                const std::map< int, double > & expected_relevances,
+                const ReferenceServer & reference_server,
+                const std::size_t max_result_count )
+            {
+                std::vector< Document > expected_documents;
+
+                for( const auto & [ document_id, relevance ] : expected_relevances )
+                    {
+                        expected_documents.push_back( { document_id, relevance, reference_server.GetRating( document_id ) } );
+                    }
+
+                std::sort(
+                        expected_documents.begin(),
+                        expected_documents.end(),
+                        []( const Document & lhs, const Document & rhs )
+                            {
+                                if( std::abs( lhs.relevance - rhs.relevance ) < 1e-6 )
+                                    {
+                                        return lhs.rating > rhs.rating;
+                                    }
+
+                                return lhs.relevance > rhs.relevance;
+                            } );
+
+                ASSERT_EQUAL( documents.size(), std::min( expected_documents.size(), max_result_count ) );
+
+                for( std::size_t i = 0; i < documents.size(); ++i )
+                    {
+                        ASSERT( expected_relevances.count( documents[ i ].id ) > 0 );
+                        ASSERT( std::abs( documents[ i ].relevance - expected_relevances.at( documents[ i ].id ) ) < 1e-9 );
+                        ASSERT( std::abs( documents[ i ].relevance - expected_documents[ i ].relevance ) < 1e-9 );
+                        ASSERT_EQUAL( documents[ i ].rating, expected_documents[ i ].rating );
+                    }
+            }
+
+        void
+        TestMatchesReferenceServer()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 5 );
+
+                        // Id в случайном порядке: постинги вставляются и в середину списков.
+                        std::vector< DocumentRecord > records = GenerateRecords( generator, 800, 40 );
+                        std::shuffle( records.begin(), records.end(), generator );
+
+                        SearchServer server( "w0 w1"s, format );
+
+                        for( const DocumentRecord & record : records )
+                            {
+                                server.AddDocument( record.id, record.text, record.status, record.ratings );
+                            }
+
+                        const ReferenceServer reference_server( { "w0"s, "w1"s }, records );
+
+                        ASSERT_EQUAL( server.GetDocumentCount(), static_cast< int >( records.size() ) );
+
+                        for( int i = 0; i < 300; ++i )
+                            {
+                                const std::string query = GenerateQuery( generator, 40 );
+
+                                AssertTopDocuments(
+                                        server.FindTopDocuments( query ),
+                                        reference_server.FindAllDocuments( query, DocumentStatus::ACTUAL ),
+                                        reference_server,
+                                        MAX_RESULT_DOCUMENT_COUNT );
+
+                                // Глубина выдачи - от пустой до всех найденных документов.
+                                const std::size_t max_result_count = generator() % 40;
+
+                                for( const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED } )
+                                    {
+                                        const std::map< int, double > expected_relevances = reference_server.FindAllDocuments( query, status );
+
+                                        AssertTopDocuments(
+                                                server.FindTopDocuments( query, status, max_result_count ),
+                                                expected_relevances,
+                                                reference_server,
+                                                max_result_count );
+
+                                        const auto document_predicate = [status]( int, const DocumentStatus document_status, int )
+                                            {
+                                                return document_status == status;
+                                            };
+
+                                        AssertTopDocuments(
+                                                server.FindTopDocuments( query, document_predicate, max_result_count ),
+                                                expected_relevances,
+                                                reference_server,
+                                                max_result_count );
+                                    }
+
+                                const DocumentRecord & record = records[ generator() % records.size() ];
+
+                                const auto [ words, status ] = server.MatchDocument( query, record.id );
+
+                                ASSERT_EQUAL( std::vector< std::string >( words.cbegin(), words.cend() ), reference_server.MatchDocument( query, record.id ) );
+                                ASSERT( status == record.status );
+                            }
+                    }
+            }
+
+        void
+        TestFindsExampleDocuments()
+            {
+                SearchServer server( "и в на"s );
+                server.AddDocument( 3, "ухоженный скворец евгений"s, DocumentStatus::BANNED, { 9 } );
+                server.AddDocument( 1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, { 7, 2, 7 } );
+                server.AddDocument( 0, "белый кот и модный ошейник"s, DocumentStatus::ACTUAL, { 8, -3 } );
+                server.AddDocument( 2, "ухоженный пёс выразительные глаза"s, DocumentStatus::ACTUAL, { 5, -12, 2, 1 } );
+
+                const std::vector< Document > documents = server.FindTopDocuments( "пушистый ухоженный кот"s );
+
+                ASSERT_EQUAL( documents.size(), 3u );
+                ASSERT_EQUAL( documents[ 0 ].id, 1 );
+                ASSERT_EQUAL( documents[ 1 ].id, 0 );
+                ASSERT_EQUAL( documents[ 2 ].id, 2 );
+                ASSERT( std::abs( documents[ 0 ].relevance - 0.866434 ) < 1e-6 );
+                ASSERT( std::abs( documents[ 1 ].relevance - 0.173287 ) < 1e-6 );
+                ASSERT( std::abs( documents[ 2 ].relevance - 0.173287 ) < 1e-6 );
+
+                ASSERT_EQUAL( server.FindTopDocuments( "скворец"s, DocumentStatus::BANNED ).size(), 1u );
+                ASSERT( server.FindTopDocuments( "скворец"s ).empty() );
+                ASSERT( server.FindTopDocuments( "пушистый -хвост"s ).empty() );
+                ASSERT( server.FindTopDocuments( "и"s ).empty() );
+            }
+
+        void
+        TestParallelMatchesSequential()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 9 );
+
+                        SearchServer server( "w0"s, format );
+
+                        // Документов достаточно, чтобы параллельный поиск делил их на
+                        // несколько диапазонов; удалённые документы остаются в диапазонах
+                        // отмеченными.
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 5000, 40 );
+
+                        for( const DocumentRecord & record : records )
+                            {
+                                server.AddDocument( record.id, record.text, record.status, record.ratings );
+                            }
+
+                        for( std::size_t i = 0; i < records.size(); i += 7 )
+                            {
+                                server.RemoveDocument( records[ i ].id );
+                            }
+
+                        for( int i = 0; i < 200; ++i )
+                            {
+                                const std::string query = GenerateQuery( generator, 40 );
+                                const std::size_t max_result_count = 1 + generator() % 8;
+
+                                AssertSameDocuments(
+                                        server.FindTopDocuments( std::execution::seq, query, DocumentStatus::ACTUAL, max_result_count ),
+                                        server.FindTopDocuments( std::execution::par, query, DocumentStatus::ACTUAL, max_result_count ) );
+
+                                const std::size_t record_index = generator() % records.size();
+
+                                if( record_index % 7 == 0 )
+                                    {
+                                        continue;
+                                    }
+
+                                const int document_id = records[ record_index ].id;
+
+                                const auto [ sequential_words, sequential_status ] = server.MatchDocument( std::execution::seq, query, document_id );
+                                const auto [ parallel_words, parallel_status ] = server.MatchDocument( std::execution::par, query, document_id );
+
+                                ASSERT( sequential_words == parallel_words );
+                                ASSERT( sequential_status == parallel_status );
+                            }
+                    }
+            }
+
+        void
+        TestRemovedDocumentsAreForgotten()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 11 );
+
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 1000, 40 );
+
+                        SearchServer server( "w0"s, format );
+
+                        for( const DocumentRecord & record : records )
+                            {
+                                server.AddDocument( record.id, record.text, record.status, record.ratings );
+                            }
+
+                        // Удаляется каждый второй документ, через оба варианта RemoveDocument;
+                        // удаление отсутствующего id ничего не меняет.
+                        std::vector< DocumentRecord > kept_records;
+                        std::vector< int > removed_ids;
+
+                        for( std::size_t i = 0; i < records.size(); ++i )
+                            {
+                                if( generator() % 2 == 0 )
+                                    {
+                                        kept_records.push_back( records[ i ] );
+                                    }
+                                else if( i % 2 == 0 )
+                                    {
+                                        server.RemoveDocument( records[ i ].id );
+                                        removed_ids.push_back( records[ i ].id );
+                                    }
+                                else
+                                    {
+                                        server.RemoveDocument( std::execution::par, records[ i ].id );
+                                        removed_ids.push_back( records[ i ].id );
+                                    }
+                            }
+
+                        server.RemoveDocument( -1 );
+                        server.RemoveDocument( 100000 );
+
+                        // Тот же корпус без удалённых документов.
+                        SearchServer kept_server( "w0"s, format );
+
+                        for( const DocumentRecord & record : kept_records )
+                            {
+                                kept_server.AddDocument( record.id, record.text, record.status, record.ratings );
+                            }
+
+                        ASSERT_EQUAL( server.GetDocumentCount(), kept_server.GetDocumentCount() );
+
+                        for( const DocumentRecord & record : records )
+                            {
+                                ASSERT( server.GetWordFrequencies( record.id ) == kept_server.GetWordFrequencies( record.id ) );
+                            }
+
+                        for( int i = 0; i < 300; ++i )
+                            {
+                                const std::string query = GenerateQuery( generator, 40 );
+
+                                for( const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED } )
+                                    {
+                                        AssertSameDocuments( server.FindTopDocuments( query, status, 20 ), kept_server.FindTopDocuments( query, status, 20 ) );
+                                    }
+                            }
+
+                        // Удалённый id можно добавить снова.
+                        server.AddDocument( removed_ids.front(), "w1 w1 w2"s, DocumentStatus::ACTUAL, { 1 } );
+
+                        const std::map< std::string, double > expected_word_freqs = { { "w1"s, 2.0 / 3 }, { "w2"s, 1.0 / 3 } };
+                        const std::map< std::string_view, double > & word_freqs = server.GetWordFrequencies( removed_ids.front() );
+
+                        ASSERT_EQUAL( word_freqs.size(), expected_word_freqs.size() );
+
+                        for( const auto & [ word, term_freq ] : expected_word_freqs )
+                            {
+                                ASSERT( std::abs( word_freqs.at( word ) - term_freq ) < 1e-9 );
+                            }
+                    }
+            }
+
+        void
+        TestRejectsInvalidWords()
+            {
+                ASSERT_THROWS( SearchServer( "и в\x01"s ), std::invalid_argument );
+
+                SearchServer server( "и в на"s );
+                server.AddDocument( 1, "пушистый кот"s, DocumentStatus::ACTUAL, { 1 } );
+
+                ASSERT_THROWS( server.AddDocument( 2, "большой \x12пёс"s, DocumentStatus::ACTUAL, { 1 } ), std::invalid_argument );
+                ASSERT_THROWS( server.FindTopDocuments( "кот --пёс"s ), std::invalid_argument );
+                ASSERT_THROWS( server.FindTopDocuments( "кот -"s ), std::invalid_argument );
+                ASSERT_THROWS( server.FindTopDocuments( "кот\x1F"s ), std::invalid_argument );
+                ASSERT_THROWS( server.MatchDocument( "--кот"s, 1 ), std::invalid_argument );
+
+                // Неудачное добавление не оставляет документ в индексе.
+                ASSERT_EQUAL( server.GetDocumentCount(), 1 );
+
+                // Дефис внутри слова допустим.
+                ASSERT_EQUAL( server.FindTopDocuments( "пушистый кот-пёс"s ).size(), 1u );
+            }
+
+        void
+        TestMatchedWordsOutliveInput()
+            {
+                SearchServer server( "и в на"s );
+
+                    {
+                        std::string text = "пушистый кот и пушистый хвост"s;
+                        server.AddDocument( 1, text, DocumentStatus::ACTUAL, { 1 } );
+                        text.assign( text.size(), 'x' );
+                    }
+
+                std::string query = "хвост кот -пёс"s;
+                const auto [ words, status ] = server.MatchDocument( query, 1 );
+
+                // Найденные слова ссылаются на строки индекса, а не на текст запроса.
+                query.assign( query.size(), 'x' );
+
+                ASSERT_EQUAL( std::vector< std::string >( words.cbegin(), words.cend() ), std::vector< std::string >( { "кот"s, "хвост"s } ) );
+                ASSERT( status == DocumentStatus::ACTUAL );
+                ASSERT_EQUAL( server.FindTopDocuments( std::string_view( "хвост" ) ).size(), 1u );
+            }
+
+        void
+        TestWordOrderDoesNotAffectResults()
+            {
+                std::mt19937 generator( 29 );
+
+                const std::vector< DocumentRecord > records = GenerateRecords( generator, 600, 40 );
+
+                SearchServer server( "w0"s );
+
+                for( const DocumentRecord & record : records )
+                    {
+                        server.AddDocument( record.id, record.text, record.status, record.ratings );
+                    }
+
+                // Слова попадают в словарь в другом порядке, часть - из документов,
+                // удалённых до поиска.
+                SearchServer reordered_server( "w0"s );
+
+                for( int i = 0; i < 40; ++i )
+                    {
+                        reordered_server.AddDocument( 100000 + i, "w"s + std::to_string( 39 - i ) + " x"s + std::to_string( i ), DocumentStatus::ACTUAL, { 1 } );
+                    }
+
+                for( auto it = records.crbegin(); it != records.crend(); ++it )
+                    {
+                        reordered_server.AddDocument( it->id, it->text, it->status, it->ratings );
+                    }
+
+                for( int i = 0; i < 40; ++i )
+                    {
+                        reordered_server.RemoveDocument( 100000 + i );
+                    }
+
+                for( int i = 0; i < 200; ++i )
+                    {
+                        const std::string query = GenerateQuery( generator, 40 );
+
+                        for( const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED } )
+                            {
+                                AssertSameDocuments( server.FindTopDocuments( query, status, 10 ), reordered_server.FindTopDocuments( query, status, 10 ) );
+                            }
+
+                        const int document_id = records[ generator() % records.size() ].id;
+
+                        ASSERT( std::get< 0 >( server.MatchDocument( query, document_id ) ) == std::get< 0 >( reordered_server.MatchDocument( query, document_id ) ) );
+                    }
+
+                // Слово без документов ничего не находит, пока не появится снова.
+                ASSERT( reordered_server.FindTopDocuments( "x7"s ).empty() );
+
+                reordered_server.AddDocument( 100000, "x7"s, DocumentStatus::ACTUAL, { 1 } );
+
+                ASSERT_EQUAL( reordered_server.FindTopDocuments( "x7"s ).size(), 1u );
+            }
+
+        void
+        TestPostingsFormatsMatch()
+            {
+                std::mt19937 generator( 43 );
+
+                SearchServer plain_server( "w0"s, PostingsFormat::PLAIN );
+                SearchServer compressed_server( "w0"s, PostingsFormat::COMPRESSED );
+
+                // Id в случайном порядке: постинги вставляются и в середину списков.
+                std::vector< DocumentRecord > records = GenerateRecords( generator, 2000, 50 );
+                std::shuffle( records.begin(), records.end(), generator );
+
+                std::set< int > document_ids;
+
+                for( std::size_t i = 0; i < records.size(); ++i )
+                    {
+                        const DocumentRecord & record = records[ i ];
+
+                        plain_server.AddDocument( record.id, record.text, record.status, record.ratings );
+                        compressed_server.AddDocument( record.id, record.text, record.status, record.ratings );
+                        document_ids.insert( record.id );
+
+                        if( i % 3 == 0 )
+                            {
+                                const int document_id = records[ generator() % ( i + 1 ) ].id;
+
+                                plain_server.RemoveDocument( document_id );
+                                compressed_server.RemoveDocument( document_id );
+                                document_ids.erase( document_id );
+                            }
+                    }
+
+                for( int i = 0; i < 300; ++i )
+                    {
+                        const std::string query = GenerateQuery( generator, 50 );
+
+                        AssertSameDocuments( plain_server.FindTopDocuments( query ), compressed_server.FindTopDocuments( query ) );
+
+                        // Все документы слова: совпадают и частоты документов.
+                        const auto any_document = []( int, DocumentStatus, int )
+                            {
+                                return true;
+                            };
+
+                        for( const std::string & word : { "w1"s, "w7"s, "w49"s } )
+                            {
+                                AssertSameDocuments(
+                                        plain_server.FindTopDocuments( word, any_document, records.size() ),
+                                        compressed_server.FindTopDocuments( word, any_document, records.size() ) );
+                            }
+
+                        const int document_id = records[ generator() % records.size() ].id;
+
+                        if( document_ids.count( document_id ) > 0 )
+                            {
+                                const auto [ plain_words, plain_status ] = plain_server.MatchDocument( query, document_id );
+                                const auto [ compressed_words, compressed_status ] = compressed_server.MatchDocument( query, document_id );
+
+                                ASSERT( plain_words == compressed_words );
+                                ASSERT( plain_status == compressed_status );
+                            }
+                    }
+            }
+
+        void
+        TestAddDocumentsMatchesAddDocument()
+            {
+                std::mt19937 generator( 37 );
+
+                for( int round = 0; round < 30; ++round )
+                    {
+                        std::vector< DocumentRecord > records = GenerateRecords( generator, 300, 40 );
+
+                        // Неверная запись: повтор id, отрицательный id или слово с управляющим символом.
+                        if( round % 4 != 3 )
+                            {
+                                DocumentRecord & record = records[ 1 + generator() % ( records.size() - 1 ) ];
+
+                                if( round % 4 == 0 )
+                                    {
+                                        record.id = records.front().id;
+                                    }
+                                else if( round % 4 == 1 )
+                                    {
+                                        record.id = -1;
+                                    }
+                                else
+                                    {
+                                        record.text += " w\x01"s;
+                                    }
+                            }
+
+                        SearchServer batch_server( "w0"s );
+                        SearchServer single_server( "w0"s );
+
+                        std::string batch_error = "ok"s;
+                        std::string single_error = "ok"s;
+
+                        try
+                            {
+                                batch_server.AddDocuments( records.cbegin(), records.cend() );
+                            }
+                        catch( const std::exception & e )
+                            {
+                                batch_error = e.what();
+                            }
+
+                        try
+                            {
+                                for( const DocumentRecord & record : records )
+                                    {
+                                        single_server.AddDocument( record.id, record.text, record.status, record.ratings );
+                                    }
+                            }
+                        catch( const std::exception & e )
+                            {
+                                single_error = e.what();
+                            }
+
+                        ASSERT_EQUAL( batch_error, single_error );
+                        ASSERT_EQUAL( round % 4 == 3, batch_error == "ok"s );
+                        ASSERT_EQUAL( batch_server.GetDocumentCount(), single_server.GetDocumentCount() );
+                        ASSERT( std::equal( batch_server.begin(), batch_server.end(), single_server.begin(), single_server.end() ) );
+
+                        for( int i = 0; i < 20; ++i )
+                            {
+                                const std::string query = GenerateQuery( generator, 40 );
+
+                                for( const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED } )
+                                    {
+                                        AssertSameDocuments(
+                                                batch_server.FindTopDocuments( query, status ),
+                                                single_server.FindTopDocuments( query, status ) );
+                                    }
+                            }
+                    }
+            }
+
+        // Частоты слов убывают как 1 / ранг: у частых слов длинные списки постингов,
+        // и WAND пропускает документы.
+        std::vector< DocumentRecord >
+        GenerateSkewedRecords(
+                std::mt19937 & generator,
+                const int document_count,
+                const int vocabulary_size )
+            {
+                CorpusConfig config;
+                config.seed = generator();
+                config.documents = document_count;
+                config.vocabulary = vocabulary_size;
+                config.min_length = 1;
+                config.max_length = 20;
+                config.min_rating = 0;
+                config.max_rating = 3;
+                config.status_count = 2;
+
+                std::vector< DocumentRecord > records = CorpusGenerator( config ).GenerateRecords();
+
+                // Пропуски в id, чтобы id не совпадали с порядковыми номерами документов.
+                for( DocumentRecord & record : records )
+                    {
+                        record.id = record.id * 2 + static_cast< int >( generator() % 2 );
+                    }
+
+                return records;
+            }
+
+        void
+        TestWandMatchesExhaustive()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 3 );
+
+                        SearchServer server( "w0"s, format );
+
+                        const std::vector< DocumentRecord > records = GenerateSkewedRecords( generator, 2000, 60 );
+                        server.AddDocuments( records.cbegin(), records.cend() );
+
+                        for( int i = 0; i < 300; ++i )
+                            {
+                                if( i == 150 )
+                                    {
+                                        for( int j = 0; j < 500; ++j )
+                                            {
+                                                server.RemoveDocument( static_cast< int >( generator() % 4000 ) );
+                                            }
+                                    }
+
+                                const std::string query = GenerateQuery( generator, 60 );
+                                const std::size_t max_result_count = generator() % 10;
+                                const DocumentStatus status = static_cast< DocumentStatus >( generator() % 2 );
+
+                                AssertSameDocuments(
+                                        server.FindTopDocuments( QueryMode::EXHAUSTIVE, query, status, max_result_count ),
+                                        server.FindTopDocuments( QueryMode::WAND, query, status, max_result_count ) );
+
+                                const int remainder = static_cast< int >( generator() % 4 );
+
+                                const auto document_predicate = [remainder]( const int document_id, DocumentStatus, const int rating )
+                                    {
+                                        return ( document_id + rating ) % 4 != remainder;
+                                    };
+
+                                AssertSameDocuments(
+                                        server.FindTopDocuments( QueryMode::EXHAUSTIVE, query, document_predicate, max_result_count ),
+                                        server.FindTopDocuments( QueryMode::WAND, query, document_predicate, max_result_count ) );
+                            }
+                    }
+            }
+
+        void
+        TestMinusWordsExcludeDocuments()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 53 );
+
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 1500, 30 );
+
+                        SearchServer server( "w0"s, format );
+                        server.AddDocuments( records.cbegin(), records.cend() );
+
+                        const ReferenceServer reference_server( { "w0"s }, records );
+
+                        for( int i = 0; i < 200; ++i )
+                            {
+                                std::string plus_query = "w"s + std::to_string( 1 + generator() % 29 );
+                                std::string query = plus_query;
+                                std::vector< std::string > minus_words;
+
+                                for( unsigned j = generator() % 6; j > 0; --j )
+                                    {
+                                        minus_words.push_back( "w"s + std::to_string( generator() % 30 ) );
+                                        query += " -"s + minus_words.back();
+                                    }
+
+                                // Прежний порядок: оценить документы плюс-слов, затем стереть
+                                // документы минус-слов.
+                                std::map< int, double > expected_relevances = reference_server.FindAllDocuments( plus_query, DocumentStatus::ACTUAL );
+
+                                for( auto it = expected_relevances.begin(); it != expected_relevances.end(); )
+                                    {
+                                        const bool has_minus_word = std::any_of(
+                                                minus_words.cbegin(),
+                                                minus_words.cend(),
+                                                [&]( const std::string & word )
+                                                    {
+                                                        return word != "w0"s && reference_server.ContainsWord( it->first, word );
+                                                    } );
+
+                                        it = has_minus_word ? expected_relevances.erase( it ) : std::next( it );
+                                    }
+
+                                for( const QueryMode mode : { QueryMode::EXHAUSTIVE, QueryMode::WAND } )
+                                    {
+                                        AssertTopDocuments(
+                                                server.FindTopDocuments( mode, query, DocumentStatus::ACTUAL, 50 ),
+                                                expected_relevances,
+                                                reference_server,
+                                                50 );
+                                    }
+
+                                AssertTopDocuments(
+                                        server.FindTopDocuments( std::execution::par, query, DocumentStatus::ACTUAL, 50 ),
+                                        expected_relevances,
+                                        reference_server,
+                                        50 );
+
+                                // Документы с минус-словами исключаются до проверки предиката.
+                                std::vector< int > checked_ids;
+
+                                server.FindTopDocuments(
+                                        query,
+                                        [&checked_ids]( const int document_id, DocumentStatus, int )
+                                            {
+                                                checked_ids.push_back( document_id );
+
+                                                return true;
+                                            } );
+
+                                for( const int document_id : checked_ids )
+                                    {
+                                        for( const std::string & word : minus_words )
+                                            {
+                                                ASSERT( word == "w0"s || !reference_server.ContainsWord( document_id, word ) );
+                                            }
+                                    }
+
+                                // MatchDocument не возвращает слов документа с минус-словом.
+                                const DocumentRecord & record = records[ generator() % records.size() ];
+
+                                const auto [ words, status ] = server.MatchDocument( query, record.id );
+
+                                ASSERT_EQUAL( std::vector< std::string >( words.cbegin(), words.cend() ), reference_server.MatchDocument( query, record.id ) );
+                                ASSERT( status == record.status );
+                            }
+                    }
+            }
+
+        void
+        TestMovedFromServerIsEmptyAndUsable()
+            {
+                SearchServer source( "и в на"s );
+                source.SetMetricsEnabled( true );
+                source.AddDocument( 1, "кот в городе"s, DocumentStatus::ACTUAL, { 1 } );
+
+                const SearchServer target( std::move( source ) );
+
+                ASSERT_EQUAL( target.GetDocumentCount(), 1 );
+                ASSERT_EQUAL( target.FindTopDocuments( "кот"s ).size(), 1u );
+
+                ASSERT_EQUAL( source.GetDocumentCount(), 0 );
+                ASSERT( source.FindTopDocuments( "кот"s ).empty() );
+                ASSERT( source.begin() == source.end() );
+
+                source.GetMetrics();
+                source.ResetMetrics();
+
+                // Стоп-слова сохраняются, новые слова получают свои id.
+                source.AddDocument( 2, "пёс в парке"s, DocumentStatus::ACTUAL, { 2 } );
+
+                ASSERT_EQUAL( source.GetDocumentCount(), 1 );
+                ASSERT_EQUAL( source.FindTopDocuments( "пёс"s ).size(), 1u );
+                ASSERT( source.FindTopDocuments( "в"s ).empty() );
+                ASSERT( target.FindTopDocuments( "пёс"s ).empty() );
+            }
+
+        void
+        TestRemoveDocumentsMatchesRemoveDocument()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 7 );
+
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 600, 40 );
+
+                        SearchServer batch_server( "w0"s, format );
+                        batch_server.AddDocuments( records.cbegin(), records.cend() );
+
+                        SearchServer single_server( "w0"s, format );
+                        single_server.AddDocuments( records.cbegin(), records.cend() );
+
+                        // Неупорядоченные id с повторами и отсутствующими документами.
+                        std::vector< int > removed_ids;
+
+                        for( int i = 0; i < 400; ++i )
+                            {
+                                removed_ids.push_back( static_cast< int >( generator() % 1900 ) );
+                            }
+
+                        batch_server.RemoveDocuments( removed_ids );
+
+                        for( const int document_id : removed_ids )
+                            {
+                                single_server.RemoveDocument( document_id );
+                            }
+
+                        ASSERT_EQUAL( batch_server.GetDocumentCount(), single_server.GetDocumentCount() );
+                        ASSERT( std::equal( batch_server.begin(), batch_server.end(), single_server.begin(), single_server.end() ) );
+
+                        for( const int document_id : removed_ids )
+                            {
+                                ASSERT( !batch_server.ContainsDocument( document_id ) );
+                            }
+
+                        for( int i = 0; i < 200; ++i )
+                            {
+                                const std::string query = GenerateQuery( generator, 40 );
+
+                                AssertSameDocuments(
+                                        batch_server.FindTopDocuments( query ),
+                                        single_server.FindTopDocuments( query ) );
+                            }
+
+                        // После пакетного удаления документы с теми же id добавляются снова.
+                        batch_server.AddDocument( removed_ids.front(), "w1 w2"s, DocumentStatus::ACTUAL, { 1 } );
+                        single_server.AddDocument( removed_ids.front(), "w1 w2"s, DocumentStatus::ACTUAL, { 1 } );
+
+                        AssertSameDocuments(
+                                batch_server.FindTopDocuments( "w1 w2"s ),
+                                single_server.FindTopDocuments( "w1 w2"s ) );
+                    }
+            }
+
+        // Удаления только отмечают документы и постинги; повторные добавления тех же id,
+        // пакетные операции и уплотнения не должны отличать сервер от собранного заново.
+        void
+        TestInterleavedRemovalsMatchRebuiltServer()
+            {
+                for( const PostingsFormat format : { PostingsFormat::PLAIN, PostingsFormat::COMPRESSED } )
+                    {
+                        std::mt19937 generator( 53 );
+
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 300, 30 );
+
+                        SearchServer server( "w0"s, format );
+                        std::map< int, DocumentRecord > live_records;
+
+                        for( int step = 0; step < 3000; ++step )
+                            {
+                                const DocumentRecord & record = records[ generator() % records.size() ];
+                                const unsigned operation = generator() % 10;
+
+                                if( operation < 4 )
+                                    {
+                                        if( live_records.count( record.id ) == 0 )
+                                            {
+                                                server.AddDocument( record.id, record.text, record.status, record.ratings );
+                                                live_records[ record.id ] = record;
+                                            }
+                                    }
+                                else if( operation < 5 )
+                                    {
+                                        std::vector< DocumentRecord > batch;
+
+                                        for( const DocumentRecord & candidate : records )
+                                            {
+                                                if(
+                                                        live_records.count( candidate.id ) == 0
+                                                        &&
+                                                        generator() % 8 == 0 )
+                                                    {
+                                                        batch.push_back( candidate );
+                                                        live_records[ candidate.id ] = candidate;
+                                                    }
+                                            }
+
+                                        server.AddDocuments( batch.cbegin(), batch.cend() );
+                                    }
+                                else if( operation < 9 )
+                                    {
+                                        server.RemoveDocument( record.id );
+                                        live_records.erase( record.id );
+                                    }
+                                else
+                                    {
+                                        std::vector< int > removed_ids;
+
+                                        for( int i = 0; i < 20; ++i )
+                                            {
+                                                removed_ids.push_back( records[ generator() % records.size() ].id );
+                                                live_records.erase( removed_ids.back() );
+                                            }
+
+                                        server.RemoveDocuments( removed_ids );
+                                    }
+
+                                if( step % 100 != 0 )
+                                    {
+                                        continue;
+                                    }
+
+                                SearchServer rebuilt_server( "w0"s, format );
+
+                                std::vector< int > live_ids;
+
+                                for( const auto & [ document_id, live_record ] : live_records )
+                                    {
+                                        rebuilt_server.AddDocument( document_id, live_record.text, live_record.status, live_record.ratings );
+                                        live_ids.push_back( document_id );
+                                    }
+
+                                ASSERT_EQUAL( std::vector< int >( server.begin(), server.end() ), live_ids );
+                                ASSERT_EQUAL( server.GetDocumentCount(), static_cast< int >( live_ids.size() ) );
+
+                                for( std::size_t i = 0; i < live_ids.size(); i += 7 )
+                                    {
+                                        ASSERT_EQUAL( server.GetDocumentId( static_cast< int >( i ) ), live_ids[ i ] );
+                                    }
+
+                                for( int word = 0; word < 30; ++word )
+                                    {
+                                        const std::string text = "w"s + std::to_string( word );
+
+                                        ASSERT_EQUAL( server.GetDocumentFreq( text ), rebuilt_server.GetDocumentFreq( text ) );
+                                    }
+
+                                for( int i = 0; i < 20; ++i )
+                                    {
+                                        const std::string query = GenerateQuery( generator, 30 );
+
+                                        for( const QueryMode mode : { QueryMode::EXHAUSTIVE, QueryMode::WAND } )
+                                            {
+                                                AssertSameDocuments(
+                                                        server.FindTopDocuments( mode, query, DocumentStatus::ACTUAL, 3 ),
+                                                        rebuilt_server.FindTopDocuments( mode, query, DocumentStatus::ACTUAL, 3 ) );
+                                            }
+
+                                        AssertSameDocuments(
+                                                server.FindTopDocuments( std::execution::par, query, DocumentStatus::BANNED ),
+                                                rebuilt_server.FindTopDocuments( std::execution::par, query, DocumentStatus::BANNED ) );
+
+                                        const int document_id = record.id;
+
+                                        if( live_records.count( document_id ) != 0 )
+                                            {
+                                                ASSERT( server.MatchDocument( query, document_id ) == rebuilt_server.MatchDocument( query, document_id ) );
+                                            }
+                                        else
+                                            {
+                                                ASSERT_THROWS( server.MatchDocument( query, document_id ), std::out_of_range );
+                                            }
+                                    }
+                            }
+                    }
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestMatchesReferenceServer );
+        RUN_TEST( TestFindsExampleDocuments );
+        RUN_TEST( TestParallelMatchesSequential );
+        RUN_TEST( TestRemovedDocumentsAreForgotten );
+        RUN_TEST( TestRejectsInvalidWords );
+        RUN_TEST( TestMatchedWordsOutliveInput );
+        RUN_TEST( TestWordOrderDoesNotAffectResults );
+        RUN_TEST( TestPostingsFormatsMatch );
+        RUN_TEST( TestAddDocumentsMatchesAddDocument );
+        RUN_TEST( TestWandMatchesExhaustive );
+        RUN_TEST( TestMinusWordsExcludeDocuments );
+        RUN_TEST( TestMovedFromServerIsEmptyAndUsable );
+        RUN_TEST( TestRemoveDocumentsMatchesRemoveDocument );
+        RUN_TEST( TestInterleavedRemovalsMatchRebuiltServer );
+    }
@@ -0,0 +1,147 @@
+// Тесты ShardedSearchServer: результаты совпадают с единым сервером.
+//
+// Сборка и запуск из корня репозитория:
+//     tests/run_tests.sh sharded_search_server_test
+
+#include <exception>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "search_server.h"
+#include "sharded_search_server.h"
+#include "test_corpus.h"
+#include "test_framework.h"
+
+using namespace std::string_literals;
+
+namespace
+    {
+        // Текст исключения или "ok".
+        template < typename Function >
+        std::string
+        GetError( const Function & function )
+            {
+                try
+                    {
+                        function();
+                    }
+                catch( const std::exception & e )
+                    {
+                        return e.what();
+                    }
+
+                return "ok"s;
+            }
+
+        void
+        AssertSameMatches(
+                const SearchServer & server,
+                const ShardedSearchServer & sharded_server,
+                const std::string & query )
+            {
+                for( int document_id = -1; document_id < 450; document_id += 7 )
+                    {
+                        std::vector< std::string_view > words;
+                        std::vector< std::string_view > sharded_words;
+                        DocumentStatus status = DocumentStatus::ACTUAL;
+                        DocumentStatus sharded_status = DocumentStatus::ACTUAL;
+
+                        const std::string error = GetError(
+                                [&]()
+                                    {
+                                        std::tie( words, status ) = server.MatchDocument( query, document_id );
+                                    } );
+
+                        const std::string sharded_error = GetError(
+                                [&]()
+                                    {
+                                        std::tie( sharded_words, sharded_status ) = sharded_server.MatchDocument( query, document_id );
+                                    } );
+
+                        ASSERT_EQUAL( error, sharded_error );
+                        ASSERT( words == sharded_words );
+                        ASSERT( status == sharded_status );
+                    }
+            }
+
+        void
+        TestMatchesSingleServer()
+            {
+                for( std::size_t shard_count = 1; shard_count <= 5; ++shard_count )
+                    {
+                        std::mt19937 generator( static_cast< unsigned >( shard_count ) );
+
+                        SearchServer server( "w0 w1"s );
+                        ShardedSearchServer sharded_server( "w0 w1"s, shard_count );
+
+                        const std::vector< DocumentRecord > records = GenerateRecords( generator, 150, 30 );
+
+                        server.AddDocuments( records.cbegin(), records.cend() );
+                        sharded_server.AddDocuments( records.cbegin(), records.cend() );
+
+                        for( int step = 0; step < 1500; ++step )
+                            {
+                                const unsigned operation = generator() % 10;
+
+                                if( operation < 4 )
+                                    {
+                                        // Повторные и отрицательные id проверяют и тексты ошибок.
+                                        const int document_id = static_cast< int >( generator() % 460 ) - 5;
+                                        const DocumentRecord record = GenerateRecords( generator, 1, 30 ).front();
+
+                                        ASSERT_EQUAL(
+                                                GetError(
+                                                        [&]()
+                                                            {
+                                                                server.AddDocument( document_id, record.text, record.status, record.ratings );
+                                                            } ),
+                                                GetError(
+                                                        [&]()
+                                                            {
+                                                                sharded_server.AddDocument( document_id, record.text, record.status, record.ratings );
+                                                            } ) );
+                                    }
+                                else if( operation < 6 )
+                                    {
+                                        const int document_id = static_cast< int >( generator() % 460 );
+
+                                        server.RemoveDocument( document_id );
+                                        sharded_server.RemoveDocument( document_id );
+                                    }
+                                else
+                                    {
+                                        const std::string query = GenerateQuery( generator, 30 );
+                                        const std::size_t max_result_count = 1 + generator() % 8;
+
+                                        ASSERT_EQUAL( server.GetDocumentCount(), sharded_server.GetDocumentCount() );
+
+                                        // Малый max_result_count отсекает часть равных по релевантности
+                                        // и рейтингу документов: отбор должен совпасть и по id.
+                                        AssertSameDocuments(
+                                                server.FindTopDocuments( query, DocumentStatus::ACTUAL, max_result_count ),
+                                                sharded_server.FindTopDocuments( query, DocumentStatus::ACTUAL, max_result_count ) );
+
+                                        const auto document_predicate = []( const int document_id, DocumentStatus, const int rating )
+                                            {
+                                                return document_id % 3 == 0 || rating > 2;
+                                            };
+
+                                        AssertSameDocuments(
+                                                server.FindTopDocuments( query, document_predicate, max_result_count ),
+                                                sharded_server.FindTopDocuments( query, document_predicate, max_result_count ) );
+
+                                        AssertSameMatches( server, sharded_server, query );
+                                    }
+                            }
+                    }
+            }
+    }
+
+int
+main()
+    {
+        RUN_TEST( TestMatchesSingleServer );
+    }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+#include "test_framework.h"
+
+// Случайные корпуса и запросы для сравнения разных путей поиска.
+// Словарь мал, поэтому у документов много общих слов и равных релевантностей.
+
+inline std::vector< DocumentRecord >
+GenerateRecords(
+        std::mt19937 & generator,
+        const int document_count,
+        const int vocabulary_size )
+    {
+        std::vector< DocumentRecord > records;
+
+        for( int id = 0; id < document_count; ++id )
+            {
+                DocumentRecord record;
+                record.id = id * 3 + static_cast< int >( generator() % 3 );
+                record.status = static_cast< DocumentStatus >( generator() % 3 );
+                record.ratings = { static_cast< int >( generator() % 5 ) };
+
+                const int word_count = 1 + static_cast< int >( generator() % 8 );
+
+                for( int i = 0; i < word_count; ++i )
+                    {
+                        record.text += ( i == 0 ? std::string() : std::string( " " ) ) + "w" + std::to_string( generator() % vocabulary_size );
+                    }
+
+                records.push_back( std::move( record ) );
+            }
+
+        return records;
+    }
+
+inline std::string
+GenerateQuery(
+        std::mt19937 & generator,
+        const int vocabulary_size )
+    {
+        std::string query;
+
+        const int word_count = 1 + static_cast< int >( generator() % 4 );
+
+        for( int i = 0; i < word_count; ++i )
+            {
+                query += ( i == 0 ? "" : " " );
+                query += ( generator() % 6 == 0 ? "-w" : "w" );
+                query += std::to_string( generator() % vocabulary_size );
+            }
+
+        return query;
+    }
+
+// Результаты совпадают полностью: те же id в том же порядке, релевантность бит в бит.
+inline void
+AssertSameDocuments(
+        const std::vector< Document > & lhs,
+        const std::vector< Document > & rhs )
+    {
+        ASSERT_EQUAL( lhs.size(), rhs.size() );
+
+        for( std::size_t i = 0; i < lhs.size(); ++i )
+            {
+                ASSERT_EQUAL( lhs[ i ].id, rhs[ i ].id );
+                ASSERT_EQUAL( lhs[ i ].relevance, rhs[ i ].relevance );
+                ASSERT_EQUAL( lhs[ i ].rating, rhs[ i ].rating );
+            }
+    }
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Проверки для тестов из tests/. Неудачная проверка печатает место, выражение
+// и значения и завершает программу с кодом 1; RUN_TEST печатает имя пройденного
+// теста. Тесты - отдельные программы, их собирает и запускает tests/run_tests.sh.
+
+template < typename Element >
+std::ostream &
+operator<<(
+        std::ostream & out,
+        const std::vector< Element > & elements )
+    {
+        out << '[';
+
+        for( std::size_t i = 0; i < elements.size(); ++i )
+            {
+                out << ( i == 0 ? "" : ", " ) << elements[ i ];
+            }
+
+        return out << ']';
+    }
+
+[[noreturn]] inline void
+FailTest(
+        const char * file,
+        const int line,
+        const std::string & message )
+    {
+        std::cerr << file << ':' << line << ": " << message << std::endl;
+        std::exit( 1 );
+    }
+
+template < typename Lhs, typename Rhs >
+void
+AssertEqualImpl(
+        const Lhs & lhs,
+        const Rhs & rhs,
+        const char * lhs_text,
+        const char * rhs_text,
+        const char * file,
+        const int line )
+    {
+        if( !( lhs == rhs ) )
+            {
+                std::cerr << file << ':' << line << ": ASSERT_EQUAL( " << lhs_text << ", " << rhs_text << " ): "
+                        << lhs << " != " << rhs << std::endl;
+                std::exit( 1 );
+            }
+    }
+
+template < typename Test >
+void
+RunTestImpl(
+        const Test test,
+        const char * name )
+    {
+        test();
+
+        std::cerr << name << " OK" << std::endl;
+    }
+
+#define ASSERT( expression ) \
+        do \
+            { \
+                if( !( expression ) ) \
+                    { \
+                        FailTest( __FILE__, __LINE__, "ASSERT( " #expression " )" ); \
+                    } \
+            } \
+        while( false )
+
+#define ASSERT_EQUAL( lhs, rhs ) AssertEqualImpl( ( lhs ), ( rhs ), #lhs, #rhs, __FILE__, __LINE__ )
+
+#define ASSERT_THROWS( expression, exception_type ) \
+        do \
+            { \
+                bool is_thrown = false; \
+                try \
+                    { \
+                        expression; \
+                    } \
+                catch( const exception_type & ) \
+                    { \
+                        is_thrown = true; \
+                    } \
+                if( !is_thrown ) \
+                    { \
+                        FailTest( __FILE__, __LINE__, "ASSERT_THROWS( " #expression ", " #exception_type " )" ); \
+                    } \
+            } \
+        while( false )
+
+#define RUN_TEST( test ) RunTestImpl( test, #test )